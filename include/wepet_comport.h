@@ -1,134 +1,538 @@
-/******************************************************************************
-*                                                                             *
-* wepet_comport.h                                                             *
-* ===============                                                             *
-*                                                                             *
-* Version: 1.1.4                                                              *
-* Date   : 18.10.15                                                           *
-* Author : Peter Weissig                                                      *
-*                                                                             *
-* For help or bug report please visit:                                        *
-*   https://github.com/peterweissig/cpp_comport/                              *
-******************************************************************************/
-
-#ifndef __WEPET_COMPORT_H
-#define __WEPET_COMPORT_H
-
-// local headers
-
-// wepet headers
-
-// standard headers
-#include <string>
-#include <stdint.h>
-
-// additional headers
-#if (defined(__WIN32) || defined(__WIN64))
-#else
-    #include <termios.h>
-#endif //#if (defined(__WIN32) || defined(__WIN64))
-
-
-
-namespace wepet {
-
-enum eComPortByteSize {
-    kCpByteSize5 = 5,
-    kCpByteSize6 = 6,
-    kCpByteSize7 = 7,
-    kCpByteSize8 = 8
-};
-
-enum eComPortStopBits {
-    kCpStopBits1 = 0,
-    kCpStopBits2 = 2
-};
-
-enum eComPortParity {
-    kCpParityNone  = 0,
-    kCpParityOdd   = 1,
-    kCpParityEven  = 2,
-    kCpParityMark  = 3,
-    kCpParitySpace = 4
-};
-
-//*****************************************************************************
-//**************************{class cComPort}***********************************
-//*****************************************************************************
-class cComPort {
-  public:
-    cComPort(void);
-    ~cComPort(void);
-
-    bool Open(std::string port_name);
-    bool IsOpened(void);
-    void Close(void);
-
-    bool Transmit(std::string text);
-    std::string Receive(void);
-
-    bool LineRtsSet(bool state);
-    bool LineDtrSet(bool state);
-
-    // this 3 functions are only for windows
-    int HWBufferInSizeGet(void);
-    int HWBufferOutSizeGet(void);
-    bool HWBufferSizeSet(int buffer_in_size, int buffer_out_size);
-
-    int HWBufferInCountGet(void);
-    int HWBufferOutCountGet(void);
-    bool HWBufferFlush(bool buffer_in, bool buffer_out);
-
-    int              SettingBaudRateGet(void);
-    eComPortByteSize SettingByteSizeGet(void);
-    eComPortStopBits SettingStopBitsGet(void);
-    eComPortParity   SettingParityGet  (void);
-    bool SettingBaudRateSet(int baud_rate);
-    bool SettingByteSizeSet(eComPortByteSize byte_size);
-    bool SettingStopBitsSet(eComPortStopBits stop_bits);
-    bool SettingParitySet  (eComPortParity parity);
-
-  private:
-    // internal system-dependend variables
-    #if (defined(__WIN32) || defined(__WIN64))
-        int port_file;
-        HANDLE port_file;
-        DCB port_settings;
-        int port_buffer_in_size;
-        int port_buffer_out_size;
-    #else
-        int port_file;
-        termios port_settings, port_settings_old;
-        int port_baudrate;
-    #endif //#if (defined(__WIN32) || defined(__WIN64))
-};
-
-//*****************************************************************************
-//**************************{class cComPortBuffer}*****************************
-//*****************************************************************************
-class cComPortBuffer : public cComPort {
-  public:
-    cComPortBuffer(void);
-    ~cComPortBuffer(void);
-
-    std::string BufferGet(void) const;
-    void BufferUpdate(void);
-    void BufferClear(void);
-
-    bool BufferWait(int count);
-    bool BufferWait(std::string text);
-    void BufferTimeSet(int milliseconds);
-
-    void Wait(int milliseconds) const;
-
-  private:
-    int64_t GetCurrentTime(void) const;
-    // this function is only for linux to allow non-blocking sleep
-    void SleepOneMilliSecond(void) const;
-
-    std::string receive_buffer;
-    int receive_time;
-};
-
-} // namespace wepet {
-#endif // #ifndef __WEPET_COMPORT_H
+/******************************************************************************
+*                                                                             *
+* wepet_comport.h                                                             *
+* ===============                                                             *
+*                                                                             *
+* Version: 1.1.4                                                              *
+* Date   : 18.10.15                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_H
+#define __WEPET_COMPORT_H
+
+// local headers
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// additional headers
+#if (defined(__WIN32) || defined(__WIN64))
+#else
+    #include <termios.h>
+#endif //#if (defined(__WIN32) || defined(__WIN64))
+
+
+
+namespace wepet {
+
+enum eComPortByteSize {
+    kCpByteSize5 = 5,
+    kCpByteSize6 = 6,
+    kCpByteSize7 = 7,
+    kCpByteSize8 = 8
+};
+
+enum eComPortStopBits {
+    kCpStopBits1 = 0,
+    kCpStopBits2 = 2
+};
+
+enum eComPortParity {
+    kCpParityNone  = 0,
+    kCpParityOdd   = 1,
+    kCpParityEven  = 2,
+    kCpParityMark  = 3,
+    kCpParitySpace = 4
+};
+
+enum eComPortFlowControl {
+    kCpFlowControlNone   = 0,
+    kCpFlowControlRtsCts = 1,
+    kCpFlowControlDtrDsr = 2,
+    kCpFlowControlXonXoff= 3
+};
+
+enum eComPortLine {
+    kCpLineRts = 0x01,
+    kCpLineDtr = 0x02,
+    kCpLineCts = 0x04,
+    kCpLineDsr = 0x08,
+    kCpLineDcd = 0x10,
+    kCpLineRi  = 0x20
+};
+
+enum eComPortOverflow {
+    kCpOverflowDropOldest = 0,
+    kCpOverflowDropNewest = 1,
+    kCpOverflowBlock      = 2,
+    kCpOverflowCallback   = 3
+};
+
+// kernel line counters (only for linux - see serial_icounter_struct)
+// cts, dsr, rng and dcd count the changes of the modem input lines
+struct sComPortCounters {
+    int rx;
+    int tx;
+    int frame;
+    int overrun;
+    int parity;
+    int brk;
+    int buf_overrun;
+
+    int cts;
+    int dsr;
+    int rng;
+    int dcd;
+};
+
+// reads and writes of the port (including transports) - failed calls
+// are counted as errors (a full output buffer as well)
+// latency sorts the writes by their duration: latency[i] counts writes
+// up to and including 2^i microseconds (and longer than 2^(i-1)) - the
+// last one also counts all longer
+struct sComPortStatistic {
+    int64_t tx_bytes;
+    int64_t tx_calls;
+    int64_t tx_errors;
+    int64_t rx_bytes;
+    int64_t rx_calls;
+    int64_t rx_errors;
+    int64_t latency_sum;
+    int64_t latency[20];
+};
+
+// rs485 half duplex settings (delays are given in milliseconds)
+struct sComPortRs485 {
+    bool enabled;
+    bool rts_on_send;
+    bool rts_after_send;
+    int  delay_before_send;
+    int  delay_after_send;
+    bool rx_during_tx;
+};
+
+//*****************************************************************************
+//**************************{class cComPortTransport}**************************
+//*****************************************************************************
+// Interface for other transports than the serial port itself.
+// Write and Read return the number of bytes or -1 on error (like the
+// system calls). The baud rate can be used to simulate the line speed.
+class cComPortTransport {
+  public:
+    virtual ~cComPortTransport(void);
+
+    virtual bool IsOpened(void) = 0;
+    virtual void Close(void) = 0;
+
+    virtual int Write(const char *data, int size) = 0;
+    virtual int Read(char *data, int size) = 0;
+
+    virtual int InCountGet(void) = 0;
+    virtual int OutCountGet(void) = 0;
+
+    virtual bool BaudRateSet(int baud_rate);
+    // returns a file descriptor usable by poll or -1
+    virtual int FileGet(void);
+};
+
+//*****************************************************************************
+//**************************{class cComPortClock}******************************
+//*****************************************************************************
+// Interface for the time source of the timeouts (see cComPortBuffer).
+// TimeGet returns the current time in nanoseconds or -1 on error.
+class cComPortClock {
+  public:
+    virtual ~cComPortClock(void);
+
+    virtual int64_t TimeGet(void) = 0;
+    virtual void Sleep(int64_t nanoseconds) = 0;
+};
+
+//*****************************************************************************
+//**************************{class cComPortClockMonotonic}*********************
+//*****************************************************************************
+// Default clock - the real (monotonic) time of the system.
+class cComPortClockMonotonic : public cComPortClock {
+  public:
+    int64_t TimeGet(void);
+    // this function is only for linux to allow non-blocking sleep
+    void Sleep(int64_t nanoseconds);
+};
+
+//*****************************************************************************
+//**************************{class cComPortClockVirtual}***********************
+//*****************************************************************************
+// Virtual clock - the time only moves by calling Sleep, Advance or TimeSet.
+// Timeouts therefore pass without waiting (e.g. for tests or simulations).
+class cComPortClockVirtual : public cComPortClock {
+  public:
+    cComPortClockVirtual(int64_t nanoseconds = 0);
+
+    int64_t TimeGet(void);
+    void Sleep(int64_t nanoseconds);
+
+    void TimeSet(int64_t nanoseconds);
+    void Advance(int64_t nanoseconds);
+
+  private:
+    int64_t time_current;
+};
+
+#if (defined(__WIN32) || defined(__WIN64))
+#else
+//*****************************************************************************
+//**************************{class cComPortSerial}*****************************
+//*****************************************************************************
+// Transport of the serial port itself (termios) - this class is only for
+// linux. It is the default transport of cComPort, which applies all other
+// settings to the file descriptor.
+class cComPortSerial : public cComPortTransport {
+  public:
+    cComPortSerial(void);
+    ~cComPortSerial(void);
+
+    // opens the device non-blocking and keeps its settings for Close
+    bool Open(std::string name);
+    bool IsOpened(void);
+    // restores the settings and closes the device
+    void Close(void);
+
+    int Write(const char *data, int size);
+    int Read(char *data, int size);
+
+    int InCountGet(void);
+    int OutCountGet(void);
+
+    // other than the standard rates are set by the custom divisor of the
+    // uart - nothing is done while closed
+    bool BaudRateSet(int baud_rate);
+    // sets the custom divisor for other rates or clears it for 38400 -
+    // the uart only uses it while the termios rate is B38400
+    bool DivisorSet(int baud_rate);
+    int FileGet(void);
+
+  private:
+    int file;
+    termios settings_old;
+};
+#endif //#if (defined(__WIN32) || defined(__WIN64))
+
+//*****************************************************************************
+//**************************{class cComPort}***********************************
+//*****************************************************************************
+class cComPort {
+  public:
+    cComPort(void);
+    ~cComPort(void);
+
+    bool Open(std::string port_name);
+    bool IsOpened(void);
+    void Close(void);
+
+    // name of the last opened port (kept after Close)
+    std::string NameGet(void);
+    // returns true if the device was hung up or removed (only for linux)
+    // - an EIO of read or write is treated as hangup, too
+    bool HangupCheck(void);
+    // file descriptor for poll (only for linux) or -1
+    int FileGet(void);
+
+    // uses another transport instead of the serial port (NULL resets)
+    // the transport is not owned and must stay valid while in use -
+    // Open only attaches the already opened transport and Close detaches
+    // it again (closing it is left to the owner)
+    // settings are still stored, but only the baud rate is forwarded
+    void TransportSet(cComPortTransport *transport);
+    cComPortTransport *TransportGet(void);
+
+    bool Transmit(std::string text);
+    std::string Receive(void);
+    // receives at most max_count bytes (negative values for all)
+    std::string Receive(int max_count);
+
+    // writes the text and waits until the output buffer was drained
+    // (or the time is up) - the time of completion is stored in
+    // microseconds (monotonic clock) and returned by TransmitTimeGet
+    bool TransmitAndDrain(std::string text, int milliseconds);
+    int64_t TransmitTimeGet(void);
+
+    // pacing is only available for linux
+    // if enabled (queue_depth > 0), Transmit keeps the output buffer
+    // below queue_depth bytes and holds back the remaining data until
+    // TransmitUpdate is called - TransmitUrgent skips the held back data
+    // after disabling, the held back data is still written first (without
+    // limit) by Transmit and TransmitUpdate - Close discards it
+    int  SettingPacingGet(void);
+    bool SettingPacingSet(int queue_depth);
+    bool TransmitUpdate(void);
+    bool TransmitUrgent(std::string text);
+    // like above, but a full output buffer is no error - count returns
+    // the number of written bytes (the caller keeps the rest)
+    bool TransmitUrgent(std::string text, int &count);
+    // may be called by other threads
+    int  TransmitPendingGet(void);
+
+    bool LineRtsSet(bool state);
+    bool LineDtrSet(bool state);
+
+    // returns a combination of eComPortLine or a negative value on error
+    int LineStatusGet(void);
+    // return 1 if the line is active, 0 if not and negative values on error
+    int LineCtsGet(void);
+    int LineDsrGet(void);
+    int LineDcdGet(void);
+    int LineRiGet (void);
+    // blocks until one of the given input lines (eComPortLine) changes or
+    // the time is up (returns false) - negative milliseconds wait forever
+    // note: with a timeout linux polls the interrupt counters every 1ms,
+    //       windows polls the modem status every 1ms
+    bool LineWait(int lines, int milliseconds);
+
+    // this 3 functions are only for windows
+    int HWBufferInSizeGet(void);
+    int HWBufferOutSizeGet(void);
+    bool HWBufferSizeSet(int buffer_in_size, int buffer_out_size);
+
+    int HWBufferInCountGet(void);
+    int HWBufferOutCountGet(void);
+    bool HWBufferFlush(bool buffer_in, bool buffer_out);
+
+    int              SettingBaudRateGet(void);
+    eComPortByteSize SettingByteSizeGet(void);
+    eComPortStopBits SettingStopBitsGet(void);
+    eComPortParity   SettingParityGet  (void);
+    bool SettingBaudRateSet(int baud_rate);
+    bool SettingByteSizeSet(eComPortByteSize byte_size);
+    bool SettingStopBitsSet(eComPortStopBits stop_bits);
+    bool SettingParitySet  (eComPortParity parity);
+    // sets the baud rate and the given termios control flags (c_cflag)
+    // with a single tcsetattr - the other flags are read from the driver
+    // before and the custom divisor is updated for B38400 (see
+    // cComPortConfig - only for linux)
+    bool SettingControlApply(int baud_rate, uint32_t flags, uint32_t mask);
+
+    // dtr/dsr flow control is only available on windows - linux has no
+    // termios flag for it, so setting it fails there
+    eComPortFlowControl SettingFlowControlGet(void);
+    bool SettingFlowControlSet(eComPortFlowControl flow_control);
+
+    // if enabled, bytes with parity or framing errors and breaks are
+    // not dropped but marked in the stream as "\377 \0 <byte>" and a
+    // valid "\377" is received twice (only for linux - see PARMRK)
+    bool SettingErrorMarkGet(void);
+    bool SettingErrorMarkSet(bool state);
+
+    // receive policy is only for linux (see VMIN and VTIME of termios)
+    // non-blocking (default): Receive returns all available bytes at once
+    //   without waiting - if min_bytes > 0 and milliseconds == 0, a poll
+    //   on FileGet only signals data after min_bytes were received
+    // blocking: Receive waits within the kernel until
+    //   min_bytes == 0, milliseconds == 0: never (same as non-blocking)
+    //   min_bytes >  0, milliseconds == 0: min_bytes were received
+    //   min_bytes == 0, milliseconds >  0: one byte was received or the
+    //                                      time is up (returns "")
+    //   min_bytes >  0, milliseconds >  0: min_bytes were received or the
+    //                                      time between two bytes is up
+    //                                      (waits forever for the first)
+    // min_bytes is at most 255 and milliseconds (at most 25500) is rounded
+    // up to 100ms steps - in blocking mode Transmit may block, too
+    // note: recent kernels wake the reader after 64 bytes at the latest,
+    // so larger values of min_bytes behave like 64
+    bool SettingReceivePolicySet(int min_bytes, int milliseconds,
+      bool blocking);
+    int  SettingReceiveMinGet(void);
+    int  SettingReceiveTimeoutGet(void);
+    bool SettingReceiveBlockingGet(void);
+
+    // these 2 functions are only for linux
+    // delta returns the changes since the baseline and stores the current
+    // values in it - the baseline is owned by the caller, so several users
+    // can track changes independently (initialize it with CounterGet)
+    bool CounterGet(sComPortCounters &counters);
+    bool CounterDeltaGet(sComPortCounters &baseline,
+      sComPortCounters &counters);
+
+    // rs485 direction control is done by the kernel driver (TIOCSRS485)
+    // if supported - otherwise Transmit switches rts itself after the
+    // output was drained (rx_during_tx is only used by the kernel driver)
+    // in userspace Transmit gives up after twice the time on the line plus
+    // one second - it discards the rest, releases rts and returns false
+    sComPortRs485 SettingRs485Get(void);
+    bool SettingRs485Set(sComPortRs485 rs485);
+    // returns true if the kernel driver handles rs485
+    bool SettingRs485KernelGet(void);
+
+    // the counters are updated without locks, so they can be read from
+    // any thread (e.g. by cComPortMetrics)
+    void StatisticGet(sComPortStatistic &statistic) const;
+    void StatisticReset(void);
+    // used by all classes accessing the file of the port directly (e.g.
+    // cComPortIo, cComPortRelay or cComPortGroup) - a negative count is
+    // an error and time is the duration of the write in microseconds
+    void StatisticWrite(int count, int64_t time);
+    void StatisticRead(int count);
+
+    // returns the monotonic time in microseconds
+    static int64_t TimeGet(void);
+
+  protected:
+    // set after the device was lost (hangup or EIO on read or write) and
+    // cleared by Open and Close - only the reconnect of cComPortBuffer
+    // keeps it after closing the lost device (only for linux)
+    bool port_lost;
+
+  private:
+    bool Rs485Apply(void);
+    // returns true if a serial port (not a transport) is opened
+    bool IsTermios(void);
+    int PortWrite(const char *data, int size);
+    int PortRead(char *data, int size);
+    // only for linux - keeps port_transmit_count up to date
+    void TransmitPendingUpdate(void);
+
+    std::string port_name;
+    cComPortTransport *transport;
+    bool port_opened;
+    sComPortStatistic port_statistic;
+
+    // internal system-dependend variables
+    #if (defined(__WIN32) || defined(__WIN64))
+        int port_file;
+        HANDLE port_file;
+        DCB port_settings;
+        int port_buffer_in_size;
+        int port_buffer_out_size;
+        sComPortRs485 port_rs485;
+        bool port_rs485_kernel;
+        int64_t port_transmit_time;
+    #else
+        // the default transport - transport points to it if no other one
+        // was set
+        cComPortSerial port_serial;
+        termios port_settings;
+        int port_baudrate;
+        sComPortRs485 port_rs485;
+        bool port_rs485_kernel;
+        bool port_receive_blocking;
+        int port_pacing;
+        std::string port_transmit_pending;
+        int port_transmit_offset;
+        // size of the held back data (atomic) for TransmitPendingGet
+        int port_transmit_count;
+        int64_t port_transmit_time;
+    #endif //#if (defined(__WIN32) || defined(__WIN64))
+};
+
+class cComPortMatcher;
+
+//*****************************************************************************
+//**************************{class cComPortBuffer}*****************************
+//*****************************************************************************
+class cComPortBuffer : public cComPort {
+  public:
+    cComPortBuffer(void);
+    ~cComPortBuffer(void);
+
+    std::string BufferGet(void) const;
+    void BufferUpdate(void);
+    void BufferClear(void);
+
+    bool BufferWait(int count);
+    bool BufferWait(std::string text);
+    // waits until one of the patterns was received - returns the index of
+    // the pattern and its offset within the buffer or -1 after timeout
+    // the search continues behind the last match of the previous call, so
+    // each match is reported once (until BufferClear) - a different or
+    // reset matcher starts at the beginning of the buffer again
+    int BufferWaitAny(cComPortMatcher &matcher, int &offset);
+    int BufferWaitAny(const std::vector<std::string> &patterns, int &offset);
+    void BufferTimeSet(int milliseconds);
+    // reserves memory for the receive buffer (avoids reallocations)
+    void BufferReserve(int bytes);
+    // number of bytes within the receive buffer
+    int  BufferCountGet(void) const;
+
+    // capacity limits the receive buffer (0 = unlimited, default) - the
+    // overflow policy decides about bytes which do not fit anymore:
+    //   kCpOverflowDropOldest: the oldest bytes of the buffer are dropped
+    //   kCpOverflowDropNewest: the received bytes are dropped
+    //   kCpOverflowBlock     : the bytes are left in the driver, so flow
+    //                          control can stop the sender
+    //   kCpOverflowCallback  : the received bytes are given to the callback
+    void BufferCapacitySet(int bytes, eComPortOverflow overflow);
+    int  BufferCapacityGet(void) const;
+    eComPortOverflow BufferOverflowGet(void) const;
+    void BufferOverflowCallbackSet(void (*callback)(cComPortBuffer *port,
+      const std::string &text, void *data), void *data);
+    // dropped bytes (including the ones given to the callback) and the
+    // maximum size of the receive buffer since the last reset
+    int64_t BufferDroppedGet(void) const;
+    int  BufferPeakGet(void) const;
+    void BufferStatisticReset(void);
+
+    void Wait(int milliseconds) const;
+
+    // the clock is used by all timeouts (BufferWait, Wait and reconnect) -
+    // it is not owned by the port and NULL restores the system clock
+    void ClockSet(cComPortClock *clock);
+    cComPortClock *ClockGet(void) const;
+
+    // reconnect is only for linux
+    // if enabled, BufferUpdate closes the port after the device was lost
+    // and reopens it (with the last settings) as soon as it reappears -
+    // the receive buffer is kept
+    // ports closed by Close (or never opened) are not reopened
+    void ReconnectSet(bool enabled);
+    bool ReconnectGet(void) const;
+    void ReconnectCallbackSet(void (*callback)(cComPortBuffer *port,
+      bool connected, void *data), void *data);
+    int  ReconnectCountGet(void) const;
+
+  private:
+    // returns nanoseconds of the current clock
+    int64_t GetCurrentTime(void) const;
+    void SleepOneMilliSecond(void) const;
+    void ReconnectUpdate(void);
+    void BufferAppend(const std::string &text);
+
+    std::string receive_buffer;
+    // bytes removed from the front of the buffer since the start
+    int64_t receive_removed;
+    int receive_time;
+    cComPortClock *time_clock;
+
+    int receive_capacity;
+    eComPortOverflow receive_overflow;
+    int64_t receive_dropped;
+    int receive_peak;
+    // state of BufferWaitAny - the matcher position search_base is the
+    // same as receive_removed (the front of the buffer) at that time
+    cComPortMatcher *search_matcher;
+    int64_t search_base;
+    // owned matcher for the patterns given by BufferWaitAny
+    cComPortMatcher *search_patterns;
+    void (*overflow_callback)(cComPortBuffer *port, const std::string &text,
+      void *data);
+    void *overflow_data;
+
+    bool reconnect_enabled;
+    int reconnect_count;
+    int reconnect_delay;
+    int64_t reconnect_time;
+    void (*reconnect_callback)(cComPortBuffer *port, bool connected,
+      void *data);
+    void *reconnect_data;
+    // this variable is only used by linux (inotify)
+    int reconnect_notify;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_H
@@ -0,0 +1,108 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_autobaud.h                                                    *
+* ========================                                                    *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_AUTOBAUD_H
+#define __WEPET_COMPORT_AUTOBAUD_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <vector>
+
+// additional headers
+
+
+
+namespace wepet {
+
+struct sComPortAutoBaudCandidate {
+    int baud_rate;
+    eComPortByteSize byte_size;
+    eComPortParity parity;
+    eComPortStopBits stop_bits;
+};
+
+// errors are framing, parity, break and overrun errors counted by the
+// kernel (only for linux and only if supported by the driver)
+// confidence is between 0.0 (no match) and 1.0
+struct sComPortAutoBaudResult {
+    sComPortAutoBaudCandidate candidate;
+    int bytes;
+    int errors;
+    double confidence;
+};
+
+//*****************************************************************************
+//**************************{class cComPortAutoBaud}***************************
+//*****************************************************************************
+// Detects baud rate and framing by trying each candidate in turn.
+// For every candidate the input is flushed, the probe (if any) is sent
+// and the port listens for a while. The received text is scored by the
+// error rate of the kernel counters and by the validator - without
+// validator the share of printable characters is used. The detection
+// stops as soon as a candidate reaches the threshold.
+class cComPortAutoBaud {
+  public:
+    cComPortAutoBaud(void);
+    ~cComPortAutoBaud(void);
+
+    void CandidateAdd(int baud_rate, eComPortByteSize byte_size = kCpByteSize8,
+      eComPortParity parity = kCpParityNone,
+      eComPortStopBits stop_bits = kCpStopBits1);
+    // common baud rates with 8N1, 7E1 and 8E1
+    void CandidateAddDefault(void);
+    void CandidateClear(void);
+    int  CandidateCountGet(void) const;
+
+    // probe is sent after switching to a candidate (e.g. "AT\r")
+    void ProbeSet(std::string text);
+    // validator returns a score between 0.0 and 1.0 for the received text
+    void ValidatorSet(double (*validator)(const std::string &text,
+      void *data), void *data);
+
+    // maximum listening time per candidate
+    void TimeSet(int milliseconds);
+    void ThresholdSet(double confidence);
+
+    // returns the index of the best candidate (which is applied to the
+    // port) or -1 if nothing was received at all
+    int Detect(cComPortBuffer &port);
+
+    // results of all tested candidates of the last detection
+    int ResultCountGet(void) const;
+    sComPortAutoBaudResult ResultGet(int index) const;
+    // confidence of the best candidate of the last detection
+    double ConfidenceGet(void) const;
+
+  private:
+    double Score(sComPortAutoBaudResult &result, const std::string &text);
+    static double ScorePrintable(const std::string &text);
+
+    std::vector<sComPortAutoBaudCandidate> candidates;
+    std::vector<sComPortAutoBaudResult> results;
+    double confidence;
+
+    std::string probe;
+    double (*validator)(const std::string &text, void *data);
+    void *validator_data;
+
+    int time;
+    double threshold;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_AUTOBAUD_H
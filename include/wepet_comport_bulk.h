@@ -0,0 +1,81 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_bulk.h                                                        *
+* ====================                                                        *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_BULK_H
+#define __WEPET_COMPORT_BULK_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// additional headers
+
+
+
+namespace wepet {
+
+// times are given in microseconds, error is the errno of a failed open
+struct sComPortBulkResult {
+    bool success;
+    int error;
+    int64_t time_start;
+    int64_t duration;
+};
+
+//*****************************************************************************
+//**************************{class cComPortBulk}*******************************
+//*****************************************************************************
+// Opens many ports concurrently on a limited number of threads.
+// All settings given to the ports before (baud rate, byte size, flow
+// control, rs485 ...) are applied during Open as usual.
+class cComPortBulk {
+  public:
+    cComPortBulk(void);
+    ~cComPortBulk(void);
+
+    void Add(cComPort *port, std::string port_name);
+    void Clear(void);
+    int  CountGet(void) const;
+
+    void ThreadCountSet(int count);
+    int  ThreadCountGet(void) const;
+
+    // returns true if all ports were opened
+    bool Open(void);
+    bool ResultGet(int index, sComPortBulkResult &result) const;
+    // duration of the last call of Open in microseconds
+    int64_t DurationGet(void) const;
+
+  private:
+    struct sEntry {
+        cComPort *port;
+        std::string name;
+        sComPortBulkResult result;
+    };
+
+    static void *ThreadMain(void *data);
+
+    std::vector<sEntry> entries;
+    int entry_next;
+    int thread_count;
+    int64_t duration;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_BULK_H
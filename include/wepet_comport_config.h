@@ -0,0 +1,151 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_config.h                                                      *
+* ======================                                                      *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_CONFIG_H
+#define __WEPET_COMPORT_CONFIG_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <stdint.h>
+
+// additional headers
+
+
+
+namespace wepet {
+
+#if (defined(__WIN32) || defined(__WIN64))
+#else
+//**************************[ComPortBaudFlagGet]*******************************
+// baud rates without own flag use B38400 and a custom divisor
+constexpr tcflag_t ComPortBaudFlagGet(int baud_rate) {
+
+    return
+      baud_rate ==     50 ?     B50 : baud_rate ==     75 ?     B75 :
+      baud_rate ==    110 ?    B110 : baud_rate ==    134 ?    B134 :
+      baud_rate ==    150 ?    B150 : baud_rate ==    200 ?    B200 :
+      baud_rate ==    300 ?    B300 : baud_rate ==    600 ?    B600 :
+      baud_rate ==   1200 ?   B1200 : baud_rate ==   1800 ?   B1800 :
+      baud_rate ==   2400 ?   B2400 : baud_rate ==   4800 ?   B4800 :
+      baud_rate ==   9600 ?   B9600 : baud_rate ==  19200 ?  B19200 :
+      baud_rate ==  38400 ?  B38400 : baud_rate ==  57600 ?  B57600 :
+    #if defined( B76800)
+      baud_rate ==  76800 ?  B76800 :
+    #endif
+    #if defined(B115200)
+      baud_rate == 115200 ? B115200 :
+    #endif
+    #if defined(B153600)
+      baud_rate == 153600 ? B153600 :
+    #endif
+    #if defined(B230400)
+      baud_rate == 230400 ? B230400 :
+    #endif
+    #if defined(B307200)
+      baud_rate == 307200 ? B307200 :
+    #endif
+    #if defined(B460800)
+      baud_rate == 460800 ? B460800 :
+    #endif
+      B38400;
+}
+
+//**************************[ComPortControlFlagGet]****************************
+// same flags as set by SettingByteSizeSet, SettingParitySet and
+// SettingStopBitsSet (without the baud rate)
+constexpr tcflag_t ComPortControlFlagGet(eComPortByteSize byte_size,
+  eComPortParity parity, eComPortStopBits stop_bits) {
+
+    return
+      (byte_size == kCpByteSize5 ? CS5 : byte_size == kCpByteSize6 ? CS6 :
+       byte_size == kCpByteSize7 ? CS7 : CS8) |
+      (stop_bits == kCpStopBits2 ? CSTOPB : 0) |
+    #if defined(PAREXT)
+      (parity == kCpParityMark  ? (PARENB | PARODD | PAREXT) :
+       parity == kCpParitySpace ? (PARENB |          PAREXT) :
+    #else // if defined(PAREXT)
+      (
+    #endif // if defined(PAREXT)
+       parity == kCpParityOdd   ? (PARENB | PARODD         ) :
+       parity == kCpParityEven  ? (PARENB                  ) : 0);
+}
+#endif //#if (defined(__WIN32) || defined(__WIN64))
+
+//*****************************************************************************
+//**************************{class cComPortConfig}*****************************
+//*****************************************************************************
+// Fixed port configuration - all values are checked and all flags and
+// timings are computed at compile time. Apply sets baud rate, byte size,
+// parity and stop bits with a single tcsetattr (only for linux).
+// Example:
+//   typedef cComPortConfig<115200, kCpByteSize8, kCpParityNone,
+//     kCpStopBits1> tConfig;
+//   tConfig::Apply(port);
+template <int baud_rate, eComPortByteSize byte_size = kCpByteSize8,
+  eComPortParity parity = kCpParityNone,
+  eComPortStopBits stop_bits = kCpStopBits1>
+class cComPortConfig {
+  public:
+    static_assert(baud_rate > 0, "baud rate must be positive");
+    static_assert((byte_size >= kCpByteSize5) && (byte_size <= kCpByteSize8),
+      "byte size must be 5, 6, 7 or 8");
+    static_assert((stop_bits == kCpStopBits1) || (stop_bits == kCpStopBits2),
+      "stop bits must be 1 or 2");
+    static_assert((parity >= kCpParityNone) && (parity <= kCpParitySpace),
+      "unknown parity");
+
+    static constexpr int              kBaudRate = baud_rate;
+    static constexpr eComPortByteSize kByteSize = byte_size;
+    static constexpr eComPortParity   kParity   = parity;
+    static constexpr eComPortStopBits kStopBits = stop_bits;
+
+    // start bit, data bits, parity bit and stop bits
+    static constexpr int kFrameBits = 1 + (int) byte_size +
+      (parity == kCpParityNone ? 0 : 1) + (stop_bits == kCpStopBits2 ? 2 : 1);
+
+    // duration of one character and of a frame in nanoseconds (rounded up)
+    static constexpr int64_t kCharTime =
+      ((int64_t) kFrameBits * 1000000000 + baud_rate - 1) / baud_rate;
+    static constexpr int64_t FrameTimeGet(int bytes) {
+        return kCharTime * bytes;
+    }
+
+  #if (defined(__WIN32) || defined(__WIN64))
+  #else
+    #if ! defined(PAREXT)
+        static_assert((parity != kCpParityMark) &&
+          (parity != kCpParitySpace), "mark and space parity not supported");
+    #endif // #if ! defined(PAREXT)
+
+    static constexpr tcflag_t kBaudFlag = ComPortBaudFlagGet(baud_rate);
+
+    static constexpr tcflag_t kControlFlags = kBaudFlag |
+      ComPortControlFlagGet(byte_size, parity, stop_bits);
+    static constexpr tcflag_t kControlMask = CBAUD | CBAUDEX | CSIZE |
+      CSTOPB | ComPortControlFlagGet(kCpByteSize5, kCpParityMark,
+      kCpStopBits1) | PARENB | PARODD;
+
+    // returns false on error - custom baud rates are set by the divisor
+    static bool Apply(cComPort &port) {
+        return port.SettingControlApply(baud_rate, kControlFlags,
+          kControlMask);
+    }
+  #endif //#if (defined(__WIN32) || defined(__WIN64))
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_CONFIG_H
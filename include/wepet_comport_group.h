@@ -0,0 +1,98 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_group.h                                                       *
+* =====================                                                       *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_GROUP_H
+#define __WEPET_COMPORT_GROUP_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// additional headers
+
+
+
+namespace wepet {
+
+// count is the number of bytes written during the batch, time is given in
+// nanoseconds (monotonic clock) after the first write had returned and
+// error is the errno of a failed write
+struct sComPortGroupResult {
+    bool success;
+    int error;
+    int count;
+    int64_t time;
+};
+
+//*****************************************************************************
+//**************************{class cComPortGroup}******************************
+//*****************************************************************************
+// Transmits the same data to many ports at nearly the same time - this
+// class is only for linux.
+// Stage copies the data once. Transmit fetches the files of the ports
+// (a reopened port may have another file), writes the data to all files
+// in a tight loop without anything else in between (ports without a file,
+// e.g. transports, follow afterwards) and finishes partial writes later
+// on. The skew is the time between the first and the last port.
+// The statistics of the ports (see cComPort::StatisticGet) are updated
+// after the batch.
+// Note: the data is written directly to the files, so pacing and rs485
+// switching by software are bypassed.
+class cComPortGroup {
+  public:
+    cComPortGroup(void);
+    ~cComPortGroup(void);
+
+    // the ports are not owned and must stay valid
+    void Add(cComPort *port);
+    bool Remove(cComPort *port);
+    void Clear(void);
+    int  CountGet(void) const;
+
+    // returns false if one of the ports is not opened
+    bool Stage(const std::string &text);
+
+    // waits at most the given time for partial writes
+    // returns the number of ports which received all data
+    int Transmit(int milliseconds);
+
+    bool ResultGet(int index, sComPortGroupResult &result) const;
+    // skew and duration of the last batch in nanoseconds
+    int64_t SkewGet(void) const;
+    int64_t DurationGet(void) const;
+
+  private:
+    struct sEntry {
+        cComPort *port;
+        int file;
+        sComPortGroupResult result;
+    };
+
+    void Finish(int milliseconds);
+
+    std::vector<sEntry> entries;
+    std::string payload;
+    cComPortClockMonotonic time_clock;
+
+    int64_t skew;
+    int64_t duration;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_GROUP_H
@@ -0,0 +1,212 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_io.h                                                          *
+* ==================                                                          *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_IO_H
+#define __WEPET_COMPORT_IO_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// additional headers
+#include <pthread.h>
+
+
+
+namespace wepet {
+
+enum eComPortIoBackend {
+    kCpIoNone  = 0,
+    kCpIoAuto  = 1,
+    kCpIoUring = 2,
+    kCpIoEpoll = 3
+};
+
+enum eComPortIoRealtime {
+    kCpIoRealtimeAffinity = 0x01,
+    kCpIoRealtimeFifo     = 0x02,
+    kCpIoRealtimeLocked   = 0x04
+};
+
+// cpu < 0 keeps the affinity, priority < 1 keeps the scheduling policy
+struct sComPortIoRealtime {
+    bool enabled;
+    int cpu;
+    int priority;
+    bool lock_memory;
+};
+
+struct sComPortIoStatistic {
+    int64_t rx_bytes;
+    int64_t rx_chunks;
+    int64_t tx_bytes;
+    int64_t tx_chunks;
+    int64_t syscalls;
+};
+
+//*****************************************************************************
+//**************************{class cComPortIo}*********************************
+//*****************************************************************************
+// Event loop for many ports - this class is only for linux.
+// With io_uring a read is kept posted on every port (linked to a poll, as
+// the ports are non-blocking) and the data is placed in a ring of provided
+// buffers. All reads and queued transmits are submitted with one syscall
+// per Update. If io_uring is not available, epoll is used instead.
+// The ports are accessed by their files (see cComPort::FileGet) - the
+// receive and transmit functions of cComPort must not be used meanwhile.
+// The statistics of the ports (see cComPort::StatisticGet) are updated.
+class cComPortIo {
+  public:
+    cComPortIo(void);
+    ~cComPortIo(void);
+
+    // buffers are shared by all ports (count is rounded to a power of two)
+    bool Open(eComPortIoBackend backend = kCpIoAuto, int buffer_count = 256,
+      int buffer_size = 4096);
+    void Close(void);
+    eComPortIoBackend BackendGet(void) const;
+
+    // the port must be opened and must have a file
+    bool Add(cComPort *port);
+    bool Remove(cComPort *port);
+    int  CountGet(void) const;
+
+    // called from Update for every received chunk
+    void CallbackSet(void (*callback)(cComPort *port, const char *text,
+      int size, void *data), void *data);
+
+    // data is queued and written during the next Update
+    bool Transmit(cComPort *port, const std::string &text);
+    int  TransmitPendingGet(cComPort *port);
+    // reserves the transmit buffers of each port (avoids allocations)
+    void TransmitReserve(int bytes);
+
+    // returns the number of received bytes or -1 on error
+    int Update(int milliseconds);
+
+    // optional thread calling Update - while it is running, ports must
+    // not be added or removed and the callback is called by the thread
+    // (Transmit may be called from any thread)
+    bool ThreadStart(void);
+    void ThreadStop(void);
+    bool ThreadIsRunning(void) const;
+
+    // real-time mode of the thread (only used by ThreadStart):
+    // cpu affinity, SCHED_FIFO and locked, prefaulted memory (mlockall
+    // affects the whole process) - each part falls back to normal
+    // operation if not permitted
+    void RealtimeSet(sComPortIoRealtime realtime);
+    sComPortIoRealtime RealtimeGet(void) const;
+    // combination of eComPortIoRealtime which were applied successfully
+    int  ThreadRealtimeGet(void) const;
+
+    sComPortIoStatistic StatisticGet(void) const;
+    void StatisticReset(void);
+
+  private:
+    struct sSlot {
+        cComPort *port;
+        int file;
+        bool active;
+        bool receiving;
+        bool writing;
+        // number of submitted operations without completion
+        int pending;
+        // submission of the running write (microseconds)
+        int64_t tx_time;
+        std::string tx_queue;
+        std::string tx_flight;
+    };
+
+    int SlotFind(cComPort *port) const;
+    void SlotUpdate(int index);
+    void Dispatch(sSlot &slot, const char *text, int size);
+
+    bool UringOpen(int buffer_count, int buffer_size);
+    void UringClose(void);
+    void UringSubmit(void);
+    bool UringSqeReserve(int count);
+    void *UringSqe(void);
+    bool UringEnter(int milliseconds);
+    void UringRead(int index);
+    void UringWrite(int index, bool poll);
+    void UringCancel(int index);
+    void UringComplete(uint64_t user_data, int result, uint32_t flags);
+    void UringBufferRecycle(int id);
+
+    static void *ThreadMain(void *data);
+    void ThreadRealtimeApply(void);
+
+    bool EpollOpen(int buffer_size);
+    void EpollClose(void);
+    bool EpollWait(int milliseconds);
+
+    eComPortIoBackend backend;
+    // the slots are allocated once, so their buffers keep their address
+    // while the kernel reads from them (io_uring writes)
+    std::vector<sSlot *> slots;
+    int slot_count;
+
+    void (*callback)(cComPort *port, const char *text, int size, void *data);
+    void *callback_data;
+
+    sComPortIoStatistic statistic;
+    int received;
+    int transmit_reserve;
+
+    // guards the transmit queues and the write state of the slots
+    pthread_mutex_t mutex;
+    pthread_t thread;
+    bool thread_running;
+    bool thread_ready;
+    int thread_realtime;
+    sComPortIoRealtime realtime;
+
+    // io_uring
+    int ring_file;
+    void *ring_sq;
+    void *ring_cq;
+    void *ring_sqes;
+    int ring_sq_size;
+    int ring_cq_size;
+    int ring_sqes_size;
+    uint32_t *ring_sq_head;
+    uint32_t *ring_sq_tail;
+    uint32_t *ring_sq_mask;
+    uint32_t *ring_sq_array;
+    uint32_t ring_sq_entries;
+    uint32_t *ring_cq_head;
+    uint32_t *ring_cq_tail;
+    uint32_t *ring_cq_mask;
+    void *ring_cqes;
+    int ring_submit;
+
+    // provided buffers (io_uring) or single read buffer (epoll)
+    void *buffer_ring;
+    int buffer_ring_size;
+    std::vector<char> buffers;
+    int buffer_count;
+    int buffer_size;
+
+    // epoll
+    int epoll_file;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_IO_H
@@ -0,0 +1,86 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_list.h                                                        *
+* ====================                                                        *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_LIST_H
+#define __WEPET_COMPORT_LIST_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <vector>
+
+// additional headers
+
+
+
+namespace wepet {
+
+// usb related entries are empty (or -1) for other devices
+struct sComPortInfo {
+    std::string name;
+    std::string device;
+    std::string by_id;
+    std::string driver;
+
+    int vendor_id;
+    int product_id;
+    std::string serial;
+    std::string manufacturer;
+    std::string product;
+
+    // sysfs path of the device and usb bus and device number - changes if
+    // the device was removed and (maybe another one) was plugged in
+    std::string identity;
+};
+
+//*****************************************************************************
+//**************************{class cComPortList}*******************************
+//*****************************************************************************
+// Lists all serial ports - this class is only for linux.
+// The ports are read from /sys/class/tty and /dev/serial/by-id without
+// opening them. Update only reads the details of new ports, all other
+// entries are kept within the cache as long as their identity (sysfs path
+// and usb device number) did not change.
+class cComPortList {
+  public:
+    cComPortList(void);
+    ~cComPortList(void);
+
+    bool Update(void);
+    void Clear(void);
+
+    int CountGet(void) const;
+    sComPortInfo ItemGet(int index) const;
+
+    // return the index of the port or -1 if not found
+    int FindByName(std::string name) const;
+    int FindBySerial(std::string serial) const;
+
+    // updates the list once if the serial number is unknown or the device
+    // was re-enumerated since the last update
+    bool OpenBySerial(cComPort &port, std::string serial);
+
+  private:
+    bool ItemRead(std::string name, sComPortInfo &info) const;
+    std::string IdentityRead(std::string name) const;
+    static std::string FileRead(std::string file_name);
+
+    std::vector<sComPortInfo> items;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_LIST_H
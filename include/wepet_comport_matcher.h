@@ -0,0 +1,75 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_matcher.h                                                     *
+* =======================                                                     *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_MATCHER_H
+#define __WEPET_COMPORT_MATCHER_H
+
+// local headers
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// additional headers
+
+
+
+namespace wepet {
+
+//*****************************************************************************
+//**************************{class cComPortMatcher}****************************
+//*****************************************************************************
+// Searches a stream for several patterns at once (Aho-Corasick).
+// The patterns are compiled into a complete automaton with one transition
+// per state and byte, so each byte costs a single table lookup regardless
+// of the number of patterns. The stream can be fed in arbitrary pieces.
+class cComPortMatcher {
+  public:
+    cComPortMatcher(void);
+    cComPortMatcher(const std::vector<std::string> &patterns);
+
+    // returns false if there are no patterns or one of them is empty
+    bool Compile(const std::vector<std::string> &patterns);
+    int  PatternCountGet(void) const;
+    std::string PatternGet(int index) const;
+
+    // restarts the stream
+    void Reset(void);
+
+    // feeds bytes until the first match - returns the index of the
+    // pattern or -1 if all bytes were consumed without a match
+    // (if patterns end at the same byte, the longest one is reported)
+    int Feed(const char *text, int size);
+    int Feed(const std::string &text);
+
+    // number of consumed bytes since Reset
+    int64_t PositionGet(void) const;
+    // position of the first byte of the last match (or -1)
+    int64_t OffsetGet(void) const;
+
+  private:
+    std::vector<std::string> patterns;
+    // 256 transitions per state and the pattern ending in each state
+    std::vector<int> table;
+    std::vector<int> output;
+
+    int state;
+    int64_t position;
+    int64_t offset;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_MATCHER_H
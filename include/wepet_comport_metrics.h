@@ -0,0 +1,159 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_metrics.h                                                     *
+* =======================                                                     *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_METRICS_H
+#define __WEPET_COMPORT_METRICS_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// additional headers
+
+
+
+namespace wepet {
+
+//*****************************************************************************
+//**************************{class cComPortMetrics}****************************
+//*****************************************************************************
+// Exports the statistics of many ports in the prometheus text format over
+// unix or tcp sockets - this class is only for linux.
+// Each scrape (a http request or TextGet) first copies the values of all
+// ports and formats the text afterwards. The statistics of cComPort and
+// the size of its pacing queue are read without locks, all other values
+// (buffer ports and driver values) should only be collected by the thread
+// using the ports.
+// The transfer counters include the data moved by cComPortIo,
+// cComPortRelay and cComPortGroup - the port of cComPortServer can be
+// added by its PortGet.
+// Metrics (all with the label port="name"):
+//   wepet_comport_opened
+//   wepet_comport_transmit_bytes_total, wepet_comport_receive_bytes_total
+//   wepet_comport_transmit_errors_total, wepet_comport_receive_errors_total
+//   wepet_comport_write_duration_seconds (histogram)
+//   wepet_comport_write_duration_quantile_seconds (0.5, 0.9 and 0.99 -
+//     estimated by the upper bound of the bucket)
+//   wepet_comport_queue_bytes (queue="pacing")
+//   buffer ports:
+//   wepet_comport_queue_bytes (queue="buffer")
+//   wepet_comport_dropped_bytes_total, wepet_comport_reconnects_total
+//   driver values:
+//   wepet_comport_driver_errors_total (type="frame", "parity", "overrun",
+//     "buf_overrun" or "break")
+//   wepet_comport_queue_bytes (queue="driver_in" or "driver_out")
+class cComPortMetrics {
+  public:
+    cComPortMetrics(void);
+    ~cComPortMetrics(void);
+
+    // the ports are not owned and must stay valid
+    void Add(cComPort *port, std::string name);
+    void Add(cComPortBuffer *port, std::string name);
+    bool Remove(cComPort *port);
+    void Clear(void);
+    int  CountGet(void) const;
+
+    // driver values need three ioctls per port (disabled by default)
+    void DriverSet(bool enabled);
+    bool DriverGet(void) const;
+
+    bool ListenUnix(std::string path);
+    bool ListenTcp(int tcp_port, std::string address);
+    void Close(void);
+
+    // answers the requests of all clients (any path is accepted)
+    bool Update(int milliseconds);
+    int  ClientCountGet(void) const;
+
+    std::string TextGet(void);
+    // duration of the last scrape in nanoseconds (collecting and
+    // formatting) and number of scrapes
+    int64_t ScrapeTimeGet(void) const;
+    int     ScrapeCountGet(void) const;
+
+  private:
+    // each line of a port starts with a prefix, that is created once:
+    // metric{port="name",...}<space>
+    struct sEntry {
+        cComPort *port;
+        cComPortBuffer *buffer;
+        std::vector<std::string> prefixes;
+        int size_max;
+    };
+
+    struct sSample {
+        bool opened;
+        bool driver;
+        sComPortStatistic statistic;
+        sComPortCounters counters;
+        int queue_driver_in;
+        int queue_driver_out;
+        int queue_pacing;
+        int queue_buffer;
+        int64_t dropped;
+        int reconnects;
+    };
+
+    struct sClient {
+        int file;
+        std::string request;
+        std::string reply;
+        int reply_offset;
+    };
+
+    void EntryAdd(cComPort *port, cComPortBuffer *buffer,
+      const std::string &name);
+    void Scrape(void);
+    void Collect(void);
+    void Render(void);
+
+    void PrefixAdd(sEntry &entry, const std::string &label,
+      const char *name, const std::string &extra);
+
+    void ClientAccept(int listener);
+    bool ClientRead(sClient &client);
+    bool ClientWrite(sClient &client);
+    void ClientRemove(int index);
+
+    static char *FamilyWrite(char *text, const char *name, const char *type,
+      const char *help);
+    static char *LineWrite(char *text, const std::string &prefix,
+      int64_t value);
+    static char *IntegerWrite(char *text, int64_t value);
+    static char *SecondsWrite(char *text, int64_t microseconds);
+
+    std::vector<sEntry> entries;
+    std::vector<sSample> samples;
+    bool driver;
+
+    // the text is only enlarged, so scrapes do not allocate memory
+    std::vector<char> text;
+    int text_size;
+    int64_t scrape_time;
+    int scrape_count;
+    cComPortClockMonotonic time_clock;
+
+    std::vector<int> listeners;
+    std::string listener_path;
+    std::vector<sClient> clients;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_METRICS_H
@@ -0,0 +1,136 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_pipeline.h                                                    *
+* ========================                                                    *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_PIPELINE_H
+#define __WEPET_COMPORT_PIPELINE_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <deque>
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+// additional headers
+#include <pthread.h>
+
+
+
+namespace wepet {
+
+// the stages are: chunks waiting within the ports (queue), ports waiting
+// for a worker (ready) and workers running the decoder (busy)
+struct sComPortPipelineStatistic {
+    int64_t chunks_in;
+    int64_t chunks_out;
+    int64_t bytes;
+    int64_t steals;
+
+    int queue_depth;
+    int queue_peak;
+    int ready_depth;
+    int busy;
+};
+
+//*****************************************************************************
+//**************************{class cComPortPipeline}***************************
+//*****************************************************************************
+// Hands received chunks to a pool of decoder threads.
+// The chunks of one port are decoded one after another in the order they
+// were submitted, while different ports are decoded in parallel. Each port
+// has a home worker - idle workers steal ports from the others.
+class cComPortPipeline {
+  public:
+    cComPortPipeline(void);
+    ~cComPortPipeline(void);
+
+    // the decoder is called from the worker threads
+    void DecoderSet(void (*decoder)(int port_id, const std::string &text,
+      void *data), void *data);
+
+    bool Start(int thread_count);
+    // all submitted chunks are decoded before the threads are stopped
+    void Stop(void);
+    bool IsRunning(void) const;
+
+    bool Submit(int port_id, const std::string &text);
+    // submits and clears the receive buffer of the port
+    bool Submit(int port_id, cComPortBuffer &port);
+
+    // waits until all submitted chunks were decoded
+    bool Flush(int milliseconds);
+
+    int QueueDepthGet(int port_id);
+    sComPortPipelineStatistic StatisticGet(void);
+    void StatisticReset(void);
+
+  private:
+    struct sStrand {
+        int port_id;
+        int home;
+        // guarded by mutex
+        std::deque<std::string> chunks;
+        bool scheduled;
+        pthread_mutex_t mutex;
+    };
+
+    struct sWorker {
+        cComPortPipeline *pipeline;
+        int index;
+        pthread_t thread;
+        // guarded by mutex
+        std::deque<sStrand *> ready;
+        pthread_mutex_t mutex;
+    };
+
+    static void *ThreadMain(void *data);
+    // joins and deletes all workers (control_mutex must be locked)
+    void WorkersStop(void);
+    sStrand *StrandGet(int port_id);
+    void StrandSchedule(sStrand *strand, int worker);
+    sStrand *StrandTake(int worker);
+    void StrandRun(sStrand *strand, int worker);
+
+    void (*decoder)(int port_id, const std::string &text, void *data);
+    void *decoder_data;
+
+    // running is published after the workers were created - Stop clears
+    // it and waits for the running submits (submit_count), so the workers
+    // exist as long as a submit sees running (all updated atomically)
+    std::vector<sWorker *> workers;
+    bool running;
+    int submit_count;
+    // serializes Start and Stop
+    pthread_mutex_t control_mutex;
+
+    std::map<int, sStrand *> strands;
+    pthread_mutex_t strands_mutex;
+
+    // sleeping workers wait for ready strands (stopping is guarded by
+    // idle_mutex)
+    int ready_count;
+    bool stopping;
+    pthread_mutex_t idle_mutex;
+    pthread_cond_t idle_cond;
+
+    // updated atomically
+    sComPortPipelineStatistic statistic;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_PIPELINE_H
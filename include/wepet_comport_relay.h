@@ -0,0 +1,132 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_relay.h                                                       *
+* =====================                                                       *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_RELAY_H
+#define __WEPET_COMPORT_RELAY_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <vector>
+#include <stdint.h>
+
+// additional headers
+#include <poll.h>
+
+
+
+namespace wepet {
+
+// throughput in bytes per second since the route was added (or reset)
+// latency in microseconds between reading and writing of a chunk
+struct sComPortRelayStatistic {
+    int64_t bytes;
+    int64_t chunks;
+    int64_t spliced;
+    int64_t throughput;
+    int64_t latency_average;
+    int64_t latency_max;
+};
+
+//*****************************************************************************
+//**************************{class cComPortRelay}******************************
+//*****************************************************************************
+// Moves bytes from one port to another port or to a file or pipe - this
+// class is only for linux.
+// Each route owns a pipe and uses splice, so the data does not pass the
+// user space. If the kernel does not support splice for one of the files
+// (or a tap callback is set) the route falls back to a fixed buffer which
+// is allocated once - the tap callback is given the data directly from
+// there. Ports without a file (e.g. transports) use Receive and Transmit.
+// The statistics of the ports (see cComPort::StatisticGet) are updated.
+// Note: the data is written directly to the file of the destination
+// port, so pacing and rs485 switching by software are bypassed.
+class cComPortRelay {
+  public:
+    cComPortRelay(void);
+    ~cComPortRelay(void);
+
+    // the ports and files are not owned and must stay valid - each route
+    // has one direction, so a bridge needs two routes
+    // returns the index of the route or -1 on error
+    int  RouteAdd(cComPort *source, cComPort *destination);
+    int  RouteAdd(cComPort *source, int file);
+    void Clear(void);
+    int  RouteCountGet(void) const;
+
+    // size of the pipe and of the buffer of each route (only used by
+    // the following routes)
+    void BufferSizeSet(int bytes);
+    int  BufferSizeGet(void) const;
+
+    // called for every chunk before it is written (disables splice - data
+    // which is already within a pipe is not passed to the callback)
+    void TapSet(void (*callback)(cComPortRelay *relay, int route,
+      const char *text, int size, void *data), void *data);
+
+    // moves the available data once - waits at most the given time
+    // returns the number of moved bytes or -1 on error
+    int Update(int milliseconds);
+
+    // returns true if the route uses splice
+    bool SpliceGet(int route) const;
+    bool StatisticGet(int route, sComPortRelayStatistic &statistic) const;
+    void StatisticReset(void);
+
+  private:
+    struct sRoute {
+        cComPort *source;
+        cComPort *destination;
+        int source_file;
+        int destination_file;
+
+        // splice: data is kept within the pipe
+        int pipe_files[2];
+        int pipe_count;
+        // fallback: data is kept within the buffer
+        std::vector<char> buffer;
+        int buffer_start;
+        int buffer_count;
+
+        int64_t read_time;
+        int64_t start_time;
+        int64_t bytes;
+        int64_t chunks;
+        int64_t spliced;
+        int64_t latency_sum;
+        int64_t latency_max;
+    };
+
+    int  RouteCreate(cComPort *source, cComPort *destination, int file);
+    void RouteClose(sRoute &route);
+    void SpliceDisable(sRoute &route);
+
+    int  RouteRead(int index);
+    int  RouteWrite(int index);
+    void RouteDone(sRoute &route);
+
+    std::vector<sRoute> routes;
+    std::vector<pollfd> poll_files;
+    std::vector<int> poll_routes;
+    int buffer_size;
+
+    void (*tap_callback)(cComPortRelay *relay, int route, const char *text,
+      int size, void *data);
+    void *tap_data;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_RELAY_H
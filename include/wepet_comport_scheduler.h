@@ -0,0 +1,118 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_scheduler.h                                                   *
+* =========================                                                   *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_SCHEDULER_H
+#define __WEPET_COMPORT_SCHEDULER_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <deque>
+#include <vector>
+#include <stdint.h>
+
+// additional headers
+
+
+
+namespace wepet {
+
+// all delays are given in microseconds
+struct sComPortSchedulerStatistic {
+    int64_t frames;
+    int64_t bytes;
+    int64_t delay_sum;
+    int64_t delay_max;
+    int64_t delay_last;
+};
+
+//*****************************************************************************
+//**************************{class cComPortScheduler}**************************
+//*****************************************************************************
+// Transmits frames of several priority classes over one port.
+// Class 0 has the highest priority. Classes without a share are served
+// strictly by priority, the remaining classes share the bandwidth
+// according to their share (deficit round robin).
+// Frames are never split - consecutive frames of one class are combined
+// into chunks of up to ChunkSizeSet bytes. Update writes only as long as
+// the output buffer of the port holds less than QueueDepthSet bytes, so
+// an urgent frame never waits behind more than this amount of data.
+// If the port accepts only a part of a chunk, the rest stays at the head
+// of its class and is written by the next Update before any other frame.
+class cComPortScheduler {
+  public:
+    cComPortScheduler(void);
+    ~cComPortScheduler(void);
+
+    void PortSet(cComPort *port);
+    cComPort *PortGet(void) const;
+
+    bool ClassCountSet(int count);
+    int  ClassCountGet(void) const;
+    // share is a relative weight (e.g. percent), 0 means strict priority
+    bool ClassShareSet(int priority, int share);
+    int  ClassShareGet(int priority) const;
+
+    void ChunkSizeSet(int bytes);
+    int  ChunkSizeGet(void) const;
+    void QueueDepthSet(int bytes);
+    int  QueueDepthGet(void) const;
+
+    // enqueues a single frame
+    bool Transmit(std::string frame, int priority);
+    // enqueues a payload as several frames of the given size
+    bool TransmitSplit(std::string data, int priority, int frame_size);
+    // writes as much data as the output buffer allows
+    bool Update(void);
+
+    int  PendingGet(int priority) const;
+    void PendingClear(int priority);
+
+    bool StatisticGet(int priority, sComPortSchedulerStatistic &statistic)
+      const;
+    void StatisticReset(void);
+
+  private:
+    struct sFrame {
+        std::string data;
+        int64_t time;
+        // rest of a partly written chunk (already in the statistic)
+        bool rest;
+    };
+
+    struct sClass {
+        std::deque<sFrame> frames;
+        int pending;
+        int share;
+        int deficit;
+        sComPortSchedulerStatistic statistic;
+    };
+
+    int ClassSelect(void);
+
+    cComPort *port;
+    std::vector<sClass> classes;
+    int class_next;
+    // class with the rest of a partly written chunk (or -1)
+    int class_rest;
+
+    int chunk_size;
+    int queue_depth;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_SCHEDULER_H
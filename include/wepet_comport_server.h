@@ -0,0 +1,132 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_server.h                                                      *
+* ======================                                                      *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_SERVER_H
+#define __WEPET_COMPORT_SERVER_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// additional headers
+
+
+
+namespace wepet {
+
+enum eComPortServerWrite {
+    kCpServerWriteAll   = 0,
+    kCpServerWriteFirst = 1,
+    kCpServerWriteNone  = 2
+};
+
+//*****************************************************************************
+//**************************{class cComPortServer}*****************************
+//*****************************************************************************
+// Serves one port to many clients over unix or tcp sockets - this class
+// is only for linux.
+// Received data is stored once within a shared buffer and each client
+// is sent its part directly from there. Clients that fall behind more
+// than BufferSizeSet bytes are disconnected.
+// Write access of the clients depends on the write mode:
+//   all   - every client may write
+//   first - the first writing client owns the port until it disconnects
+//           or was idle for WriteIdleSet milliseconds
+//   none  - data from clients is dropped
+// Data of a client is written to the port as far as the port takes it.
+// The rest is kept and the client is not read again until the port took
+// all of it - only a client hanging up meanwhile loses its rest.
+// WriteDroppedGet counts the bytes that were really discarded.
+// If rfc2217 is enabled, the telnet com port control option is
+// supported (baud rate, data size, parity, stop size, control, purge).
+// If the port hangs up, it is closed by Update - it can be reopened by
+// PortGet().Open while the clients stay connected.
+class cComPortServer {
+  public:
+    cComPortServer(void);
+    ~cComPortServer(void);
+
+    cComPort &PortGet(void);
+
+    bool ListenUnix(std::string path);
+    bool ListenTcp(int tcp_port, std::string address);
+    void Close(void);
+
+    // handles all sockets once - waits at most the given time
+    bool Update(int milliseconds);
+
+    int  ClientCountGet(void) const;
+    void BufferSizeSet(int bytes);
+    int  BufferSizeGet(void) const;
+
+    void WriteModeSet(eComPortServerWrite mode);
+    eComPortServerWrite WriteModeGet(void) const;
+    void WriteIdleSet(int milliseconds);
+    int  WriteDroppedGet(void) const;
+
+    void Rfc2217Set(bool enabled);
+    bool Rfc2217Get(void) const;
+
+  private:
+    struct sClient {
+        // file descriptors are reused - so the owner is kept by the id
+        int id;
+        int file;
+        int64_t position;
+        std::string reply;
+        // data not yet taken by the port
+        std::string pending;
+
+        int telnet_state;
+        std::string telnet_sub;
+    };
+
+    void ClientAccept(int listener);
+    bool ClientRead(sClient &client);
+    bool ClientWrite(sClient &client);
+    bool ClientTransmit(sClient &client);
+    void ClientRemove(int index);
+
+    std::string TelnetParse(sClient &client, const char *data, int size);
+    void TelnetCommand(sClient &client);
+    void BufferAppend(const std::string &data);
+
+    cComPort port;
+
+    std::vector<int> listeners;
+    std::string listener_path;
+    std::vector<sClient> clients;
+    int client_next;
+
+    std::string buffer;
+    int64_t buffer_start;
+    int buffer_size;
+
+    eComPortServerWrite write_mode;
+    // id of the owning client or -1
+    int write_owner;
+    int64_t write_time;
+    int write_idle;
+    int write_dropped;
+
+    bool rfc2217;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_SERVER_H
@@ -0,0 +1,124 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_shm.h                                                         *
+* ===================                                                         *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_SHM_H
+#define __WEPET_COMPORT_SHM_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <stdint.h>
+
+// additional headers
+
+
+
+namespace wepet {
+
+// layout of the shared memory (only for linux) - the records follow
+// directly after this header, positions are counted in bytes since start
+struct sComPortShmHeader {
+    uint32_t magic;
+    uint32_t capacity;
+    // oldest valid record and end of the newest record
+    uint64_t tail;
+    uint64_t head;
+    uint64_t sequence;
+    // futex word and number of sleeping subscribers
+    uint32_t wakeup;
+    uint32_t waiters;
+    uint8_t  reserved[24];
+};
+
+//*****************************************************************************
+//**************************{class cComPortShmPublisher}***********************
+//*****************************************************************************
+// Writes chunks or frames into a POSIX shared-memory ring (only for linux).
+// There is a single publisher and any number of subscribers. The publisher
+// never waits for subscribers - old records are overwritten and slow
+// subscribers detect the loss by the sequence numbers.
+class cComPortShmPublisher {
+  public:
+    cComPortShmPublisher(void);
+    ~cComPortShmPublisher(void);
+
+    // capacity is rounded up to a power of two (at least 4096 bytes)
+    bool Open(std::string name, int capacity);
+    bool IsOpened(void) const;
+    void Close(void);
+
+    // records may be at most half of the capacity
+    bool Publish(const std::string &data);
+    bool Publish(const char *data, int size);
+
+    // publishes the received data of the port - as one chunk if delimiter
+    // is empty, otherwise as frames ending with the delimiter
+    // returns the number of published records
+    int Update(cComPortBuffer &port, std::string delimiter = "");
+
+    uint64_t SequenceGet(void) const;
+
+  private:
+    std::string shm_name;
+    sComPortShmHeader *header;
+    char *records;
+    uint64_t mask;
+
+    std::string frame_rest;
+};
+
+//*****************************************************************************
+//**************************{class cComPortShmSubscriber}**********************
+//*****************************************************************************
+// Reads records from a ring created by cComPortShmPublisher (only for
+// linux). Receiving does not need any syscall, Wait sleeps on a futex
+// which is only woken by the publisher if a subscriber is waiting.
+class cComPortShmSubscriber {
+  public:
+    cComPortShmSubscriber(void);
+    ~cComPortShmSubscriber(void);
+
+    // only new records are received after opening
+    bool Open(std::string name);
+    bool IsOpened(void) const;
+    void Close(void);
+
+    // returns false if no record is available
+    bool Receive(std::string &data);
+    // returns true if a record is available
+    bool Wait(int milliseconds);
+
+    // sequence number of the last received record
+    uint64_t SequenceGet(void) const;
+    // number of records overwritten before they were received
+    uint64_t LostGet(void) const;
+
+  private:
+    void Resync(void);
+
+    sComPortShmHeader *header;
+    char *records;
+    uint64_t mask;
+    int map_size;
+
+    uint64_t position;
+    uint64_t sequence;
+    uint64_t lost;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_SHM_H
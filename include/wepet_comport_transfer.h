@@ -0,0 +1,164 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_transfer.h                                                    *
+* ========================                                                    *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_TRANSFER_H
+#define __WEPET_COMPORT_TRANSFER_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// additional headers
+
+
+
+namespace wepet {
+
+enum eComPortTransferMode {
+    kCpTransferWindow   = 0,
+    kCpTransferXmodem   = 1,
+    kCpTransferXmodem1k = 2,
+    kCpTransferYmodem   = 3
+};
+
+// bytes of payload and all bytes written to the line (framing, replies
+// and retransmits included) - duration is given in microseconds
+// efficiency compares the payload with the capacity of the line (baud
+// rate and frame bits of the port) during the transfer
+struct sComPortTransferStatistic {
+    int64_t bytes;
+    int64_t line_bytes;
+    int blocks;
+    int retransmits;
+    int errors;
+    int timeouts;
+    int64_t duration;
+    double efficiency;
+};
+
+//*****************************************************************************
+//**************************{class cComPortTransfer}***************************
+//*****************************************************************************
+// Bulk transfer of data blocks (e.g. firmware uploads) - this class is
+// only for linux.
+// The window mode keeps up to WindowSet blocks outstanding. Each block is
+// protected by a crc16 and acknowledged on its own, so only lost or
+// damaged blocks are sent again (selective repeat). The receiver reports
+// gaps immediately and every reply carries the next expected block, so
+// lost replies are repaired by the following ones.
+// Frames of the window mode (integers are little endian, the crc covers
+// all bytes after 0xA5 - data has an additional crc of its header):
+//   data : 0xA5 'D' <block:4> <size:2> <crc:2> <payload> <crc:2>
+//   ack  : 0xA5 'A' <block:4> <next:4> <crc:2>
+//   nak  : 0xA5 'N' <block:4> <next:4> <crc:2>
+//   end  : 0xA5 'E' <blocks:4> <bytes:4> <crc:2>
+// The xmodem modes (128 or 1024 bytes per block, crc or checksum) and
+// ymodem (single file) are stop-and-wait and compatible with the usual
+// tools - xmodem pads the last block with 0x1A (it is not removed by
+// Receive, as the size is not known).
+class cComPortTransfer {
+  public:
+    cComPortTransfer(void);
+    ~cComPortTransfer(void);
+
+    // the port is not owned and must stay valid while in use
+    void PortSet(cComPort *port);
+    cComPort *PortGet(void) const;
+
+    void ModeSet(eComPortTransferMode mode);
+    eComPortTransferMode ModeGet(void) const;
+
+    // only used by the window mode (block size is at most 65535)
+    void WindowSet(int blocks);
+    int  WindowGet(void) const;
+    void BlockSizeSet(int bytes);
+    int  BlockSizeGet(void) const;
+
+    // time to wait for a reply and number of retries per block
+    void TimeoutSet(int milliseconds);
+    int  TimeoutGet(void) const;
+    void RetryMaxSet(int count);
+    int  RetryMaxGet(void) const;
+
+    // name is only used by ymodem
+    bool Send(const std::string &data, std::string name = "");
+    bool Receive(std::string &data, std::string &name);
+
+    sComPortTransferStatistic StatisticGet(void) const;
+
+  private:
+    struct sFrame {
+        char type;
+        uint32_t block;
+        uint32_t value;
+        std::string payload;
+    };
+
+    // order counts all transmitted blocks (including retransmits)
+    struct sSlot {
+        bool acked;
+        int64_t order;
+        int64_t deadline;
+        int retries;
+    };
+
+    bool WindowSend(const std::string &data);
+    bool WindowReceive(std::string &data);
+    void WindowBlock(const std::string &data, uint32_t block);
+    void WindowWrite(char type, uint32_t block, uint32_t value,
+      const char *payload, int size);
+    bool WindowParse(sFrame &frame);
+
+    bool XmodemSend(const std::string &data, std::string name);
+    bool XmodemReceive(std::string &data, std::string &name);
+    bool XmodemBlock(int number, const char *payload, int size,
+      int block_size, bool crc);
+    int  XmodemParse(std::string &payload, int &number, bool crc,
+      int64_t time_end);
+
+    bool DataWait(int64_t time_end);
+    int  CharWait(int64_t time_end);
+    void Purge(void);
+    void Write(const std::string &text);
+    void StatisticStart(void);
+    void StatisticStop(void);
+
+    static uint16_t Crc16(const char *data, int size);
+
+    cComPort *port;
+    eComPortTransferMode mode;
+    int window;
+    int block_size;
+    int timeout;
+    int retry_max;
+
+    std::string receive_buffer;
+    std::vector<sSlot> window_slots;
+    int64_t window_order;
+    // time of one character in nanoseconds and estimated time until the
+    // line is idle again (monotonic time in microseconds)
+    int64_t char_time;
+    int64_t line_free;
+
+    sComPortTransferStatistic statistic;
+    int64_t time_start;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_TRANSFER_H
@@ -0,0 +1,126 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_transport.h                                                   *
+* =========================                                                   *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_TRANSPORT_H
+#define __WEPET_COMPORT_TRANSPORT_H
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <deque>
+#include <stdint.h>
+
+// additional headers
+#include <pthread.h>
+
+
+
+namespace wepet {
+
+//*****************************************************************************
+//**************************{class cComPortLoopback}***************************
+//*****************************************************************************
+// In-memory transport - two connected endpoints form a null modem.
+// Bytes written to one endpoint are read from the other one. Each
+// endpoint can throttle its output to a baud rate (10 bits per byte) and
+// drop bytes randomly (reproducible for a given seed).
+// All functions are thread-safe - each endpoint locks its own state and
+// never holds the lock of its peer at the same time. An endpoint must not
+// be destroyed while its peer is still in use.
+class cComPortLoopback : public cComPortTransport {
+  public:
+    cComPortLoopback(void);
+    ~cComPortLoopback(void);
+
+    bool Connect(cComPortLoopback &peer);
+
+    bool IsOpened(void);
+    void Close(void);
+
+    int Write(const char *data, int size);
+    int Read(char *data, int size);
+
+    int InCountGet(void);
+    int OutCountGet(void);
+
+    // 0 disables throttling
+    bool BaudRateSet(int baud_rate);
+    int  BaudRateGet(void);
+
+    // probability to drop a written byte (0.0 .. 1.0)
+    void LossSet(double probability, uint32_t seed);
+    int  LossCountGet(void);
+
+  private:
+    // times are given in nanoseconds
+    struct sChunk {
+        std::string data;
+        int offset;
+        int64_t time_start;
+        int64_t time_char;
+    };
+
+    int CountAvailable(const sChunk &chunk, int64_t time_curr) const;
+    static int64_t TimeGet(void);
+
+    // the mutex protects all following members
+    pthread_mutex_t mutex;
+    cComPortLoopback *peer;
+    std::deque<sChunk> receive_queue;
+
+    int baud_rate;
+    int64_t time_free;
+
+    double loss_probability;
+    uint32_t loss_state;
+    int loss_count;
+};
+
+//*****************************************************************************
+//**************************{class cComPortPty}********************************
+//*****************************************************************************
+// Pseudo terminal transport - this class is only for linux.
+// Open creates a new pair. The slave side can be opened by any cComPort
+// via SlaveNameGet, the master side is the transport itself. The slave
+// is kept open internally, so the pair survives reopening the slave.
+class cComPortPty : public cComPortTransport {
+  public:
+    cComPortPty(void);
+    ~cComPortPty(void);
+
+    bool Open(void);
+    std::string SlaveNameGet(void);
+
+    bool IsOpened(void);
+    void Close(void);
+
+    int Write(const char *data, int size);
+    int Read(char *data, int size);
+
+    int InCountGet(void);
+    int OutCountGet(void);
+
+    int FileGet(void);
+
+  private:
+    int port_master;
+    int port_slave;
+    std::string slave_name;
+};
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_TRANSPORT_H
@@ -1,164 +1,552 @@
-/******************************************************************************
-*                                                                             *
-* wepet_comport.cpp                                                           *
-* =================                                                           *
-*                                                                             *
-* Version: 1.1.4                                                              *
-* Date   : 18.10.15                                                           *
-* Author : Peter Weissig                                                      *
-*                                                                             *
-* For help or bug report please visit:                                        *
-*   https://github.com/peterweissig/cpp_comport/                              *
-******************************************************************************/
-
-// local headers
-#include "wepet_comport.h"
-
-// wepet headers
-
-// standard headers
-
-// additional headers
-
-
-
-#if (defined(__WIN32) || defined(__WIN64))
-    #include "wepet_comport_windows.cpp"
-#else
-    #include "wepet_comport_linux.cpp"
-#endif //#if (defined(__WIN32) || defined(__WIN64))
-
-namespace wepet {
-
-//**************************[~cComPortBuffer]**********************************
-cComPortBuffer::cComPortBuffer() {
-
-    receive_time = 100;
-}
-
-//**************************[~cComPortBuffer]**********************************
-cComPortBuffer::~cComPortBuffer() {
-
-    Close();
-}
-
-//**************************[BufferGet]****************************************
-std::string cComPortBuffer::BufferGet() const {
-
-    return receive_buffer;
-}
-
-//**************************[BufferUpdate]*************************************
-void cComPortBuffer::BufferUpdate() {
-
-    receive_buffer.append(Receive());
-}
-
-//**************************[BufferClear]**************************************
-void cComPortBuffer::BufferClear() {
-
-    receive_buffer = "";
-}
-
-//**************************[BufferWait]***************************************
-bool cComPortBuffer::BufferWait(int count) {
-
-    if (count < 1) {return true;}
-
-    int64_t time_start;
-    int64_t time_curr;
-
-    if (receive_buffer.size() >= count) {return true; }
-
-    if (! IsOpened()) { return false; }
-
-    time_start = GetCurrentTime();
-    if (time_start < 0) { return false; }
-
-    do {
-        SleepOneMilliSecond();
-
-        BufferUpdate();
-        if (receive_buffer.size() >= count) { return true; }
-
-        time_curr = GetCurrentTime();
-        if (time_curr < 0) { return false; }
-
-     } while (time_curr - time_start <= receive_time);
-
-    return false;
-
-}
-
-  //**************************[BufferWait]*************************************
-bool cComPortBuffer::BufferWait(std::string text) {
-
-    if (text == "") { return true; }
-
-    int64_t time_start;
-    int64_t time_curr;
-
-    int pos_curr;
-    int pos_max;
-
-    pos_max = receive_buffer.size();
-    if (pos_max > text.size()) { pos_max = text.size();}
-
-    for (pos_curr = 0; pos_curr < pos_max; pos_curr++) {
-        if (text[pos_curr] != receive_buffer[pos_curr]) { return false; }
-    }
-
-    if (text.size() <= pos_curr) { return true; }
-
-    if (! IsOpened()) { return false;}
-
-    time_start = GetCurrentTime();
-    if (time_start < 0) { return false; }
-
-    do {
-        SleepOneMilliSecond();
-
-        BufferUpdate();
-        if (receive_buffer.size() > pos_curr) {
-            pos_max = receive_buffer.size();
-            if (pos_max > text.size()) { pos_max = text.size(); }
-
-            for (; pos_curr < pos_max; pos_curr++) {
-                if (text[pos_curr] != receive_buffer[pos_curr]) {
-                    return false;
-                }
-            }
-            if (text.size() <= pos_curr) { return true; }
-        }
-
-        time_curr = GetCurrentTime();
-        if (time_curr < 0) { return false; }
-
-    } while (time_curr - time_start <= receive_time);
-
-    return false;
-}
-
-//**************************[BufferTimeSet]************************************
-void cComPortBuffer::BufferTimeSet(int milliseconds) {
-
-    if (milliseconds <     1) {milliseconds =     1;}
-    if (milliseconds > 10000) {milliseconds = 10000;}
-
-    receive_time = milliseconds;
-}
-
-//**************************[Wait]*********************************************
-void cComPortBuffer::Wait(int milliseconds) const {
-
-    int64_t time_start;
-    int64_t time_elapsed;
-
-    time_start = GetCurrentTime();
-    do {
-        SleepOneMilliSecond();
-        time_elapsed = GetCurrentTime() - time_start;
-    } while (time_elapsed <= milliseconds);
-}
-
-} // namespace wepet {
+/******************************************************************************
+*                                                                             *
+* wepet_comport.cpp                                                           *
+* =================                                                           *
+*                                                                             *
+* Version: 1.1.4                                                              *
+* Date   : 18.10.15                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport.h"
+#include "wepet_comport_matcher.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+
+
+
+#if (defined(__WIN32) || defined(__WIN64))
+    #include "wepet_comport_windows.cpp"
+#else
+    #include "wepet_comport_linux.cpp"
+#endif //#if (defined(__WIN32) || defined(__WIN64))
+
+namespace wepet {
+
+//**************************[~cComPortTransport]*******************************
+cComPortTransport::~cComPortTransport() {
+
+}
+
+//**************************[BaudRateSet]**************************************
+bool cComPortTransport::BaudRateSet(int baud_rate) {
+
+    return true;
+}
+
+//**************************[FileGet]******************************************
+int cComPortTransport::FileGet() {
+
+    return -1;
+}
+
+//**************************[~cComPortClock]***********************************
+cComPortClock::~cComPortClock() {
+
+}
+
+//**************************[cComPortClockVirtual]*****************************
+cComPortClockVirtual::cComPortClockVirtual(int64_t nanoseconds) {
+
+    time_current = nanoseconds;
+}
+
+//**************************[TimeGet]******************************************
+int64_t cComPortClockVirtual::TimeGet() {
+
+    return __atomic_load_n(&time_current, __ATOMIC_ACQUIRE);
+}
+
+//**************************[Sleep]********************************************
+void cComPortClockVirtual::Sleep(int64_t nanoseconds) {
+
+    Advance(nanoseconds);
+}
+
+//**************************[TimeSet]******************************************
+void cComPortClockVirtual::TimeSet(int64_t nanoseconds) {
+
+    __atomic_store_n(&time_current, nanoseconds, __ATOMIC_RELEASE);
+}
+
+//**************************[Advance]******************************************
+void cComPortClockVirtual::Advance(int64_t nanoseconds) {
+
+    if (nanoseconds <= 0) { return; }
+
+    __atomic_add_fetch(&time_current, nanoseconds, __ATOMIC_ACQ_REL);
+}
+
+//**************************[StatisticGet]*************************************
+void cComPort::StatisticGet(sComPortStatistic &statistic) const {
+
+    statistic.tx_bytes    = __atomic_load_n(&port_statistic.tx_bytes,
+      __ATOMIC_RELAXED);
+    statistic.tx_calls    = __atomic_load_n(&port_statistic.tx_calls,
+      __ATOMIC_RELAXED);
+    statistic.tx_errors   = __atomic_load_n(&port_statistic.tx_errors,
+      __ATOMIC_RELAXED);
+    statistic.rx_bytes    = __atomic_load_n(&port_statistic.rx_bytes,
+      __ATOMIC_RELAXED);
+    statistic.rx_calls    = __atomic_load_n(&port_statistic.rx_calls,
+      __ATOMIC_RELAXED);
+    statistic.rx_errors   = __atomic_load_n(&port_statistic.rx_errors,
+      __ATOMIC_RELAXED);
+    statistic.latency_sum = __atomic_load_n(&port_statistic.latency_sum,
+      __ATOMIC_RELAXED);
+
+    for (int i = 0; i < 20; i++) {
+        statistic.latency[i] = __atomic_load_n(&port_statistic.latency[i],
+          __ATOMIC_RELAXED);
+    }
+}
+
+//**************************[StatisticReset]***********************************
+void cComPort::StatisticReset() {
+
+    __atomic_store_n(&port_statistic.tx_bytes   , 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&port_statistic.tx_calls   , 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&port_statistic.tx_errors  , 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&port_statistic.rx_bytes   , 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&port_statistic.rx_calls   , 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&port_statistic.rx_errors  , 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&port_statistic.latency_sum, 0, __ATOMIC_RELAXED);
+
+    for (int i = 0; i < 20; i++) {
+        __atomic_store_n(&port_statistic.latency[i], 0, __ATOMIC_RELAXED);
+    }
+}
+
+//**************************[StatisticWrite]***********************************
+void cComPort::StatisticWrite(int count, int64_t time) {
+
+    int index;
+
+    if (count < 0) {
+        __atomic_add_fetch(&port_statistic.tx_errors, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    __atomic_add_fetch(&port_statistic.tx_bytes, count, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&port_statistic.tx_calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&port_statistic.latency_sum, time, __ATOMIC_RELAXED);
+
+    index = 0;
+    while ((index < 19) && (time > ((int64_t) 1 << index))) { index++; }
+    __atomic_add_fetch(&port_statistic.latency[index], 1, __ATOMIC_RELAXED);
+}
+
+//**************************[StatisticRead]************************************
+void cComPort::StatisticRead(int count) {
+
+    if (count < 0) {
+        __atomic_add_fetch(&port_statistic.rx_errors, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    __atomic_add_fetch(&port_statistic.rx_bytes, count, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&port_statistic.rx_calls, 1, __ATOMIC_RELAXED);
+}
+
+//**************************[~cComPortBuffer]**********************************
+cComPortBuffer::cComPortBuffer() {
+
+    receive_removed = 0;
+    receive_time    = 100;
+    time_clock      = NULL;
+
+    receive_capacity  = 0;
+    receive_overflow  = kCpOverflowDropOldest;
+    receive_dropped   = 0;
+    receive_peak      = 0;
+    search_matcher    = NULL;
+    search_base       = 0;
+    search_patterns   = NULL;
+    overflow_callback = NULL;
+    overflow_data     = NULL;
+
+    reconnect_enabled  = false;
+    reconnect_count    = 0;
+    reconnect_delay    = 0;
+    reconnect_time     = 0;
+    reconnect_callback = NULL;
+    reconnect_data     = NULL;
+    reconnect_notify   = -1;
+}
+
+//**************************[~cComPortBuffer]**********************************
+cComPortBuffer::~cComPortBuffer() {
+
+    ReconnectSet(false);
+    Close();
+
+    delete search_patterns;
+}
+
+//**************************[BufferGet]****************************************
+std::string cComPortBuffer::BufferGet() const {
+
+    return receive_buffer;
+}
+
+//**************************[BufferUpdate]*************************************
+void cComPortBuffer::BufferUpdate() {
+
+    int count_free;
+
+    if (reconnect_enabled) {
+        ReconnectUpdate();
+    }
+
+    if ((receive_capacity > 0) && (receive_overflow == kCpOverflowBlock)) {
+        // keep the remaining bytes within the driver
+        count_free = receive_capacity - receive_buffer.size();
+        if (count_free > 0) {
+            BufferAppend(Receive(count_free));
+        }
+        return;
+    }
+
+    BufferAppend(Receive());
+}
+
+//**************************[BufferClear]**************************************
+void cComPortBuffer::BufferClear() {
+
+    receive_removed+= receive_buffer.size();
+    receive_buffer = "";
+}
+
+//**************************[BufferWait]***************************************
+bool cComPortBuffer::BufferWait(int count) {
+
+    if (count < 1) {return true;}
+
+    int64_t time_start;
+    int64_t time_curr;
+
+    if (receive_buffer.size() >= count) {return true; }
+
+    if ((! IsOpened()) && (! reconnect_enabled)) { return false; }
+
+    time_start = GetCurrentTime();
+    if (time_start < 0) { return false; }
+
+    do {
+        SleepOneMilliSecond();
+
+        BufferUpdate();
+        if (receive_buffer.size() >= count) { return true; }
+
+        time_curr = GetCurrentTime();
+        if (time_curr < 0) { return false; }
+
+     } while (time_curr - time_start <= (int64_t) receive_time * 1000000);
+
+    return false;
+
+}
+
+  //**************************[BufferWait]*************************************
+bool cComPortBuffer::BufferWait(std::string text) {
+
+    if (text == "") { return true; }
+
+    int64_t time_start;
+    int64_t time_curr;
+
+    int pos_curr;
+    int pos_max;
+
+    pos_max = receive_buffer.size();
+    if (pos_max > text.size()) { pos_max = text.size();}
+
+    for (pos_curr = 0; pos_curr < pos_max; pos_curr++) {
+        if (text[pos_curr] != receive_buffer[pos_curr]) { return false; }
+    }
+
+    if (text.size() <= pos_curr) { return true; }
+
+    if ((! IsOpened()) && (! reconnect_enabled)) { return false;}
+
+    time_start = GetCurrentTime();
+    if (time_start < 0) { return false; }
+
+    do {
+        SleepOneMilliSecond();
+
+        BufferUpdate();
+        if (receive_buffer.size() > pos_curr) {
+            pos_max = receive_buffer.size();
+            if (pos_max > text.size()) { pos_max = text.size(); }
+
+            for (; pos_curr < pos_max; pos_curr++) {
+                if (text[pos_curr] != receive_buffer[pos_curr]) {
+                    return false;
+                }
+            }
+            if (text.size() <= pos_curr) { return true; }
+        }
+
+        time_curr = GetCurrentTime();
+        if (time_curr < 0) { return false; }
+
+    } while (time_curr - time_start <= (int64_t) receive_time * 1000000);
+
+    return false;
+}
+
+//**************************[BufferWaitAny]************************************
+int cComPortBuffer::BufferWaitAny(cComPortMatcher &matcher, int &offset) {
+
+    int64_t time_start;
+    int64_t time_curr;
+    int pos_curr;
+    int result;
+
+    offset = -1;
+    if (matcher.PatternCountGet() < 1) { return -1; }
+
+    // a new or reset matcher searches the whole buffer
+    if ((&matcher != search_matcher) || (matcher.PositionGet() == 0)) {
+        matcher.Reset();
+        search_matcher = &matcher;
+        search_base    = receive_removed;
+    }
+
+    time_start = GetCurrentTime();
+    if (time_start < 0) { return -1; }
+
+    while (true) {
+        // restarts if unsearched bytes were removed (dropped or cleared)
+        pos_curr = search_base + matcher.PositionGet() - receive_removed;
+        if (pos_curr < 0) {
+            matcher.Reset();
+            search_base = receive_removed;
+            pos_curr    = 0;
+        }
+
+        while (pos_curr < receive_buffer.size()) {
+            result = matcher.Feed(receive_buffer.data() + pos_curr,
+              receive_buffer.size() - pos_curr);
+            if (result >= 0) {
+                offset = search_base + matcher.OffsetGet() - receive_removed;
+                return result;
+            }
+            pos_curr = search_base + matcher.PositionGet() - receive_removed;
+        }
+
+        if ((! IsOpened()) && (! reconnect_enabled)) { return -1; }
+
+        time_curr = GetCurrentTime();
+        if (time_curr < 0) { return -1; }
+        if (time_curr - time_start > (int64_t) receive_time * 1000000) {
+            return -1;
+        }
+
+        SleepOneMilliSecond();
+        BufferUpdate();
+    }
+}
+
+//**************************[BufferWaitAny]************************************
+int cComPortBuffer::BufferWaitAny(const std::vector<std::string> &patterns,
+  int &offset) {
+
+    bool temp_equal;
+
+    if (search_patterns == NULL) { search_patterns = new cComPortMatcher(); }
+
+    // the matcher is kept as long as the patterns are the same
+    temp_equal = search_patterns->PatternCountGet() == patterns.size();
+    for (int i = 0; temp_equal && (i < patterns.size()); i++) {
+        temp_equal = search_patterns->PatternGet(i) == patterns[i];
+    }
+    if (! temp_equal) {
+        offset = -1;
+        if (! search_patterns->Compile(patterns)) { return -1; }
+        search_matcher = NULL;
+    }
+
+    return BufferWaitAny(*search_patterns, offset);
+}
+
+//**************************[BufferTimeSet]************************************
+void cComPortBuffer::BufferTimeSet(int milliseconds) {
+
+    if (milliseconds <     1) {milliseconds =     1;}
+    if (milliseconds > 10000) {milliseconds = 10000;}
+
+    receive_time = milliseconds;
+}
+
+//**************************[BufferReserve]************************************
+void cComPortBuffer::BufferReserve(int bytes) {
+
+    if (bytes < 0) { bytes = 0; }
+
+    receive_buffer.reserve(bytes);
+}
+
+//**************************[BufferCountGet]***********************************
+int cComPortBuffer::BufferCountGet() const {
+
+    return receive_buffer.size();
+}
+
+//**************************[BufferCapacitySet]********************************
+void cComPortBuffer::BufferCapacitySet(int bytes, eComPortOverflow overflow) {
+
+    if (bytes < 0) { bytes = 0; }
+
+    receive_capacity = bytes;
+    receive_overflow = overflow;
+}
+
+//**************************[BufferCapacityGet]********************************
+int cComPortBuffer::BufferCapacityGet() const {
+
+    return receive_capacity;
+}
+
+//**************************[BufferOverflowGet]********************************
+eComPortOverflow cComPortBuffer::BufferOverflowGet() const {
+
+    return receive_overflow;
+}
+
+//**************************[BufferOverflowCallbackSet]************************
+void cComPortBuffer::BufferOverflowCallbackSet(void (*callback)(
+  cComPortBuffer *port, const std::string &text, void *data), void *data) {
+
+    overflow_callback = callback;
+    overflow_data     = data;
+}
+
+//**************************[BufferDroppedGet]*********************************
+int64_t cComPortBuffer::BufferDroppedGet() const {
+
+    return receive_dropped;
+}
+
+//**************************[BufferPeakGet]************************************
+int cComPortBuffer::BufferPeakGet() const {
+
+    return receive_peak;
+}
+
+//**************************[BufferStatisticReset]*****************************
+void cComPortBuffer::BufferStatisticReset() {
+
+    receive_dropped = 0;
+    receive_peak    = receive_buffer.size();
+}
+
+//**************************[Wait]*********************************************
+void cComPortBuffer::Wait(int milliseconds) const {
+
+    int64_t time_start;
+    int64_t time_elapsed;
+
+    time_start = GetCurrentTime();
+    do {
+        SleepOneMilliSecond();
+        time_elapsed = GetCurrentTime() - time_start;
+    } while (time_elapsed <= (int64_t) milliseconds * 1000000);
+}
+
+//**************************[ClockSet]*****************************************
+void cComPortBuffer::ClockSet(cComPortClock *clock) {
+
+    time_clock = clock;
+}
+
+//**************************[ClockGet]*****************************************
+cComPortClock *cComPortBuffer::ClockGet() const {
+
+    return time_clock;
+}
+
+//**************************[GetCurrentTime]***********************************
+int64_t cComPortBuffer::GetCurrentTime() const {
+
+    static cComPortClockMonotonic clock_system;
+
+    if (time_clock == NULL) { return clock_system.TimeGet(); }
+    return time_clock->TimeGet();
+}
+
+//**************************[SleepOneMilliSecond]******************************
+void cComPortBuffer::SleepOneMilliSecond() const {
+
+    static cComPortClockMonotonic clock_system;
+
+    if (time_clock == NULL) {
+        clock_system.Sleep(1000000);
+    } else {
+        time_clock->Sleep(1000000);
+    }
+}
+
+//**************************[ReconnectGet]*************************************
+bool cComPortBuffer::ReconnectGet() const {
+
+    return reconnect_enabled;
+}
+
+//**************************[ReconnectCallbackSet]*****************************
+void cComPortBuffer::ReconnectCallbackSet(void (*callback)(
+  cComPortBuffer *port, bool connected, void *data), void *data) {
+
+    reconnect_callback = callback;
+    reconnect_data     = data;
+}
+
+//**************************[ReconnectCountGet]********************************
+int cComPortBuffer::ReconnectCountGet() const {
+
+    return reconnect_count;
+}
+
+//**************************[BufferAppend]*************************************
+void cComPortBuffer::BufferAppend(const std::string &text) {
+
+    int count_free;
+
+    if (text.empty()) { return; }
+
+    if ((receive_capacity == 0) ||
+      (receive_buffer.size() + text.size() <= receive_capacity)) {
+        receive_buffer.append(text);
+    } else if (receive_overflow == kCpOverflowDropOldest) {
+        receive_buffer.append(text);
+        count_free = receive_buffer.size() - receive_capacity;
+        receive_buffer.erase(0, count_free);
+        receive_removed+= count_free;
+        receive_dropped+= count_free;
+    } else {
+        count_free = receive_capacity - receive_buffer.size();
+        if (count_free < 0) { count_free = 0; }
+        receive_buffer.append(text, 0, count_free);
+        receive_dropped+= text.size() - count_free;
+
+        if ((receive_overflow == kCpOverflowCallback) &&
+          (overflow_callback != NULL)) {
+            overflow_callback(this, text.substr(count_free), overflow_data);
+        }
+    }
+
+    if (receive_peak < receive_buffer.size()) {
+        receive_peak = receive_buffer.size();
+    }
+}
+
+} // namespace wepet {
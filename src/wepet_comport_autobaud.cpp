@@ -0,0 +1,280 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_autobaud.cpp                                                  *
+* ==========================                                                  *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_autobaud.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+
+
+
+namespace wepet {
+
+// minimum number of bytes for full confidence
+static const int kAutoBaudSample = 16;
+
+//**************************[cComPortAutoBaud]*********************************
+cComPortAutoBaud::cComPortAutoBaud() {
+
+    confidence = 0.0;
+
+    validator      = NULL;
+    validator_data = NULL;
+
+    time      = 200;
+    threshold = 0.9;
+}
+
+//**************************[~cComPortAutoBaud]********************************
+cComPortAutoBaud::~cComPortAutoBaud() {
+
+}
+
+//**************************[CandidateAdd]*************************************
+void cComPortAutoBaud::CandidateAdd(int baud_rate, eComPortByteSize byte_size,
+  eComPortParity parity, eComPortStopBits stop_bits) {
+
+    sComPortAutoBaudCandidate temp_candidate;
+
+    temp_candidate.baud_rate = baud_rate;
+    temp_candidate.byte_size = byte_size;
+    temp_candidate.parity    = parity;
+    temp_candidate.stop_bits = stop_bits;
+
+    candidates.push_back(temp_candidate);
+}
+
+//**************************[CandidateAddDefault]******************************
+void cComPortAutoBaud::CandidateAddDefault() {
+
+    static const int baud_rates[] = {
+        9600, 115200, 19200, 38400, 57600, 230400, 4800, 2400, 1200
+    };
+    static const int count = sizeof(baud_rates) / sizeof(baud_rates[0]);
+
+    for (int i = 0; i < count; i++) {
+        CandidateAdd(baud_rates[i], kCpByteSize8, kCpParityNone);
+    }
+    for (int i = 0; i < count; i++) {
+        CandidateAdd(baud_rates[i], kCpByteSize7, kCpParityEven);
+    }
+    for (int i = 0; i < count; i++) {
+        CandidateAdd(baud_rates[i], kCpByteSize8, kCpParityEven);
+    }
+}
+
+//**************************[CandidateClear]***********************************
+void cComPortAutoBaud::CandidateClear() {
+
+    candidates.clear();
+}
+
+//**************************[CandidateCountGet]********************************
+int cComPortAutoBaud::CandidateCountGet() const {
+
+    return candidates.size();
+}
+
+//**************************[ProbeSet]*****************************************
+void cComPortAutoBaud::ProbeSet(std::string text) {
+
+    probe = text;
+}
+
+//**************************[ValidatorSet]*************************************
+void cComPortAutoBaud::ValidatorSet(double (*validator)(
+  const std::string &text, void *data), void *data) {
+
+    this->validator = validator;
+    validator_data  = data;
+}
+
+//**************************[TimeSet]******************************************
+void cComPortAutoBaud::TimeSet(int milliseconds) {
+
+    if (milliseconds <     1) {milliseconds =     1;}
+    if (milliseconds > 10000) {milliseconds = 10000;}
+
+    time = milliseconds;
+}
+
+//**************************[ThresholdSet]*************************************
+void cComPortAutoBaud::ThresholdSet(double confidence) {
+
+    if (confidence < 0.0) { confidence = 0.0; }
+    if (confidence > 1.0) { confidence = 1.0; }
+
+    threshold = confidence;
+}
+
+//**************************[Detect]*******************************************
+int cComPortAutoBaud::Detect(cComPortBuffer &port) {
+
+    sComPortAutoBaudResult temp_result;
+    sComPortCounters temp_counters;
+    sComPortCounters temp_start;
+    bool counters;
+    int64_t time_start;
+    int result;
+
+    results.clear();
+    confidence = 0.0;
+    result = -1;
+
+    if (! port.IsOpened()) { return -1; }
+
+    for (int i = 0; i < candidates.size(); i++) {
+        temp_result.candidate  = candidates[i];
+        temp_result.bytes      = 0;
+        temp_result.errors     = 0;
+        temp_result.confidence = 0.0;
+
+        port.SettingBaudRateSet(candidates[i].baud_rate);
+        port.SettingByteSizeSet(candidates[i].byte_size);
+        port.SettingParitySet  (candidates[i].parity);
+        port.SettingStopBitsSet(candidates[i].stop_bits);
+
+        // discard everything received with the last settings
+        port.HWBufferFlush(true, false);
+        port.BufferClear();
+        // the errors are counted against a local snapshot, so the counters
+        // of the port (and other users of them) are not touched
+        counters = port.CounterGet(temp_start);
+
+        if (probe != "") {
+            port.Transmit(probe);
+        }
+
+        // listen until the time is up or the candidate is confident
+        time_start = cComPort::TimeGet();
+        do {
+            port.Wait(10);
+            port.BufferUpdate();
+
+            if (counters && port.CounterGet(temp_counters)) {
+                temp_result.errors =
+                  (temp_counters.frame   - temp_start.frame  ) +
+                  (temp_counters.parity  - temp_start.parity ) +
+                  (temp_counters.brk     - temp_start.brk    ) +
+                  (temp_counters.overrun - temp_start.overrun);
+            }
+            if (Score(temp_result, port.BufferGet()) >= threshold) {
+                break;
+            }
+        } while (cComPort::TimeGet() - time_start < (int64_t) time * 1000);
+
+        results.push_back(temp_result);
+        if ((temp_result.bytes > 0) &&
+          ((result < 0) || (temp_result.confidence > confidence))) {
+            result = i;
+            confidence = temp_result.confidence;
+        }
+        if (confidence >= threshold) { break; }
+    }
+
+    if (result >= 0) {
+        port.SettingBaudRateSet(candidates[result].baud_rate);
+        port.SettingByteSizeSet(candidates[result].byte_size);
+        port.SettingParitySet  (candidates[result].parity);
+        port.SettingStopBitsSet(candidates[result].stop_bits);
+    }
+
+    return result;
+}
+
+//**************************[ResultCountGet]***********************************
+int cComPortAutoBaud::ResultCountGet() const {
+
+    return results.size();
+}
+
+//**************************[ResultGet]****************************************
+sComPortAutoBaudResult cComPortAutoBaud::ResultGet(int index) const {
+
+    sComPortAutoBaudResult temp_result;
+
+    if ((index < 0) || (index >= results.size())) {
+        temp_result.candidate.baud_rate = 0;
+        temp_result.candidate.byte_size = kCpByteSize8;
+        temp_result.candidate.parity    = kCpParityNone;
+        temp_result.candidate.stop_bits = kCpStopBits1;
+        temp_result.bytes      = 0;
+        temp_result.errors     = 0;
+        temp_result.confidence = 0.0;
+        return temp_result;
+    }
+
+    return results[index];
+}
+
+//**************************[ConfidenceGet]************************************
+double cComPortAutoBaud::ConfidenceGet() const {
+
+    return confidence;
+}
+
+//**************************[Score]********************************************
+double cComPortAutoBaud::Score(sComPortAutoBaudResult &result,
+  const std::string &text) {
+
+    double temp_valid;
+    double temp_sample;
+
+    result.bytes = text.size();
+    if (result.bytes == 0) {
+        result.confidence = 0.0;
+        return 0.0;
+    }
+
+    if (validator != NULL) {
+        temp_valid = validator(text, validator_data);
+        if (temp_valid < 0.0) { temp_valid = 0.0; }
+        if (temp_valid > 1.0) { temp_valid = 1.0; }
+    } else {
+        // few bytes are not trustworthy without validator
+        temp_sample = (double) result.bytes / kAutoBaudSample;
+        if (temp_sample > 1.0) { temp_sample = 1.0; }
+        temp_valid = ScorePrintable(text) * temp_sample;
+    }
+
+    // dropped bytes with errors lower the confidence
+    result.confidence = temp_valid * result.bytes /
+      (result.bytes + result.errors);
+    return result.confidence;
+}
+
+//**************************[ScorePrintable]***********************************
+double cComPortAutoBaud::ScorePrintable(const std::string &text) {
+
+    int count;
+    unsigned char temp;
+
+    if (text.empty()) { return 0.0; }
+
+    count = 0;
+    for (int i = 0; i < text.size(); i++) {
+        temp = text[i];
+        if (((temp >= 0x20) && (temp < 0x7F)) ||
+          (temp == '\r') || (temp == '\n') || (temp == '\t')) {
+            count++;
+        }
+    }
+
+    return (double) count / text.size();
+}
+
+} // namespace wepet {
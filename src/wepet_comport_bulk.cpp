@@ -0,0 +1,160 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_bulk.cpp                                                      *
+* ======================                                                      *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_bulk.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+#include <errno.h>
+#include <pthread.h>
+
+
+
+namespace wepet {
+
+//**************************[cComPortBulk]*************************************
+cComPortBulk::cComPortBulk() {
+
+    entry_next   = 0;
+    thread_count = 16;
+    duration     = 0;
+}
+
+//**************************[~cComPortBulk]************************************
+cComPortBulk::~cComPortBulk() {
+
+}
+
+//**************************[Add]**********************************************
+void cComPortBulk::Add(cComPort *port, std::string port_name) {
+
+    if (port == NULL) { return; }
+
+    entries.push_back(sEntry());
+    entries.back().port = port;
+    entries.back().name = port_name;
+
+    entries.back().result.success    = false;
+    entries.back().result.error      = 0;
+    entries.back().result.time_start = 0;
+    entries.back().result.duration   = 0;
+}
+
+//**************************[Clear]********************************************
+void cComPortBulk::Clear() {
+
+    entries.clear();
+}
+
+//**************************[CountGet]*****************************************
+int cComPortBulk::CountGet() const {
+
+    return entries.size();
+}
+
+//**************************[ThreadCountSet]***********************************
+void cComPortBulk::ThreadCountSet(int count) {
+
+    if (count <   1) { count =   1; }
+    if (count > 256) { count = 256; }
+
+    thread_count = count;
+}
+
+//**************************[ThreadCountGet]***********************************
+int cComPortBulk::ThreadCountGet() const {
+
+    return thread_count;
+}
+
+//**************************[Open]*********************************************
+bool cComPortBulk::Open() {
+
+    int64_t time_start;
+    int count;
+    bool result;
+
+    time_start = cComPort::TimeGet();
+    entry_next = 0;
+
+    count = thread_count;
+    if (count > entries.size()) { count = entries.size(); }
+
+    // the calling thread takes part as well
+    std::vector<pthread_t> threads(count > 1 ? count - 1 : 0);
+    std::vector<bool> threads_started(threads.size(), false);
+    for (int i = 0; i < threads.size(); i++) {
+        threads_started[i] = (pthread_create(&threads[i], NULL,
+          ThreadMain, this) == 0);
+    }
+
+    ThreadMain(this);
+
+    for (int i = 0; i < threads.size(); i++) {
+        if (threads_started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    duration = cComPort::TimeGet() - time_start;
+
+    result = true;
+    for (int i = 0; i < entries.size(); i++) {
+        if (! entries[i].result.success) { result = false; }
+    }
+    return result;
+}
+
+//**************************[ResultGet]****************************************
+bool cComPortBulk::ResultGet(int index, sComPortBulkResult &result) const {
+
+    if ((index < 0) || (index >= entries.size())) { return false; }
+
+    result = entries[index].result;
+    return true;
+}
+
+//**************************[DurationGet]**************************************
+int64_t cComPortBulk::DurationGet() const {
+
+    return duration;
+}
+
+//**************************[ThreadMain]***************************************
+void *cComPortBulk::ThreadMain(void *data) {
+
+    cComPortBulk *bulk = (cComPortBulk *) data;
+    int index;
+
+    while (true) {
+        index = __atomic_fetch_add(&bulk->entry_next, 1, __ATOMIC_RELAXED);
+        if (index >= bulk->entries.size()) { break; }
+
+        sEntry &temp_entry = bulk->entries[index];
+
+        temp_entry.result.time_start = cComPort::TimeGet();
+        errno = 0;
+        temp_entry.result.success = temp_entry.port->Open(temp_entry.name);
+        temp_entry.result.error   = temp_entry.result.success ? 0 : errno;
+        temp_entry.result.duration = cComPort::TimeGet() -
+          temp_entry.result.time_start;
+    }
+
+    return NULL;
+}
+
+} // namespace wepet {
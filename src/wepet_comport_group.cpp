@@ -0,0 +1,261 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_group.cpp                                                     *
+* =======================                                                     *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_group.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+
+
+
+namespace wepet {
+
+//**************************[cComPortGroup]************************************
+cComPortGroup::cComPortGroup() {
+
+    skew     = 0;
+    duration = 0;
+}
+
+//**************************[~cComPortGroup]***********************************
+cComPortGroup::~cComPortGroup() {
+
+}
+
+//**************************[Add]**********************************************
+void cComPortGroup::Add(cComPort *port) {
+
+    if (port == NULL) { return; }
+
+    entries.push_back(sEntry());
+    entries.back().port = port;
+    entries.back().file = -1;
+
+    entries.back().result.success = false;
+    entries.back().result.error   = 0;
+    entries.back().result.count   = 0;
+    entries.back().result.time    = 0;
+}
+
+//**************************[Remove]*******************************************
+bool cComPortGroup::Remove(cComPort *port) {
+
+    for (int i = 0; i < entries.size(); i++) {
+        if (entries[i].port == port) {
+            entries.erase(entries.begin() + i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//**************************[Clear]********************************************
+void cComPortGroup::Clear() {
+
+    entries.clear();
+}
+
+//**************************[CountGet]*****************************************
+int cComPortGroup::CountGet() const {
+
+    return entries.size();
+}
+
+//**************************[Stage]********************************************
+bool cComPortGroup::Stage(const std::string &text) {
+
+    bool result;
+
+    payload = text;
+
+    result = true;
+    for (int i = 0; i < entries.size(); i++) {
+        sEntry &entry = entries[i];
+
+        if (! entry.port->IsOpened()) { result = false; }
+    }
+
+    return result;
+}
+
+//**************************[Transmit]*****************************************
+int cComPortGroup::Transmit(int milliseconds) {
+
+    int64_t time_start;
+    int64_t time_first;
+    int64_t time_last;
+    int result;
+    int count;
+
+    // the files are fetched again - they might have been reused
+    for (int i = 0; i < entries.size(); i++) {
+        entries[i].file = entries[i].port->FileGet();
+
+        entries[i].result.success = false;
+        entries[i].result.error   = 0;
+        entries[i].result.count   = 0;
+        entries[i].result.time    = 0;
+    }
+
+    // the batch itself - only the time is taken between the writes
+    time_start = time_clock.TimeGet();
+    for (int i = 0; i < entries.size(); i++) {
+        sEntry &entry = entries[i];
+        if (entry.file < 0) { continue; }
+
+        count = write(entry.file, payload.data(), payload.size());
+        entry.result.time = time_clock.TimeGet();
+        if (count < 0) {
+            if (errno != EAGAIN) { entry.result.error = errno; }
+            count = 0;
+        }
+        entry.result.count = count;
+    }
+
+    for (int i = 0; i < entries.size(); i++) {
+        sEntry &entry = entries[i];
+        if (entry.file >= 0) { continue; }
+
+        if (entry.port->Transmit(payload)) {
+            entry.result.count = payload.size();
+        }
+        entry.result.time = time_clock.TimeGet();
+    }
+    duration = time_clock.TimeGet() - time_start;
+
+    // the statistics are not updated within the batch - each write took
+    // the time since the previous one (a full buffer counts as error)
+    time_last = time_start;
+    for (int i = 0; i < entries.size(); i++) {
+        sEntry &entry = entries[i];
+        if (entry.file < 0) { continue; }
+
+        count = entry.result.count;
+        if ((entry.result.error != 0) ||
+          ((count == 0) && (payload.size() > 0))) {
+            count = -1;
+        }
+        entry.port->StatisticWrite(count,
+          (entry.result.time - time_last) / 1000);
+        time_last = entry.result.time;
+    }
+
+    Finish(milliseconds);
+
+    result     = 0;
+    time_first = 0;
+    time_last  = 0;
+    for (int i = 0; i < entries.size(); i++) {
+        sComPortGroupResult &temp_result = entries[i].result;
+
+        temp_result.success = (temp_result.count == payload.size());
+        if (temp_result.success) { result++; }
+        if (temp_result.count <= 0) { continue; }
+
+        if ((time_first == 0) || (time_first > temp_result.time)) {
+            time_first = temp_result.time;
+        }
+        if (time_last < temp_result.time) { time_last = temp_result.time; }
+    }
+    skew = time_last - time_first;
+
+    return result;
+}
+
+//**************************[ResultGet]****************************************
+bool cComPortGroup::ResultGet(int index, sComPortGroupResult &result) const {
+
+    if ((index < 0) || (index >= entries.size())) { return false; }
+
+    result = entries[index].result;
+    return true;
+}
+
+//**************************[SkewGet]******************************************
+int64_t cComPortGroup::SkewGet() const {
+
+    return skew;
+}
+
+//**************************[DurationGet]**************************************
+int64_t cComPortGroup::DurationGet() const {
+
+    return duration;
+}
+
+//**************************[Finish]*******************************************
+void cComPortGroup::Finish(int milliseconds) {
+
+    std::vector<pollfd> temp_polls;
+    std::vector<int> temp_indices;
+    int64_t time_start;
+    int64_t time_end;
+    int64_t time_wait;
+    int count;
+
+    // partial writes are finished as soon as the driver accepts more data
+    time_end = time_clock.TimeGet() + (int64_t) milliseconds * 1000000;
+    while (true) {
+        temp_polls.clear();
+        temp_indices.clear();
+        for (int i = 0; i < entries.size(); i++) {
+            sEntry &entry = entries[i];
+            if ((entry.file < 0) || (entry.result.error != 0)) { continue; }
+            if (entry.result.count >= payload.size()) { continue; }
+
+            pollfd temp_poll;
+            temp_poll.fd      = entry.file;
+            temp_poll.events  = POLLOUT;
+            temp_poll.revents = 0;
+            temp_polls.push_back(temp_poll);
+            temp_indices.push_back(i);
+        }
+        if (temp_polls.size() == 0) { return; }
+
+        time_wait = time_end - time_clock.TimeGet();
+        if (time_wait < 0) { return; }
+        if (poll(&temp_polls[0], temp_polls.size(),
+          (time_wait + 999999) / 1000000) <= 0) {
+            if (time_clock.TimeGet() >= time_end) { return; }
+            continue;
+        }
+
+        for (int i = 0; i < temp_polls.size(); i++) {
+            if (temp_polls[i].revents == 0) { continue; }
+            sComPortGroupResult &temp_result =
+              entries[temp_indices[i]].result;
+
+            time_start = time_clock.TimeGet();
+            count = write(temp_polls[i].fd,
+              payload.data() + temp_result.count,
+              payload.size() - temp_result.count);
+            entries[temp_indices[i]].port->StatisticWrite(count,
+              (time_clock.TimeGet() - time_start) / 1000);
+            if (count > 0) {
+                temp_result.count+= count;
+            } else if ((count < 0) && (errno != EAGAIN)) {
+                temp_result.error = errno;
+            }
+        }
+    }
+}
+
+} // namespace wepet {
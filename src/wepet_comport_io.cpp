@@ -0,0 +1,963 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_io.cpp                                                        *
+* ====================                                                        *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_io.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+
+namespace wepet {
+
+// operations are encoded in the lower bits of user_data
+static const int kIoOpPoll    = 1;
+static const int kIoOpRead    = 2;
+static const int kIoOpPollOut = 3;
+static const int kIoOpWrite   = 4;
+static const int kIoOpCancel  = 5;
+static const int kIoOpBits    = 3;
+
+static const int kIoRingEntries = 1024;
+
+// stack of the real-time thread which is prefaulted
+static const int kIoStackPrefault = 64 * 1024;
+
+//**************************[cComPortIo]***************************************
+cComPortIo::cComPortIo() {
+
+    backend    = kCpIoNone;
+    slot_count = 0;
+
+    callback      = NULL;
+    callback_data = NULL;
+
+    StatisticReset();
+    received = 0;
+    transmit_reserve = 0;
+
+    pthread_mutex_init(&mutex, NULL);
+    thread_running  = false;
+    thread_ready    = false;
+    thread_realtime = 0;
+
+    realtime.enabled     = false;
+    realtime.cpu         = -1;
+    realtime.priority    = 0;
+    realtime.lock_memory = false;
+
+    ring_file       = -1;
+    ring_sq         = MAP_FAILED;
+    ring_cq         = MAP_FAILED;
+    ring_sqes       = MAP_FAILED;
+    ring_sq_size    = 0;
+    ring_cq_size    = 0;
+    ring_sqes_size  = 0;
+    ring_sq_head    = NULL;
+    ring_sq_tail    = NULL;
+    ring_sq_mask    = NULL;
+    ring_sq_array   = NULL;
+    ring_sq_entries = 0;
+    ring_cq_head    = NULL;
+    ring_cq_tail    = NULL;
+    ring_cq_mask    = NULL;
+    ring_cqes       = NULL;
+    ring_submit     = 0;
+
+    buffer_ring      = MAP_FAILED;
+    buffer_ring_size = 0;
+    buffer_count     = 0;
+    buffer_size      = 0;
+
+    epoll_file = -1;
+}
+
+//**************************[~cComPortIo]**************************************
+cComPortIo::~cComPortIo() {
+
+    Close();
+    pthread_mutex_destroy(&mutex);
+}
+
+//**************************[Open]*********************************************
+bool cComPortIo::Open(eComPortIoBackend backend, int buffer_count,
+  int buffer_size) {
+
+    int temp_count;
+
+    Close();
+
+    if (buffer_size < 64) { buffer_size = 64; }
+    temp_count = 1;
+    while ((temp_count < buffer_count) && (temp_count < 32768)) {
+        temp_count<<= 1;
+    }
+
+    if ((backend == kCpIoAuto) || (backend == kCpIoUring)) {
+        if (UringOpen(temp_count, buffer_size)) {
+            this->backend = kCpIoUring;
+            return true;
+        }
+        UringClose();
+        if (backend == kCpIoUring) { return false; }
+    }
+
+    if ((backend == kCpIoAuto) || (backend == kCpIoEpoll)) {
+        if (EpollOpen(buffer_size)) {
+            this->backend = kCpIoEpoll;
+            return true;
+        }
+        EpollClose();
+    }
+
+    return false;
+}
+
+//**************************[Close]********************************************
+void cComPortIo::Close() {
+
+    ThreadStop();
+
+    // closing the ring cancels all pending operations
+    UringClose();
+    EpollClose();
+
+    backend = kCpIoNone;
+    for (int i = 0; i < slots.size(); i++) {
+        delete slots[i];
+    }
+    slots.clear();
+    slot_count = 0;
+}
+
+//**************************[BackendGet]***************************************
+eComPortIoBackend cComPortIo::BackendGet() const {
+
+    return backend;
+}
+
+//**************************[Add]**********************************************
+bool cComPortIo::Add(cComPort *port) {
+
+    epoll_event temp_event;
+    int index;
+    int file;
+
+    if ((backend == kCpIoNone) || (port == NULL)) { return false; }
+    if (SlotFind(port) >= 0) { return false; }
+
+    file = port->FileGet();
+    if (file < 0) { return false; }
+
+    // reuse slots without pending operations
+    for (index = 0; index < slots.size(); index++) {
+        if ((slots[index]->port == NULL) && (slots[index]->pending == 0)) {
+            break;
+        }
+    }
+    if (index == slots.size()) { slots.push_back(new sSlot()); }
+
+    if (backend == kCpIoEpoll) {
+        memset(&temp_event, 0, sizeof(temp_event));
+        temp_event.events   = EPOLLIN;
+        temp_event.data.u32 = index;
+        if (epoll_ctl(epoll_file, EPOLL_CTL_ADD, file, &temp_event) != 0) {
+            return false;
+        }
+        statistic.syscalls++;
+    }
+
+    pthread_mutex_lock(&mutex);
+    slots[index]->port      = port;
+    slots[index]->file      = file;
+    slots[index]->active    = true;
+    slots[index]->receiving = false;
+    slots[index]->writing   = false;
+    slots[index]->pending   = 0;
+    slots[index]->tx_time   = 0;
+    slots[index]->tx_queue.clear();
+    slots[index]->tx_flight.clear();
+    slots[index]->tx_queue.reserve(transmit_reserve);
+    slots[index]->tx_flight.reserve(transmit_reserve);
+    pthread_mutex_unlock(&mutex);
+
+    slot_count++;
+    return true;
+}
+
+//**************************[Remove]*******************************************
+bool cComPortIo::Remove(cComPort *port) {
+
+    int index;
+
+    index = SlotFind(port);
+    if (index < 0) { return false; }
+
+    if (backend == kCpIoEpoll) {
+        if (slots[index]->active) {
+            epoll_ctl(epoll_file, EPOLL_CTL_DEL, slots[index]->file, NULL);
+            statistic.syscalls++;
+        }
+    } else if (slots[index]->pending > 0) {
+        // the slot is reused after all operations were completed
+        UringCancel(index);
+        UringSubmit();
+    }
+
+    pthread_mutex_lock(&mutex);
+    slots[index]->port   = NULL;
+    slots[index]->active = false;
+    slots[index]->tx_queue.clear();
+    pthread_mutex_unlock(&mutex);
+
+    slot_count--;
+    return true;
+}
+
+//**************************[CountGet]*****************************************
+int cComPortIo::CountGet() const {
+
+    return slot_count;
+}
+
+//**************************[CallbackSet]**************************************
+void cComPortIo::CallbackSet(void (*callback)(cComPort *port,
+  const char *text, int size, void *data), void *data) {
+
+    this->callback = callback;
+    callback_data  = data;
+}
+
+//**************************[Transmit]*****************************************
+bool cComPortIo::Transmit(cComPort *port, const std::string &text) {
+
+    int index;
+
+    index = SlotFind(port);
+    if ((index < 0) || (! slots[index]->active)) { return false; }
+
+    pthread_mutex_lock(&mutex);
+    slots[index]->tx_queue+= text;
+    pthread_mutex_unlock(&mutex);
+
+    return true;
+}
+
+//**************************[TransmitPendingGet]*******************************
+int cComPortIo::TransmitPendingGet(cComPort *port) {
+
+    int index;
+    int result;
+
+    index = SlotFind(port);
+    if (index < 0) { return -1; }
+
+    pthread_mutex_lock(&mutex);
+    result = slots[index]->tx_queue.size() + slots[index]->tx_flight.size();
+    pthread_mutex_unlock(&mutex);
+
+    return result;
+}
+
+//**************************[TransmitReserve]**********************************
+void cComPortIo::TransmitReserve(int bytes) {
+
+    if (bytes < 0) { bytes = 0; }
+
+    pthread_mutex_lock(&mutex);
+    transmit_reserve = bytes;
+    for (int i = 0; i < slots.size(); i++) {
+        slots[i]->tx_queue.reserve(bytes);
+        // the kernel might still read the data of a running write
+        if (! slots[i]->writing) {
+            slots[i]->tx_flight.reserve(bytes);
+        }
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+//**************************[Update]*******************************************
+int cComPortIo::Update(int milliseconds) {
+
+    bool result;
+
+    if (backend == kCpIoNone) { return -1; }
+
+    received = 0;
+    pthread_mutex_lock(&mutex);
+    for (int i = 0; i < slots.size(); i++) {
+        SlotUpdate(i);
+    }
+    pthread_mutex_unlock(&mutex);
+
+    if (backend == kCpIoUring) {
+        result = UringEnter(milliseconds);
+    } else {
+        result = EpollWait(milliseconds);
+    }
+
+    if (! result) { return -1; }
+    return received;
+}
+
+//**************************[ThreadStart]**************************************
+bool cComPortIo::ThreadStart() {
+
+    if ((backend == kCpIoNone) || thread_running) { return false; }
+
+    thread_running = true;
+    __atomic_store_n(&thread_ready, false, __ATOMIC_RELEASE);
+    if (pthread_create(&thread, NULL, ThreadMain, this) != 0) {
+        thread_running = false;
+        return false;
+    }
+
+    // wait for the real-time setup
+    while (! __atomic_load_n(&thread_ready, __ATOMIC_ACQUIRE)) {
+        usleep(100);
+    }
+
+    return true;
+}
+
+//**************************[ThreadStop]***************************************
+void cComPortIo::ThreadStop() {
+
+    if (! thread_running) { return; }
+
+    __atomic_store_n(&thread_running, false, __ATOMIC_RELEASE);
+    pthread_join(thread, NULL);
+}
+
+//**************************[ThreadIsRunning]**********************************
+bool cComPortIo::ThreadIsRunning() const {
+
+    return thread_running;
+}
+
+//**************************[RealtimeSet]**************************************
+void cComPortIo::RealtimeSet(sComPortIoRealtime realtime) {
+
+    this->realtime = realtime;
+}
+
+//**************************[RealtimeGet]**************************************
+sComPortIoRealtime cComPortIo::RealtimeGet() const {
+
+    return realtime;
+}
+
+//**************************[ThreadRealtimeGet]********************************
+int cComPortIo::ThreadRealtimeGet() const {
+
+    return thread_realtime;
+}
+
+//**************************[StatisticGet]*************************************
+sComPortIoStatistic cComPortIo::StatisticGet() const {
+
+    return statistic;
+}
+
+//**************************[StatisticReset]***********************************
+void cComPortIo::StatisticReset() {
+
+    memset(&statistic, 0, sizeof(statistic));
+}
+
+//**************************[ThreadMain]***************************************
+void *cComPortIo::ThreadMain(void *data) {
+
+    cComPortIo *io;
+
+    io = (cComPortIo *) data;
+    io->ThreadRealtimeApply();
+    __atomic_store_n(&io->thread_ready, true, __ATOMIC_RELEASE);
+
+    // the timeout limits the delay of ThreadStop
+    while (__atomic_load_n(&io->thread_running, __ATOMIC_ACQUIRE)) {
+        io->Update(10);
+    }
+
+    return NULL;
+}
+
+//**************************[ThreadRealtimeApply]******************************
+void cComPortIo::ThreadRealtimeApply() {
+
+    cpu_set_t temp_cpus;
+    sched_param temp_param;
+    char temp_stack[kIoStackPrefault];
+    int temp_priority;
+
+    thread_realtime = 0;
+    if (! realtime.enabled) { return; }
+
+    if (realtime.cpu >= 0) {
+        CPU_ZERO(&temp_cpus);
+        CPU_SET(realtime.cpu, &temp_cpus);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(temp_cpus),
+          &temp_cpus) == 0) {
+            thread_realtime|= kCpIoRealtimeAffinity;
+        }
+    }
+
+    // without permission (CAP_SYS_NICE or rtprio limit) the thread keeps
+    // its normal scheduling
+    if (realtime.priority > 0) {
+        temp_priority = sched_get_priority_max(SCHED_FIFO);
+        if (temp_priority > realtime.priority) {
+            temp_priority = realtime.priority;
+        }
+        memset(&temp_param, 0, sizeof(temp_param));
+        temp_param.sched_priority = temp_priority;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO,
+          &temp_param) == 0) {
+            thread_realtime|= kCpIoRealtimeFifo;
+        }
+    }
+
+    // locks all pages of the process (including the buffers, which were
+    // written during Open) - the stack of this thread is touched once
+    if (realtime.lock_memory) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            thread_realtime|= kCpIoRealtimeLocked;
+        }
+        memset(temp_stack, 0, sizeof(temp_stack));
+        __asm__ __volatile__ ("" : : "r" (temp_stack) : "memory");
+    }
+}
+
+//**************************[SlotFind]*****************************************
+int cComPortIo::SlotFind(cComPort *port) const {
+
+    if (port == NULL) { return -1; }
+
+    for (int i = 0; i < slots.size(); i++) {
+        if (slots[i]->port == port) { return i; }
+    }
+
+    return -1;
+}
+
+//**************************[SlotUpdate]***************************************
+void cComPortIo::SlotUpdate(int index) {
+
+    sSlot &slot = *slots[index];
+    epoll_event temp_event;
+    int count;
+
+    if (! slot.active) { return; }
+
+    if (backend == kCpIoUring) {
+        if (! slot.receiving) { UringRead(index); }
+        // a rest is left in flight if the ring had no space for it
+        if ((! slot.writing) && slot.tx_flight.empty()) {
+            slot.tx_flight.swap(slot.tx_queue);
+        }
+        if ((! slot.writing) && (! slot.tx_flight.empty())) {
+            UringWrite(index, false);
+        }
+        return;
+    }
+
+    // epoll - write directly and wait for EPOLLOUT only if necessary
+    if (slot.writing || slot.tx_queue.empty()) { return; }
+
+    slot.tx_flight.swap(slot.tx_queue);
+    slot.tx_time = cComPort::TimeGet();
+    count = write(slot.file, slot.tx_flight.data(), slot.tx_flight.size());
+    slot.port->StatisticWrite(count, cComPort::TimeGet() - slot.tx_time);
+    statistic.syscalls++;
+    if (count > 0) {
+        statistic.tx_bytes+= count;
+        statistic.tx_chunks++;
+        slot.tx_flight.erase(0, count);
+    }
+    if (slot.tx_flight.empty()) { return; }
+
+    memset(&temp_event, 0, sizeof(temp_event));
+    temp_event.events   = EPOLLIN | EPOLLOUT;
+    temp_event.data.u32 = index;
+    epoll_ctl(epoll_file, EPOLL_CTL_MOD, slot.file, &temp_event);
+    statistic.syscalls++;
+    slot.writing = true;
+}
+
+//**************************[Dispatch]*****************************************
+void cComPortIo::Dispatch(sSlot &slot, const char *text, int size) {
+
+    received+= size;
+    statistic.rx_bytes+= size;
+    statistic.rx_chunks++;
+    slot.port->StatisticRead(size);
+
+    if (callback != NULL) {
+        callback(slot.port, text, size, callback_data);
+    }
+}
+
+//**************************[UringOpen]****************************************
+bool cComPortIo::UringOpen(int buffer_count, int buffer_size) {
+
+    io_uring_params temp_params;
+    io_uring_buf_reg temp_reg;
+    char *temp_sq;
+    char *temp_cq;
+
+    memset(&temp_params, 0, sizeof(temp_params));
+    ring_file = syscall(SYS_io_uring_setup, kIoRingEntries, &temp_params);
+    if (ring_file < 0) { return false; }
+    if (! (temp_params.features & IORING_FEAT_SINGLE_MMAP) ||
+      ! (temp_params.features & IORING_FEAT_NODROP) ||
+      ! (temp_params.features & IORING_FEAT_EXT_ARG)) {
+        return false;
+    }
+
+    // submission and completion ring share one mapping
+    ring_sq_size = temp_params.sq_off.array +
+      temp_params.sq_entries * sizeof(uint32_t);
+    ring_cq_size = temp_params.cq_off.cqes +
+      temp_params.cq_entries * sizeof(io_uring_cqe);
+    if (ring_cq_size > ring_sq_size) { ring_sq_size = ring_cq_size; }
+    ring_sq = mmap(NULL, ring_sq_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, ring_file, IORING_OFF_SQ_RING);
+    if (ring_sq == MAP_FAILED) { return false; }
+    ring_cq = ring_sq;
+    ring_cq_size = 0;
+
+    ring_sqes_size = temp_params.sq_entries * sizeof(io_uring_sqe);
+    ring_sqes = mmap(NULL, ring_sqes_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, ring_file, IORING_OFF_SQES);
+    if (ring_sqes == MAP_FAILED) { return false; }
+
+    temp_sq = (char *) ring_sq;
+    temp_cq = (char *) ring_cq;
+    ring_sq_head    = (uint32_t *) (temp_sq + temp_params.sq_off.head);
+    ring_sq_tail    = (uint32_t *) (temp_sq + temp_params.sq_off.tail);
+    ring_sq_mask    = (uint32_t *) (temp_sq + temp_params.sq_off.ring_mask);
+    ring_sq_array   = (uint32_t *) (temp_sq + temp_params.sq_off.array);
+    ring_sq_entries = temp_params.sq_entries;
+    ring_cq_head    = (uint32_t *) (temp_cq + temp_params.cq_off.head);
+    ring_cq_tail    = (uint32_t *) (temp_cq + temp_params.cq_off.tail);
+    ring_cq_mask    = (uint32_t *) (temp_cq + temp_params.cq_off.ring_mask);
+    ring_cqes       = temp_cq + temp_params.cq_off.cqes;
+
+    // provided buffers - the ring needs to be page aligned
+    buffer_ring_size = buffer_count * sizeof(io_uring_buf);
+    buffer_ring = mmap(NULL, buffer_ring_size, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer_ring == MAP_FAILED) { return false; }
+
+    memset(&temp_reg, 0, sizeof(temp_reg));
+    temp_reg.ring_addr    = (uint64_t) buffer_ring;
+    temp_reg.ring_entries = buffer_count;
+    temp_reg.bgid         = 0;
+    if (syscall(SYS_io_uring_register, ring_file, IORING_REGISTER_PBUF_RING,
+      &temp_reg, 1) != 0) {
+        return false;
+    }
+
+    this->buffer_count = buffer_count;
+    this->buffer_size  = buffer_size;
+    buffers.resize((size_t) buffer_count * buffer_size);
+    for (int i = 0; i < buffer_count; i++) {
+        UringBufferRecycle(i);
+    }
+
+    return true;
+}
+
+//**************************[UringClose]***************************************
+void cComPortIo::UringClose() {
+
+    if (ring_file >= 0) {
+        close(ring_file);
+        ring_file = -1;
+    }
+
+    if (ring_sq != MAP_FAILED) { munmap(ring_sq, ring_sq_size); }
+    if (ring_sqes != MAP_FAILED) { munmap(ring_sqes, ring_sqes_size); }
+    if (buffer_ring != MAP_FAILED) { munmap(buffer_ring, buffer_ring_size); }
+    ring_sq     = MAP_FAILED;
+    ring_cq     = MAP_FAILED;
+    ring_sqes   = MAP_FAILED;
+    buffer_ring = MAP_FAILED;
+    ring_submit = 0;
+
+    buffers.clear();
+    buffer_count = 0;
+}
+
+//**************************[UringSubmit]**************************************
+void cComPortIo::UringSubmit() {
+
+    int result;
+
+    // the kernel might take only some entries (or none) - the rest is
+    // submitted by the next call
+    result = syscall(SYS_io_uring_enter, ring_file, ring_submit, 0, 0, NULL,
+      0);
+    statistic.syscalls++;
+    if (result > 0) { ring_submit-= result; }
+}
+
+//**************************[UringSqeReserve]**********************************
+bool cComPortIo::UringSqeReserve(int count) {
+
+    uint32_t head;
+
+    // linked entries must not be split by a submit - so the space for all
+    // of them is made before the first one
+    head = __atomic_load_n(ring_sq_head, __ATOMIC_ACQUIRE);
+    if (*ring_sq_tail - head + count <= ring_sq_entries) { return true; }
+
+    UringSubmit();
+
+    head = __atomic_load_n(ring_sq_head, __ATOMIC_ACQUIRE);
+    return (*ring_sq_tail - head + count <= ring_sq_entries);
+}
+
+//**************************[UringSqe]*****************************************
+// the space has to be reserved by UringSqeReserve before
+void *cComPortIo::UringSqe() {
+
+    io_uring_sqe *result;
+    uint32_t tail;
+    uint32_t index;
+
+    tail = *ring_sq_tail;
+
+    // without sqpoll the kernel only reads entries during io_uring_enter
+    index = tail & *ring_sq_mask;
+    result = (io_uring_sqe *) ring_sqes + index;
+    memset(result, 0, sizeof(io_uring_sqe));
+    ring_sq_array[index] = index;
+    __atomic_store_n(ring_sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring_submit++;
+
+    return result;
+}
+
+//**************************[UringEnter]***************************************
+bool cComPortIo::UringEnter(int milliseconds) {
+
+    io_uring_getevents_arg temp_arg;
+    __kernel_timespec temp_time;
+    io_uring_cqe temp_cqe;
+    uint32_t head;
+    uint32_t tail;
+    int result;
+
+    memset(&temp_arg, 0, sizeof(temp_arg));
+    if (milliseconds >= 0) {
+        temp_time.tv_sec  = milliseconds / 1000;
+        temp_time.tv_nsec = (milliseconds % 1000) * 1000000;
+        temp_arg.ts = (uint64_t) &temp_time;
+    }
+
+    // submit and wait with a single syscall
+    result = syscall(SYS_io_uring_enter, ring_file, ring_submit,
+      milliseconds != 0 ? 1 : 0, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+      &temp_arg, sizeof(temp_arg));
+    statistic.syscalls++;
+    if (result >= 0) {
+        ring_submit-= result;
+    } else if ((errno != ETIME) && (errno != EINTR) && (errno != EBUSY)) {
+        return false;
+    }
+
+    head = *ring_cq_head;
+    tail = __atomic_load_n(ring_cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        temp_cqe = ((io_uring_cqe *) ring_cqes)[head & *ring_cq_mask];
+        head++;
+        __atomic_store_n(ring_cq_head, head, __ATOMIC_RELEASE);
+
+        UringComplete(temp_cqe.user_data, temp_cqe.res, temp_cqe.flags);
+    }
+
+    return true;
+}
+
+//**************************[UringRead]****************************************
+void cComPortIo::UringRead(int index) {
+
+    io_uring_sqe *sqe;
+
+    // retried by the next SlotUpdate if the ring is full
+    if (! UringSqeReserve(2)) { return; }
+
+    // the ports are non-blocking - so the read waits for a poll
+    sqe = (io_uring_sqe *) UringSqe();
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->flags         = IOSQE_IO_LINK;
+    sqe->fd            = slots[index]->file;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data     = (index << kIoOpBits) | kIoOpPoll;
+
+    sqe = (io_uring_sqe *) UringSqe();
+    sqe->opcode    = IORING_OP_READ;
+    sqe->flags     = IOSQE_BUFFER_SELECT;
+    sqe->fd        = slots[index]->file;
+    sqe->off       = (uint64_t) -1;
+    sqe->len       = buffer_size;
+    sqe->buf_group = 0;
+    sqe->user_data = (index << kIoOpBits) | kIoOpRead;
+
+    slots[index]->pending+= 2;
+    slots[index]->receiving = true;
+}
+
+//**************************[UringWrite]***************************************
+void cComPortIo::UringWrite(int index, bool poll) {
+
+    io_uring_sqe *sqe;
+
+    // retried by the next SlotUpdate if the ring is full
+    if (! UringSqeReserve(poll ? 2 : 1)) { return; }
+
+    if (poll) {
+        sqe = (io_uring_sqe *) UringSqe();
+        sqe->opcode        = IORING_OP_POLL_ADD;
+        sqe->flags         = IOSQE_IO_LINK;
+        sqe->fd            = slots[index]->file;
+        sqe->poll32_events = POLLOUT;
+        sqe->user_data     = (index << kIoOpBits) | kIoOpPollOut;
+        slots[index]->pending++;
+    }
+
+    sqe = (io_uring_sqe *) UringSqe();
+    sqe->opcode    = IORING_OP_WRITE;
+    sqe->fd        = slots[index]->file;
+    sqe->off       = (uint64_t) -1;
+    sqe->addr      = (uint64_t) slots[index]->tx_flight.data();
+    sqe->len       = slots[index]->tx_flight.size();
+    sqe->user_data = (index << kIoOpBits) | kIoOpWrite;
+
+    slots[index]->pending++;
+    slots[index]->writing = true;
+    slots[index]->tx_time = cComPort::TimeGet();
+}
+
+//**************************[UringCancel]**************************************
+void cComPortIo::UringCancel(int index) {
+
+    io_uring_sqe *sqe;
+
+    // without space the operations complete by themselves
+    if (! UringSqeReserve(1)) { return; }
+
+    sqe = (io_uring_sqe *) UringSqe();
+    sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+    sqe->fd           = slots[index]->file;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data    = (index << kIoOpBits) | kIoOpCancel;
+
+    slots[index]->pending++;
+}
+
+//**************************[UringComplete]************************************
+void cComPortIo::UringComplete(uint64_t user_data, int result,
+  uint32_t flags) {
+
+    int index;
+    int id;
+
+    index = user_data >> kIoOpBits;
+    if (index >= slots.size()) { return; }
+    sSlot &slot = *slots[index];
+    slot.pending--;
+
+    switch (user_data & ((1 << kIoOpBits) - 1)) {
+        case (kIoOpRead)  :
+            slot.receiving = false;
+            if (flags & IORING_CQE_F_BUFFER) {
+                id = flags >> IORING_CQE_BUFFER_SHIFT;
+                if ((result > 0) && (slot.port != NULL)) {
+                    Dispatch(slot, &buffers[(size_t) id * buffer_size],
+                      result);
+                }
+                UringBufferRecycle(id);
+            }
+
+            // stop reading after a hangup or an error
+            if ((result == 0) || ((result < 0) && (result != -EAGAIN) &&
+              (result != -EINTR) && (result != -ENOBUFS) &&
+              (result != -ECANCELED))) {
+                if ((result < 0) && (slot.port != NULL)) {
+                    slot.port->StatisticRead(-1);
+                }
+                slot.active = false;
+            }
+            break;
+
+        case (kIoOpWrite) :
+            // the transmit functions use the slot from other threads
+            pthread_mutex_lock(&mutex);
+            slot.writing = false;
+            if ((slot.port != NULL) && (result != -ECANCELED)) {
+                slot.port->StatisticWrite(result,
+                  cComPort::TimeGet() - slot.tx_time);
+            }
+            if (slot.port == NULL) {
+                slot.tx_flight.clear();
+            } else if ((result <= 0) && (result != -EAGAIN) &&
+              (result != -EINTR) && (result != -ECANCELED)) {
+                slot.tx_flight.clear();
+                slot.active = false;
+            } else {
+                if (result > 0) {
+                    statistic.tx_bytes+= result;
+                    statistic.tx_chunks++;
+                    slot.tx_flight.erase(0, result);
+                }
+                // the rest of the data is written as soon as possible
+                if (! slot.tx_flight.empty()) {
+                    UringWrite(index, result <= 0);
+                }
+            }
+            pthread_mutex_unlock(&mutex);
+            break;
+
+        default           :
+            break;
+    }
+}
+
+//**************************[UringBufferRecycle]*******************************
+void cComPortIo::UringBufferRecycle(int id) {
+
+    io_uring_buf_ring *ring;
+    io_uring_buf *buffer;
+    uint16_t tail;
+
+    ring = (io_uring_buf_ring *) buffer_ring;
+    tail = ring->tail;
+
+    // bufs is a flexible array member, which is not handled the same way
+    // by all c++ compilers - so the entry is addressed directly
+    buffer = (io_uring_buf *) buffer_ring + (tail & (buffer_count - 1));
+    buffer->addr = (uint64_t) &buffers[(size_t) id * buffer_size];
+    buffer->len  = buffer_size;
+    buffer->bid  = id;
+
+    __atomic_store_n(&ring->tail, (uint16_t) (tail + 1), __ATOMIC_RELEASE);
+}
+
+//**************************[EpollOpen]****************************************
+bool cComPortIo::EpollOpen(int buffer_size) {
+
+    epoll_file = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_file < 0) { return false; }
+
+    this->buffer_size = buffer_size;
+    buffers.resize(buffer_size);
+
+    return true;
+}
+
+//**************************[EpollClose]***************************************
+void cComPortIo::EpollClose() {
+
+    if (epoll_file >= 0) {
+        close(epoll_file);
+        epoll_file = -1;
+    }
+
+    buffers.clear();
+}
+
+//**************************[EpollWait]****************************************
+bool cComPortIo::EpollWait(int milliseconds) {
+
+    epoll_event temp_events[64];
+    epoll_event temp_event;
+    int count;
+    int index;
+    int result;
+
+    count = epoll_wait(epoll_file, temp_events, 64, milliseconds);
+    statistic.syscalls++;
+    if (count < 0) { return (errno == EINTR); }
+
+    for (int i = 0; i < count; i++) {
+        index = temp_events[i].data.u32;
+        if (index >= slots.size()) { continue; }
+        sSlot &slot = *slots[index];
+        if (! slot.active) { continue; }
+
+        if (temp_events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            // read until the port is empty
+            do {
+                result = read(slot.file, &buffers[0], buffer_size);
+                statistic.syscalls++;
+                if (result > 0) { Dispatch(slot, &buffers[0], result); }
+            } while (result == buffer_size);
+
+            if ((result == 0) ||
+              ((result < 0) && (errno != EAGAIN) && (errno != EINTR))) {
+                if (result < 0) { slot.port->StatisticRead(-1); }
+                epoll_ctl(epoll_file, EPOLL_CTL_DEL, slot.file, NULL);
+                statistic.syscalls++;
+                pthread_mutex_lock(&mutex);
+                slot.active  = false;
+                slot.writing = false;
+                pthread_mutex_unlock(&mutex);
+                continue;
+            }
+        }
+
+        // the transmit functions use the slot from other threads
+        pthread_mutex_lock(&mutex);
+        if ((temp_events[i].events & EPOLLOUT) && slot.writing) {
+            slot.tx_time = cComPort::TimeGet();
+            result = write(slot.file, slot.tx_flight.data(),
+              slot.tx_flight.size());
+            slot.port->StatisticWrite(result,
+              cComPort::TimeGet() - slot.tx_time);
+            statistic.syscalls++;
+            if (result > 0) {
+                statistic.tx_bytes+= result;
+                statistic.tx_chunks++;
+                slot.tx_flight.erase(0, result);
+            }
+            if (slot.tx_flight.empty()) {
+                memset(&temp_event, 0, sizeof(temp_event));
+                temp_event.events   = EPOLLIN;
+                temp_event.data.u32 = index;
+                epoll_ctl(epoll_file, EPOLL_CTL_MOD, slot.file, &temp_event);
+                statistic.syscalls++;
+                slot.writing = false;
+            }
+        }
+        pthread_mutex_unlock(&mutex);
+    }
+
+    return true;
+}
+
+} // namespace wepet {
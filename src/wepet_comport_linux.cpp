@@ -1,697 +1,1815 @@
-/******************************************************************************
-*                                                                             *
-* wepet_comport_linux.cpp                                                     *
-* =======================                                                     *
-*                                                                             *
-* Version: 1.1.3                                                              *
-* Date   : 11.10.15                                                           *
-* Author : Peter Weissig                                                      *
-*                                                                             *
-* For help or bug report please visit:                                        *
-*   https://github.com/peterweissig/cpp_comport/                              *
-******************************************************************************/
-
-// local headers
-#include "wepet_comport.h"
-
-// wepet headers
-
-// standard headers
-#include <fstream>
-
-// additional headers
-#include <sys/time.h>
-
-#include <fcntl.h>
-#include <termio.h>
-#include <linux/serial.h>
-#include <sys/ioctl.h>
-#include <unistd.h>
-
-
-
-namespace wepet {
-
-//**************************[cComPort]*****************************************
-cComPort::cComPort() {
-
-    port_file = -1;
-
-    port_baudrate = 57600;
-
-    port_settings.c_iflag = 0;
-    port_settings.c_iflag|= IGNBRK ; // ignore BREAK condition
-    port_settings.c_iflag|= IGNPAR ; // ignore (discard) parity errors
-    /*
-    port_settings.c_iflag|= BRKINT ; // map BREAK to SIGINTR
-    port_settings.c_iflag|= PARMRK ; // mark parity and framing errors
-    port_settings.c_iflag|= INPCK  ; // enable checking of parity errors
-    port_settings.c_iflag|= ISTRIP ; // strip 8th bit off chars
-    port_settings.c_iflag|= IGNCR  ; // ignore CR
-    port_settings.c_iflag|= INLCR  ; // map NL into CR
-    port_settings.c_iflag|= ICRNL  ; // map CR to NL (ala CRMOD)
-    port_settings.c_iflag|= IXON   ; // enable output flow control
-    port_settings.c_iflag|= IXOFF  ; // enable input flow control
-    port_settings.c_iflag|= IXANY  ; // any char will restart after stop
-    port_settings.c_iflag|= IMAXBEL; // ring bell on input queue full
-    */
-
-    port_settings.c_oflag = 0;
-    /*
-    port_settings.c_oflag|= OPOST ; // enable following output processing
-    port_settings.c_oflag|= ONLCR ; // map NL to CR-NL (ala CRMOD)
-    port_settings.c_oflag|= OCRNL ; // map CR to NL
-    port_settings.c_oflag|= TABDLY; // tab delay mask
-    port_settings.c_oflag|= TAB0  ; // no tab delay and expansion
-    port_settings.c_oflag|= TAB3  ; // expand tabs to spaces
-    port_settings.c_oflag|= ONOEOT; // discard EOT's '^D' on output)
-    port_settings.c_oflag|= ONOCR ; // do not transmit CRs on column 0
-    port_settings.c_oflag|= ONLRET; // on the terminal NL performs the CR function
-    */
-
-    port_settings.c_cflag = 0;
-    port_settings.c_cflag|= CS8       ; // 8 bits
-    port_settings.c_cflag|= CSTOPB    ; // send 2 stop bits
-    port_settings.c_cflag|= CREAD     ; // enable receiver
-    port_settings.c_cflag|= CLOCAL    ; // ignore modem status lines
-    port_settings.c_cflag|= B38400    ;
-    /*
-    port_settings.c_cflag|= CSIZE     ; // character size mask
-    port_settings.c_cflag|= CS5       ; // 5 bits (pseudo)
-    port_settings.c_cflag|= CS6       ; // 6 bits
-    port_settings.c_cflag|= CS7       ; // 7 bits
-    port_settings.c_cflag|= PARENB    ; // parity enable
-    port_settings.c_cflag|= PARODD    ; // odd parity, else even
-    port_settings.c_cflag|= PAREXT    ; // Extended parity for mark and space parity
-    port_settings.c_cflag|= HUPCL     ; // hang up on last close
-    port_settings.c_cflag|= CCTS_OFLOW; // CTS flow control of output
-    port_settings.c_cflag|= CRTSCTS   ; // same as CCTS_OFLOW
-    port_settings.c_cflag|= CRTS_IFLOW; // RTS flow control of input
-    port_settings.c_cflag|= MDMBUF    ; // flow control output via Carrier
-    */
-
-    port_settings.c_lflag = 0;
-    /*
-    port_settings.c_lflag|= ECHOKE    ; // visual erase for line kill
-    port_settings.c_lflag|= ECHOE     ; // visually erase chars
-    port_settings.c_lflag|= ECHO      ; // enable echoing
-    port_settings.c_lflag|= ECHONL    ; // echo NL even if ECHO is off
-    port_settings.c_lflag|= ECHOPRT   ; // visual erase mode for hardcopy
-    port_settings.c_lflag|= ECHOCTL   ; // echo control chars as ^(Char)
-    port_settings.c_lflag|= ISIG      ; // enable signals INTR, QUIT, [D]SUSP
-    port_settings.c_lflag|= ICANON    ; // canonicalize input lines
-    port_settings.c_lflag|= ALTWERASE ; // use alternate WERASE algorithm
-    port_settings.c_lflag|= IEXTEN    ; // enable DISCARD and LNEXT
-    port_settings.c_lflag|= EXTPROC   ; // external processing
-    port_settings.c_lflag|= TOSTOP    ; // stop background jobs from output
-    port_settings.c_lflag|= FLUSHO    ; // output being flushed (state)
-    port_settings.c_lflag|= NOKERNINFO; // no kernel output from VSTATUS
-    port_settings.c_lflag|= PENDIN    ; // XXX retype pending input (state)
-    port_settings.c_lflag|= NOFLSH    ; // don't flush after interrupt
-    */
-
-    port_settings.c_cc[VMIN    ] = 0x00;
-    port_settings.c_cc[VTIME   ] = 0x00;
-    /*
-    port_settings.c_cc[VEOF    ] = 0x00;
-    port_settings.c_cc[VEOL    ] = 0x00;
-    port_settings.c_cc[VEOL2   ] = 0x00;
-    port_settings.c_cc[VERASE  ] = 0x00;
-    port_settings.c_cc[VWERASE ] = 0x00;
-    port_settings.c_cc[VKILL   ] = 0x00;
-    port_settings.c_cc[VREPRINT] = 0x00;
-    port_settings.c_cc[VINTR   ] = 0x00;
-    port_settings.c_cc[VQUIT   ] = 0x00;
-    port_settings.c_cc[VSUSP   ] = 0x00;
-    port_settings.c_cc[VDSUSP  ] = 0x00;
-    port_settings.c_cc[VSTART  ] = 0x00;
-    port_settings.c_cc[VSTOP   ] = 0x00;
-    port_settings.c_cc[VLNEXT  ] = 0x00;
-    port_settings.c_cc[VDISCARD] = 0x00;
-    port_settings.c_cc[VSTATUS ] = 0x00;
-    */
-}
-
-//**************************[~cComPort]****************************************
-cComPort::~cComPort() {
-
-    Close();
-}
-
-//**************************[Open]*********************************************
-bool cComPort::Open(std::string port_name) {
-
-    if (IsOpened()) {
-        Close();
-    }
-
-    port_file = open(port_name.data(), O_RDWR | O_NONBLOCK | O_NOCTTY);
-    if (! IsOpened()) { return false; }
-
-    if (tcgetattr(port_file,&port_settings_old) < 0) {
-        Close();
-        return false;
-    }
-
-    if (tcsetattr(port_file,TCSANOW,&port_settings) < 0) {
-        Close();
-        return false;
-    }
-
-    if (tcgetattr(port_file,&port_settings) < 0) {
-        Close();
-        return false;
-    }
-
-    if (! SettingBaudRateSet(port_baudrate)) {
-        Close();
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[IsOpened]*****************************************
-bool cComPort::IsOpened() {
-
-    return (port_file >= 0);
-}
-
-//**************************[Close]********************************************
-void cComPort::Close() {
-
-    if (! IsOpened()) {
-        return;
-    }
-
-    tcsetattr(port_file,TCSANOW,&port_settings_old);
-
-    close(port_file);
-    port_file = -1;
-}
-
-//**************************[Transmit]*****************************************
-bool cComPort::Transmit(std::string text) {
-
-    int count;
-
-    if (! IsOpened()) {
-        return false;
-    }
-
-    count = write(port_file, &(text[0]),text.size());
-    if (count != text.size()) {
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[Receive]******************************************
-std::string cComPort::Receive() {
-
-    int count_in;
-    int count_out;
-    std::string result;
-
-    if (! IsOpened()) {
-        return "";
-    }
-
-    count_in = HWBufferInCountGet();
-    if (count_in < 1) { return ""; }
-
-    result.resize(count_in);
-    count_out = read(port_file, &(result[0]),count_in);
-    if (count_out < 0) {
-        return "";
-    }
-
-    result.resize(count_out);
-    return result;
-}
-
-//**************************[LineRtsSet]***************************************
-bool cComPort::LineRtsSet(bool state) {
-
-    int temp_status;
-
-    if (! IsOpened()) {
-        return false;
-    }
-
-    if (ioctl(port_file, TIOCMGET, &temp_status) == -1) {
-        return false;
-    }
-
-    if (state) {
-        temp_status|=  TIOCM_RTS;
-    } else{
-        temp_status&= ~TIOCM_RTS;
-    }
-
-    if (ioctl(port_file, TIOCMSET, &temp_status) == -1) {
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[LineDtrSet]***************************************
-bool cComPort::LineDtrSet(bool state) {
-
-    int temp_status;
-
-    if (! IsOpened()) {
-        return false;
-    }
-
-    if (ioctl(port_file, TIOCMGET, &temp_status) == -1) {
-        return false;
-    }
-
-    if (state) {
-        temp_status|=  TIOCM_DTR;
-    } else{
-        temp_status&= ~TIOCM_DTR;
-    }
-
-    if (ioctl(port_file, TIOCMSET, &temp_status) == -1) {
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[HWBufferInSizeGet]********************************
-int cComPort::HWBufferInSizeGet() {
-
-    // Dummy function - only working in windows
-    return -1;
-}
-
-//**************************[HWBufferOutSizeGet]*******************************
-int cComPort::HWBufferOutSizeGet() {
-
-    // Dummy function - only working in windows
-    return -1;
-}
-
-//**************************[HWBufferSizeSet]**********************************
-bool cComPort::HWBufferSizeSet(int buffer_in_size, int buffer_out_size) {
-
-    // Dummy function - only working in windows
-    return true;
-}
-
-//**************************[HWBufferInCountGet]*******************************
-int cComPort::HWBufferInCountGet() {
-
-    int in_count;
-
-    if (! IsOpened()) {
-        return -2;
-    }
-
-    if (ioctl(port_file, FIONREAD, &in_count) == -1) {
-        return -1;
-    }
-
-    return in_count;
-}
-
-//**************************[HWBufferOutCountGet]******************************
-int cComPort::HWBufferOutCountGet() {
-
-    int out_count;
-
-    if (! IsOpened()) {
-        return -2;
-    }
-
-    #if defined(FIONWRITE)
-        if (ioctl(port_file, FIONWRITE, &out_count) == -1) {
-            return -1;
-        }
-
-        return out_count;
-    #else // #if defined(FIONWRITE)
-        return -3;
-    #endif // #if defined(FIONWRITE)
-}
-
-//**************************[HWBufferFlush]************************************
-bool cComPort::HWBufferFlush(bool buffer_in, bool buffer_out) {
-
-    if (! IsOpened()) { return true; }
-    if ((buffer_in == false) && (buffer_out == false)) { return true; }
-
-    if (buffer_in) {
-        if (buffer_out) {
-            return (tcflush(port_file, TCIOFLUSH) != -1);
-        } else {
-            return (tcflush(port_file, TCIFLUSH) != -1);
-        }
-    } else {
-        if (buffer_out) {
-            return (tcflush(port_file, TCOFLUSH) != -1);
-        } else {
-            return true;
-        }
-    }
-}
-
-//**************************[SettingBaudRateGet]*******************************
-int cComPort::SettingBaudRateGet() {
-
-    if (! IsOpened()) {
-        return port_baudrate;
-    }
-
-    if (tcgetattr(port_file, &port_settings) == -1) {
-         return -1;
-    }
-
-    switch (port_settings.c_cflag & (CBAUD | CBAUDEX)) {
-        case (     B0) : return      0;
-        case (    B50) : return     50;
-        case (    B75) : return     75;
-        case (   B110) : return    110;
-        case (   B134) : return    134;
-        case (   B150) : return    150;
-        case (   B200) : return    200;
-        case (   B300) : return    300;
-        case (   B600) : return    600;
-        case (  B1200) : return   1200;
-        case (  B1800) : return   1800;
-        case (  B2400) : return   2400;
-        case (  B4800) : return   4800;
-        case (  B9600) : return   9600;
-        case ( B19200) : return  19200;
-        case ( B38400) :
-            serial_struct temp_serial;
-            if (ioctl(port_file, TIOCGSERIAL,&temp_serial) == -1) {
-                return 38400;
-            }
-
-            if ((temp_serial.flags & ASYNC_SPD_MASK) != ASYNC_SPD_CUST) {
-                return  38400;
-            }
-
-            if (temp_serial.custom_divisor == 0) {
-                return -3;
-            }
-            return temp_serial.baud_base / temp_serial.custom_divisor;
-
-        case ( B57600)     : return  57600;
-        #if defined( B76800)
-            case ( B76800) : return  76800;
-        #endif
-        #if defined(B115200)
-            case (B115200) : return 115200;
-        #endif
-        #if defined(B153600)
-            case (B153600) : return 153600;
-        #endif
-        #if defined(B230400)
-            case (B230400) : return 230400;
-        #endif
-        #if defined(B307200)
-            case (B307200) : return 307200;
-        #endif
-        #if defined(B460800)
-            case (B460800) : return 460800;
-        #endif
-
-        default        : return     -2;
-    }
-}
-
-//**************************[SettingByteSizeGet]*******************************
-eComPortByteSize cComPort::SettingByteSizeGet() {
-
-    if (IsOpened()) {
-        if (tcgetattr(port_file, &port_settings) == -1) {
-            return (eComPortByteSize) -2;
-        }
-    }
-
-    switch (port_settings.c_cflag & CSIZE) {
-        case (CS5) : return  kCpByteSize5; break;
-        case (CS6) : return  kCpByteSize6; break;
-        case (CS7) : return  kCpByteSize7; break;
-        case (CS8) : return  kCpByteSize8; break;
-        default    : return (eComPortByteSize) -1; break;
-    }
-}
-
-//**************************[SettingStopBitsGet]*******************************
-eComPortStopBits cComPort::SettingStopBitsGet() {
-
-    if (IsOpened()) {
-        if (tcgetattr(port_file, &port_settings) == -1) {
-            return (eComPortStopBits) -2;
-        }
-    }
-
-    if (port_settings.c_cflag & CSTOPB) {
-        return kCpStopBits2;
-    } else {
-        return kCpStopBits1;
-    }
-}
-
-//**************************[SettingParityGet]*********************************
-eComPortParity cComPort::SettingParityGet() {
-
-    if (IsOpened()) {
-        if (tcgetattr(port_file, &port_settings) == -1) {
-            return (eComPortParity) -2;
-        }
-    }
-
-    if ((port_settings.c_cflag & PARENB) == 0) {
-        return kCpParityNone;
-    }
-
-    #if defined(PAREXT)
-        if (port_settings.c_cflag & PAREXT) {
-            if (port_settings.c_cflag & PARODD) {
-                return kCpParityOdd;
-            } else {
-                return kCpParityEven;
-            }
-        } else {
-            if (port_settings.c_cflag & PARODD) {
-                return kCpParityMark;
-            } else {
-                return kCpParitySpace;
-            }
-        }
-    #else // if defined(PAREXT)
-        if (port_settings.c_cflag & PARODD) {
-            return kCpParityOdd;
-        } else {
-            return kCpParityEven;
-        }
-    #endif // if defined(PAREXT)
-}
-
-//**************************[SettingBaudRateSet]*******************************
-bool cComPort::SettingBaudRateSet(int baud_rate) {
-
-    port_baudrate = baud_rate;
-
-    if (! IsOpened()) {
-        return true;
-    }
-
-    if (tcgetattr(port_file, &port_settings) == -1) {
-        return false;
-    }
-
-    port_settings.c_cflag&= ~(CBAUD | CBAUDEX);
-    switch (baud_rate) {
-        case (     0) : port_settings.c_cflag|=      B0; break;
-        case (    50) : port_settings.c_cflag|=     B50; break;
-        case (    75) : port_settings.c_cflag|=     B75; break;
-        case (   110) : port_settings.c_cflag|=    B110; break;
-        case (   134) : port_settings.c_cflag|=    B134; break;
-        case (   150) : port_settings.c_cflag|=    B150; break;
-        case (   200) : port_settings.c_cflag|=    B200; break;
-        case (   300) : port_settings.c_cflag|=    B300; break;
-        case (   600) : port_settings.c_cflag|=    B600; break;
-        case (  1200) : port_settings.c_cflag|=   B1200; break;
-        case (  1800) : port_settings.c_cflag|=   B1800; break;
-        case (  2400) : port_settings.c_cflag|=   B2400; break;
-        case (  4800) : port_settings.c_cflag|=   B4800; break;
-        case (  9600) : port_settings.c_cflag|=   B9600; break;
-        case ( 19200) : port_settings.c_cflag|=  B19200; break;
-        case ( 38400) : port_settings.c_cflag|=  B38400; break;
-        case ( 57600) : port_settings.c_cflag|=  B57600; break;
-        #if defined( B76800)
-            case ( 76800) : port_settings.c_cflag|=  B76800; break;
-        #endif
-        #if defined(B115200)
-            case (115200) : port_settings.c_cflag|= B115200; break;
-        #endif
-        #if defined(B153600)
-            case (153600) : port_settings.c_cflag|= B153600; break;
-        #endif
-        #if defined(B230400)
-            case (230400) : port_settings.c_cflag|= B230400; break;
-        #endif
-        #if defined(B307200)
-            case (307200) : port_settings.c_cflag|= B307200; break;
-        #endif
-        #if defined(B460800)
-            case (460800) : port_settings.c_cflag|= B460800; break;
-        #endif
-        default           : port_settings.c_cflag|=  B38400; break;
-    }
-
-    if (tcsetattr(port_file, TCSANOW, &port_settings) == -1) {
-        return false;
-    }
-
-    if ((port_settings.c_cflag & (CBAUD | CBAUDEX)) != B38400) {
-        return true;
-    }
-
-    serial_struct temp_serial;
-
-    if (ioctl(port_file, TIOCGSERIAL,&temp_serial) == -1) {
-        return true;
-    }
-
-    if (baud_rate == 38400) {
-        if (temp_serial.flags & ASYNC_SPD_MASK) {
-            temp_serial.flags&= ~ASYNC_SPD_MASK;
-
-            if (ioctl(port_file, TIOCSSERIAL,&temp_serial) == -1) {
-                return false;
-            }
-        }
-    } else {
-        temp_serial.flags&= ~ASYNC_SPD_MASK;
-        temp_serial.flags|=  ASYNC_SPD_CUST;
-
-        temp_serial.custom_divisor = (temp_serial.baud_base + baud_rate / 2) /
-          baud_rate;
-
-        if (ioctl(port_file, TIOCSSERIAL,&temp_serial) == -1) {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-
-//**************************[SettingByteSizeSet]*******************************
-bool cComPort::SettingByteSizeSet(eComPortByteSize byte_size) {
-
-    if (IsOpened()) {
-        if (tcgetattr(port_file, &port_settings) == -1) {
-            return false;
-        }
-    }
-
-    port_settings.c_cflag&= ~CSIZE;
-    switch (byte_size) {
-        case (kCpByteSize5) : port_settings.c_cflag|= CS5; break;
-        case (kCpByteSize6) : port_settings.c_cflag|= CS6; break;
-        case (kCpByteSize7) : port_settings.c_cflag|= CS7; break;
-        default             : port_settings.c_cflag|= CS8; break;
-    }
-
-    if (IsOpened()) {
-        if (tcsetattr(port_file, TCSANOW, &port_settings) == -1) {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-//**************************[SettingStopBitsSet]*******************************
-bool cComPort::SettingStopBitsSet(eComPortStopBits stop_bits) {
-
-    if (IsOpened()) {
-        if (tcgetattr(port_file, &port_settings) == -1) {
-            return false;
-        }
-    }
-
-    if (stop_bits == kCpStopBits1) {
-        port_settings.c_cflag&= ~CSTOPB;
-    } else {
-        port_settings.c_cflag|=  CSTOPB;
-    }
-
-    if (IsOpened()) {
-        if (tcsetattr(port_file, TCSANOW, &port_settings) == -1) {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-//**************************[SettingParitySet]*********************************
-bool cComPort::SettingParitySet(eComPortParity parity) {
-
-    if (IsOpened()) {
-        if (tcgetattr(port_file, &port_settings) == -1) {
-            return false;
-        }
-    }
-
-    #if defined(PAREXT)
-        port_settings.c_cflag&= ~(PARENB | PARODD | PAREXT);
-    #else // if defined(PAREXT)
-        port_settings.c_cflag&= ~(PARENB | PARODD         );
-    #endif // if defined(PAREXT)
-
-    switch (parity) {
-        case (kCpParityOdd)   :
-            port_settings.c_cflag|= PARENB | PARODD         ; break;
-        case (kCpParityEven)  :
-            port_settings.c_cflag|= PARENB                  ; break;
-        #if defined(PAREXT)
-            case (kCpParityMark)  :
-                port_settings.c_cflag|= PARENB | PARODD | PAREXT; break;
-            case (kCpParitySpace) :
-                port_settings.c_cflag|= PARENB |          PAREXT; break;
-        #endif // if defined(PAREXT)
-        default               :                               break;
-    }
-
-    if (IsOpened()) {
-        if (tcsetattr(port_file, TCSANOW, &port_settings) == -1) {
-            return false;
-        }
-    }
-
-  return true;
-}
-
-//**************************[GetCurrentTime]***********************************
-int64_t cComPortBuffer::GetCurrentTime() const {
-
-    timespec time;
-
-    if (clock_gettime(CLOCK_MONOTONIC, &time)) {
-        return (uint64_t) -1;
-    }
-
-    return (int64_t) time.tv_sec * (int64_t) 1000 + (time.tv_nsec / 1000000);
-}
-
-//**************************[SleepOneMilliSecond]******************************
-void cComPortBuffer::SleepOneMilliSecond() const {
-
-    usleep(1000);
-}
-
-} // namespace wepet {
+/******************************************************************************
+*                                                                             *
+* wepet_comport_linux.cpp                                                     *
+* =======================                                                     *
+*                                                                             *
+* Version: 1.1.3                                                              *
+* Date   : 11.10.15                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <fstream>
+
+// additional headers
+#include <sys/time.h>
+
+#include <fcntl.h>
+#include <termio.h>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <string.h>
+#include <errno.h>
+
+
+
+namespace wepet {
+
+//**************************[cComPort]*****************************************
+cComPort::cComPort() {
+
+    transport = &port_serial;
+    port_opened = false;
+    port_lost = false;
+
+    StatisticReset();
+
+    port_baudrate = 57600;
+
+    port_rs485.enabled           = false;
+    port_rs485.rts_on_send       = true;
+    port_rs485.rts_after_send    = false;
+    port_rs485.delay_before_send = 0;
+    port_rs485.delay_after_send  = 0;
+    port_rs485.rx_during_tx      = false;
+    port_rs485_kernel = false;
+
+    port_receive_blocking = false;
+
+    port_pacing = 0;
+    port_transmit_offset = 0;
+    port_transmit_count = 0;
+    port_transmit_time = 0;
+
+    port_settings.c_iflag = 0;
+    port_settings.c_iflag|= IGNBRK ; // ignore BREAK condition
+    port_settings.c_iflag|= IGNPAR ; // ignore (discard) parity errors
+    /*
+    port_settings.c_iflag|= BRKINT ; // map BREAK to SIGINTR
+    port_settings.c_iflag|= PARMRK ; // mark parity and framing errors
+    port_settings.c_iflag|= INPCK  ; // enable checking of parity errors
+    port_settings.c_iflag|= ISTRIP ; // strip 8th bit off chars
+    port_settings.c_iflag|= IGNCR  ; // ignore CR
+    port_settings.c_iflag|= INLCR  ; // map NL into CR
+    port_settings.c_iflag|= ICRNL  ; // map CR to NL (ala CRMOD)
+    port_settings.c_iflag|= IXON   ; // enable output flow control
+    port_settings.c_iflag|= IXOFF  ; // enable input flow control
+    port_settings.c_iflag|= IXANY  ; // any char will restart after stop
+    port_settings.c_iflag|= IMAXBEL; // ring bell on input queue full
+    */
+
+    port_settings.c_oflag = 0;
+    /*
+    port_settings.c_oflag|= OPOST ; // enable following output processing
+    port_settings.c_oflag|= ONLCR ; // map NL to CR-NL (ala CRMOD)
+    port_settings.c_oflag|= OCRNL ; // map CR to NL
+    port_settings.c_oflag|= TABDLY; // tab delay mask
+    port_settings.c_oflag|= TAB0  ; // no tab delay and expansion
+    port_settings.c_oflag|= TAB3  ; // expand tabs to spaces
+    port_settings.c_oflag|= ONOEOT; // discard EOT's '^D' on output)
+    port_settings.c_oflag|= ONOCR ; // do not transmit CRs on column 0
+    port_settings.c_oflag|= ONLRET; // on the terminal NL performs the CR function
+    */
+
+    port_settings.c_cflag = 0;
+    port_settings.c_cflag|= CS8       ; // 8 bits
+    port_settings.c_cflag|= CSTOPB    ; // send 2 stop bits
+    port_settings.c_cflag|= CREAD     ; // enable receiver
+    port_settings.c_cflag|= CLOCAL    ; // ignore modem status lines
+    port_settings.c_cflag|= B38400    ;
+    /*
+    port_settings.c_cflag|= CSIZE     ; // character size mask
+    port_settings.c_cflag|= CS5       ; // 5 bits (pseudo)
+    port_settings.c_cflag|= CS6       ; // 6 bits
+    port_settings.c_cflag|= CS7       ; // 7 bits
+    port_settings.c_cflag|= PARENB    ; // parity enable
+    port_settings.c_cflag|= PARODD    ; // odd parity, else even
+    port_settings.c_cflag|= PAREXT    ; // Extended parity for mark and space parity
+    port_settings.c_cflag|= HUPCL     ; // hang up on last close
+    port_settings.c_cflag|= CCTS_OFLOW; // CTS flow control of output
+    port_settings.c_cflag|= CRTSCTS   ; // same as CCTS_OFLOW
+    port_settings.c_cflag|= CRTS_IFLOW; // RTS flow control of input
+    port_settings.c_cflag|= MDMBUF    ; // flow control output via Carrier
+    */
+
+    port_settings.c_lflag = 0;
+    /*
+    port_settings.c_lflag|= ECHOKE    ; // visual erase for line kill
+    port_settings.c_lflag|= ECHOE     ; // visually erase chars
+    port_settings.c_lflag|= ECHO      ; // enable echoing
+    port_settings.c_lflag|= ECHONL    ; // echo NL even if ECHO is off
+    port_settings.c_lflag|= ECHOPRT   ; // visual erase mode for hardcopy
+    port_settings.c_lflag|= ECHOCTL   ; // echo control chars as ^(Char)
+    port_settings.c_lflag|= ISIG      ; // enable signals INTR, QUIT, [D]SUSP
+    port_settings.c_lflag|= ICANON    ; // canonicalize input lines
+    port_settings.c_lflag|= ALTWERASE ; // use alternate WERASE algorithm
+    port_settings.c_lflag|= IEXTEN    ; // enable DISCARD and LNEXT
+    port_settings.c_lflag|= EXTPROC   ; // external processing
+    port_settings.c_lflag|= TOSTOP    ; // stop background jobs from output
+    port_settings.c_lflag|= FLUSHO    ; // output being flushed (state)
+    port_settings.c_lflag|= NOKERNINFO; // no kernel output from VSTATUS
+    port_settings.c_lflag|= PENDIN    ; // XXX retype pending input (state)
+    port_settings.c_lflag|= NOFLSH    ; // don't flush after interrupt
+    */
+
+    port_settings.c_cc[VMIN    ] = 0x00;
+    port_settings.c_cc[VTIME   ] = 0x00;
+    /*
+    port_settings.c_cc[VEOF    ] = 0x00;
+    port_settings.c_cc[VEOL    ] = 0x00;
+    port_settings.c_cc[VEOL2   ] = 0x00;
+    port_settings.c_cc[VERASE  ] = 0x00;
+    port_settings.c_cc[VWERASE ] = 0x00;
+    port_settings.c_cc[VKILL   ] = 0x00;
+    port_settings.c_cc[VREPRINT] = 0x00;
+    port_settings.c_cc[VINTR   ] = 0x00;
+    port_settings.c_cc[VQUIT   ] = 0x00;
+    port_settings.c_cc[VSUSP   ] = 0x00;
+    port_settings.c_cc[VDSUSP  ] = 0x00;
+    port_settings.c_cc[VSTART  ] = 0x00;
+    port_settings.c_cc[VSTOP   ] = 0x00;
+    port_settings.c_cc[VLNEXT  ] = 0x00;
+    port_settings.c_cc[VDISCARD] = 0x00;
+    port_settings.c_cc[VSTATUS ] = 0x00;
+    */
+}
+
+//**************************[~cComPort]****************************************
+cComPort::~cComPort() {
+
+    Close();
+}
+
+//**************************[Open]*********************************************
+bool cComPort::Open(std::string port_name) {
+
+    if (IsOpened()) {
+        Close();
+    }
+
+    port_lost = false;
+    this->port_name = port_name;
+
+    // other transports are opened by their owner - they are only attached
+    if (transport != &port_serial) {
+        port_opened = transport->IsOpened();
+        return port_opened;
+    }
+
+    if (! port_serial.Open(port_name)) { return false; }
+    port_opened = true;
+
+    if (tcsetattr(port_serial.FileGet(),TCSANOW,&port_settings) < 0) {
+        Close();
+        return false;
+    }
+
+    if (tcgetattr(port_serial.FileGet(),&port_settings) < 0) {
+        Close();
+        return false;
+    }
+
+    if (! SettingBaudRateSet(port_baudrate)) {
+        Close();
+        return false;
+    }
+
+    if (port_rs485.enabled) {
+        if (! Rs485Apply()) {
+            Close();
+            return false;
+        }
+    }
+
+    // the port is always opened non-blocking to not wait for carrier
+    if (port_receive_blocking) {
+        if (fcntl(port_serial.FileGet(), F_SETFL, 0) == -1) {
+            Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//**************************[IsOpened]*****************************************
+bool cComPort::IsOpened() {
+
+    return (port_opened && transport->IsOpened());
+}
+
+//**************************[TransportSet]*************************************
+void cComPort::TransportSet(cComPortTransport *transport) {
+
+    Close();
+
+    if (transport == NULL) {
+        transport = &port_serial;
+    }
+    this->transport = transport;
+}
+
+//**************************[TransportGet]*************************************
+cComPortTransport *cComPort::TransportGet() {
+
+    if (transport == &port_serial) {
+        return NULL;
+    }
+
+    return transport;
+}
+
+//**************************[Close]********************************************
+void cComPort::Close() {
+
+    port_lost = false;
+    port_opened = false;
+
+    // data held back by the pacing belongs to this connection
+    port_transmit_pending.clear();
+    port_transmit_offset = 0;
+    TransmitPendingUpdate();
+
+    // other transports are owned by the caller - they are only detached
+    if (transport == &port_serial) {
+        port_serial.Close();
+    }
+}
+
+//**************************[NameGet]******************************************
+std::string cComPort::NameGet() {
+
+    return port_name;
+}
+
+//**************************[FileGet]******************************************
+int cComPort::FileGet() {
+
+    if (! IsOpened()) {
+        return -1;
+    }
+
+    return transport->FileGet();
+}
+
+//**************************[HangupCheck]**************************************
+bool cComPort::HangupCheck() {
+
+    pollfd temp_poll;
+
+    if (! IsOpened()) {
+        return false;
+    }
+    if (port_lost) {
+        return true;
+    }
+
+    temp_poll.fd      = transport->FileGet();
+    if (temp_poll.fd < 0) { return false; }
+    temp_poll.events  = POLLIN;
+    temp_poll.revents = 0;
+    if (poll(&temp_poll, 1, 0) < 0) {
+        return false;
+    }
+
+    if (temp_poll.revents & (POLLHUP | POLLERR | POLLNVAL)) {
+        port_lost = true;
+    }
+    return port_lost;
+}
+
+//**************************[Transmit]*****************************************
+bool cComPort::Transmit(std::string text) {
+
+    int count;
+
+    if (! IsOpened()) {
+        return false;
+    }
+
+    if (port_rs485.enabled && (! port_rs485_kernel) && IsTermios()) {
+        // userspace rs485 - switch rts around the drained transmission
+        // the transmission is limited to twice its time on the line plus
+        // one second, afterwards the rest is discarded and rts released
+        bool result;
+        int64_t time_end, time_curr;
+        int time_char;
+        int count_out;
+
+        if (! LineRtsSet(port_rs485.rts_on_send)) {
+            return false;
+        }
+        if (port_rs485.delay_before_send > 0) {
+            usleep(port_rs485.delay_before_send * 1000);
+        }
+
+        // data held back by the pacing is sent first
+        if (port_transmit_offset < port_transmit_pending.size()) {
+            text.insert(0, port_transmit_pending, port_transmit_offset,
+              std::string::npos);
+        }
+        port_transmit_pending.clear();
+        port_transmit_offset = 0;
+        TransmitPendingUpdate();
+
+        // approximated time of one character in microseconds
+        time_char = 11000000 / (port_baudrate > 0 ? port_baudrate : 9600);
+        time_end  = TimeGet() + (int64_t) text.size() * time_char * 2 +
+          1000000;
+
+        pollfd temp_poll;
+        temp_poll.fd     = port_serial.FileGet();
+        temp_poll.events = POLLOUT;
+
+        result = true;
+        for (count = 0; count < text.size();) {
+            int temp = PortWrite(&(text[count]), text.size() - count);
+            if (temp > 0) {
+                count+= temp;
+                continue;
+            }
+            if ((temp < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+                result = false;
+                break;
+            }
+
+            time_curr = TimeGet();
+            if (time_curr >= time_end) {
+                result = false;
+                break;
+            }
+            poll(&temp_poll, 1, (time_end - time_curr) / 1000 + 1);
+        }
+
+        // tcdrain has no timeout - so the output queue is polled first
+        while (result && ((count_out = HWBufferOutCountGet()) > 0)) {
+            time_curr = TimeGet();
+            if (time_curr >= time_end) {
+                result = false;
+                break;
+            }
+
+            int64_t time_sleep = (int64_t) count_out * time_char;
+            if (time_sleep <    100) { time_sleep =   100; }
+            if (time_sleep >  10000) { time_sleep = 10000; }
+            usleep(time_sleep);
+        }
+        if (result && (count_out < 0)) {
+            result = false;
+        }
+
+        if (result) {
+            // waits for the last bytes within the hardware fifo
+            if (tcdrain(port_serial.FileGet()) == -1) {
+                result = false;
+            }
+        } else {
+            tcflush(port_serial.FileGet(), TCOFLUSH);
+        }
+
+        if (port_rs485.delay_after_send > 0) {
+            usleep(port_rs485.delay_after_send * 1000);
+        }
+        if (! LineRtsSet(port_rs485.rts_after_send)) {
+            result = false;
+        }
+
+        return result;
+    }
+
+    // after disabling the pacing the queue is still used until it is
+    // empty - otherwise new data would overtake the held back data
+    if ((port_pacing > 0) ||
+      (port_transmit_offset < port_transmit_pending.size())) {
+        port_transmit_pending.append(text);
+        TransmitPendingUpdate();
+        return TransmitUpdate();
+    }
+
+    count = PortWrite(&(text[0]),text.size());
+    if (count != text.size()) {
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[TransmitAndDrain]*********************************
+bool cComPort::TransmitAndDrain(std::string text, int milliseconds) {
+
+    int64_t time_end;
+    int64_t time_curr;
+    int count;
+    int count_out;
+    int time_char;
+
+    if (! IsOpened()) {
+        return false;
+    }
+
+    time_end = TimeGet() + (int64_t) milliseconds * 1000;
+
+    if (port_rs485.enabled && (! port_rs485_kernel) && IsTermios()) {
+        // userspace rs485 always drains the output
+        if (! Transmit(text)) {
+            return false;
+        }
+        port_transmit_time = TimeGet();
+        return true;
+    }
+
+    // data held back by the pacing is sent first
+    if (port_transmit_offset < port_transmit_pending.size()) {
+        text.insert(0, port_transmit_pending, port_transmit_offset,
+          std::string::npos);
+    }
+    port_transmit_pending.clear();
+    port_transmit_offset = 0;
+    TransmitPendingUpdate();
+
+    pollfd temp_poll;
+    temp_poll.fd     = transport->FileGet();
+    temp_poll.events = POLLOUT;
+
+    for (count = 0; count < text.size();) {
+        int temp = PortWrite(&(text[count]), text.size() - count);
+        if (temp > 0) {
+            count+= temp;
+            continue;
+        }
+        if ((temp < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+            return false;
+        }
+
+        time_curr = TimeGet();
+        if (time_curr >= time_end) { return false; }
+        if (temp_poll.fd < 0) {
+            // transport without file - poll only sleeps
+            poll(&temp_poll, 1, 1);
+        } else {
+            poll(&temp_poll, 1, (time_end - time_curr) / 1000 + 1);
+        }
+    }
+
+    // approximated time of one character in microseconds
+    time_char = 11000000 / (port_baudrate > 0 ? port_baudrate : 9600);
+
+    while ((count_out = HWBufferOutCountGet()) > 0) {
+        time_curr = TimeGet();
+        if (time_curr >= time_end) { return false; }
+
+        int64_t time_sleep = (int64_t) count_out * time_char;
+        if (time_sleep <    100) { time_sleep =   100; }
+        if (time_sleep >  10000) { time_sleep = 10000; }
+        if (time_sleep > time_end - time_curr) {
+            time_sleep = time_end - time_curr;
+        }
+        usleep(time_sleep);
+    }
+    if (count_out < 0) {
+        return false;
+    }
+
+    // waits for the last bytes within the hardware fifo
+    if (IsTermios() && (tcdrain(port_serial.FileGet()) == -1)) {
+        return false;
+    }
+
+    port_transmit_time = TimeGet();
+    return true;
+}
+
+//**************************[TransmitTimeGet]**********************************
+int64_t cComPort::TransmitTimeGet() {
+
+    return port_transmit_time;
+}
+
+//**************************[SettingPacingGet]*********************************
+int cComPort::SettingPacingGet() {
+
+    return port_pacing;
+}
+
+//**************************[SettingPacingSet]*********************************
+bool cComPort::SettingPacingSet(int queue_depth) {
+
+    if (queue_depth < 0) { queue_depth = 0; }
+
+    port_pacing = queue_depth;
+
+    // write out as much of the held back data as possible - the rest is
+    // written by the next calls of Transmit or TransmitUpdate
+    if (port_pacing == 0) {
+        return TransmitUpdate();
+    }
+
+    return true;
+}
+
+//**************************[TransmitUpdate]***********************************
+bool cComPort::TransmitUpdate() {
+
+    int count;
+    int count_out;
+
+    if (port_transmit_offset >= port_transmit_pending.size()) {
+        port_transmit_pending.clear();
+        port_transmit_offset = 0;
+        TransmitPendingUpdate();
+        return true;
+    }
+
+    if (! IsOpened()) {
+        return false;
+    }
+
+    count = port_transmit_pending.size() - port_transmit_offset;
+    if (port_pacing > 0) {
+        count_out = HWBufferOutCountGet();
+        if (count_out < 0) {
+            return false;
+        }
+        if (count > port_pacing - count_out) {
+            count = port_pacing - count_out;
+        }
+        if (count <= 0) {
+            return true;
+        }
+    }
+
+    count = PortWrite(&(port_transmit_pending[port_transmit_offset]), count);
+    if (count < 0) {
+        return ((errno == EAGAIN) || (errno == EINTR));
+    }
+    port_transmit_offset+= count;
+
+    // only move the data from time to time
+    if (port_transmit_offset >= port_transmit_pending.size()) {
+        port_transmit_pending.clear();
+        port_transmit_offset = 0;
+    } else if (port_transmit_offset > 65536) {
+        port_transmit_pending.erase(0, port_transmit_offset);
+        port_transmit_offset = 0;
+    }
+    TransmitPendingUpdate();
+
+    return true;
+}
+
+//**************************[TransmitUrgent]***********************************
+bool cComPort::TransmitUrgent(std::string text) {
+
+    int count;
+
+    if (! IsOpened()) {
+        return false;
+    }
+
+    count = PortWrite(&(text[0]),text.size());
+    if (count != text.size()) {
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[TransmitUrgent]***********************************
+bool cComPort::TransmitUrgent(std::string text, int &count) {
+
+    count = 0;
+    if (! IsOpened()) {
+        return false;
+    }
+    if (text.empty()) {
+        return true;
+    }
+
+    count = PortWrite(&(text[0]),text.size());
+    if (count < 0) {
+        count = 0;
+        return ((errno == EAGAIN) || (errno == EINTR));
+    }
+
+    return true;
+}
+
+//**************************[TransmitPendingGet]*******************************
+int cComPort::TransmitPendingGet() {
+
+    return __atomic_load_n(&port_transmit_count, __ATOMIC_RELAXED);
+}
+
+//**************************[TransmitPendingUpdate]****************************
+void cComPort::TransmitPendingUpdate() {
+
+    // the size is also read by other threads (e.g. cComPortMetrics)
+    __atomic_store_n(&port_transmit_count, (int) (port_transmit_pending.size()
+      - port_transmit_offset), __ATOMIC_RELAXED);
+}
+
+//**************************[Receive]******************************************
+std::string cComPort::Receive() {
+
+    return Receive(-1);
+}
+
+//**************************[Receive]******************************************
+std::string cComPort::Receive(int max_count) {
+
+    int count_in;
+    int count_out;
+    std::string result;
+
+    if (! IsOpened()) {
+        return "";
+    }
+
+    count_in = HWBufferInCountGet();
+    if (IsTermios() && port_receive_blocking) {
+        // read blocks as given by the receive policy (VMIN/VTIME)
+        if (count_in < 4096) { count_in = 4096; }
+    } else if (count_in < 1) {
+        return "";
+    }
+    if ((max_count >= 0) && (count_in > max_count)) { count_in = max_count; }
+    if (count_in < 1) { return ""; }
+
+    result.resize(count_in);
+    count_out = PortRead(&(result[0]),count_in);
+    if (count_out < 0) {
+        return "";
+    }
+
+    result.resize(count_out);
+    return result;
+}
+
+//**************************[LineRtsSet]***************************************
+bool cComPort::LineRtsSet(bool state) {
+
+    int temp_status;
+
+    if (! IsTermios()) {
+        return false;
+    }
+
+    // set or clear only this line - avoids read-modify-write races
+    temp_status = TIOCM_RTS;
+    if (ioctl(port_serial.FileGet(), state ? TIOCMBIS : TIOCMBIC,
+      &temp_status) == -1) {
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[LineDtrSet]***************************************
+bool cComPort::LineDtrSet(bool state) {
+
+    int temp_status;
+
+    if (! IsTermios()) {
+        return false;
+    }
+
+    temp_status = TIOCM_DTR;
+    if (ioctl(port_serial.FileGet(), state ? TIOCMBIS : TIOCMBIC,
+      &temp_status) == -1) {
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[LineStatusGet]************************************
+int cComPort::LineStatusGet() {
+
+    int temp_status;
+    int result;
+
+    if (! IsTermios()) {
+        return -2;
+    }
+
+    if (ioctl(port_serial.FileGet(), TIOCMGET, &temp_status) == -1) {
+        return -1;
+    }
+
+    result = 0;
+    if (temp_status & TIOCM_RTS) { result|= kCpLineRts; }
+    if (temp_status & TIOCM_DTR) { result|= kCpLineDtr; }
+    if (temp_status & TIOCM_CTS) { result|= kCpLineCts; }
+    if (temp_status & TIOCM_DSR) { result|= kCpLineDsr; }
+    if (temp_status & TIOCM_CD ) { result|= kCpLineDcd; }
+    if (temp_status & TIOCM_RI ) { result|= kCpLineRi ; }
+
+    return result;
+}
+
+//**************************[LineCtsGet]***************************************
+int cComPort::LineCtsGet() {
+
+    int temp_status;
+
+    temp_status = LineStatusGet();
+    if (temp_status < 0) { return temp_status; }
+
+    return (temp_status & kCpLineCts) ? 1 : 0;
+}
+
+//**************************[LineDsrGet]***************************************
+int cComPort::LineDsrGet() {
+
+    int temp_status;
+
+    temp_status = LineStatusGet();
+    if (temp_status < 0) { return temp_status; }
+
+    return (temp_status & kCpLineDsr) ? 1 : 0;
+}
+
+//**************************[LineDcdGet]***************************************
+int cComPort::LineDcdGet() {
+
+    int temp_status;
+
+    temp_status = LineStatusGet();
+    if (temp_status < 0) { return temp_status; }
+
+    return (temp_status & kCpLineDcd) ? 1 : 0;
+}
+
+//**************************[LineRiGet]****************************************
+int cComPort::LineRiGet() {
+
+    int temp_status;
+
+    temp_status = LineStatusGet();
+    if (temp_status < 0) { return temp_status; }
+
+    return (temp_status & kCpLineRi) ? 1 : 0;
+}
+
+//**************************[LineWait]*****************************************
+bool cComPort::LineWait(int lines, int milliseconds) {
+
+    sComPortCounters temp_start, temp_counters;
+    bool temp_counted;
+    int temp_mask;
+    int temp_status, temp_status_start;
+    int64_t time_end;
+
+    if (! IsTermios()) {
+        return false;
+    }
+
+    temp_mask = 0;
+    if (lines & kCpLineCts) { temp_mask|= TIOCM_CTS; }
+    if (lines & kCpLineDsr) { temp_mask|= TIOCM_DSR; }
+    if (lines & kCpLineDcd) { temp_mask|= TIOCM_CD ; }
+    if (lines & kCpLineRi ) { temp_mask|= TIOCM_RNG; }
+    if (temp_mask == 0) { return false; }
+
+    if (milliseconds < 0) {
+        // blocks within the kernel until one of the lines changes
+        if (ioctl(port_serial.FileGet(), TIOCMIWAIT, temp_mask) == -1) {
+            return false;
+        }
+
+        return true;
+    }
+
+    // TIOCMIWAIT can not be interrupted by a timeout - so the interrupt
+    // counters are polled instead (short pulses are counted, too)
+    // if the driver has no counters, the line status is compared
+    temp_counted = CounterGet(temp_start);
+    if (ioctl(port_serial.FileGet(), TIOCMGET, &temp_status_start) == -1) {
+        return false;
+    }
+
+    time_end = TimeGet() + (int64_t) milliseconds * 1000;
+    while (true) {
+        if (temp_counted) {
+            if (! CounterGet(temp_counters)) { return false; }
+
+            if (((temp_mask & TIOCM_CTS) &&
+              (temp_counters.cts != temp_start.cts)) ||
+              ((temp_mask & TIOCM_DSR) &&
+              (temp_counters.dsr != temp_start.dsr)) ||
+              ((temp_mask & TIOCM_CD ) &&
+              (temp_counters.dcd != temp_start.dcd)) ||
+              ((temp_mask & TIOCM_RNG) &&
+              (temp_counters.rng != temp_start.rng))) {
+                return true;
+            }
+        } else {
+            if (ioctl(port_serial.FileGet(), TIOCMGET, &temp_status) == -1) {
+                return false;
+            }
+            if ((temp_status ^ temp_status_start) & temp_mask) {
+                return true;
+            }
+        }
+
+        if (TimeGet() >= time_end) { return false; }
+        usleep(1000);
+    }
+}
+
+//**************************[HWBufferInSizeGet]********************************
+int cComPort::HWBufferInSizeGet() {
+
+    // Dummy function - only working in windows
+    return -1;
+}
+
+//**************************[HWBufferOutSizeGet]*******************************
+int cComPort::HWBufferOutSizeGet() {
+
+    // Dummy function - only working in windows
+    return -1;
+}
+
+//**************************[HWBufferSizeSet]**********************************
+bool cComPort::HWBufferSizeSet(int buffer_in_size, int buffer_out_size) {
+
+    // Dummy function - only working in windows
+    return true;
+}
+
+//**************************[HWBufferInCountGet]*******************************
+int cComPort::HWBufferInCountGet() {
+
+    if (! IsOpened()) {
+        return -2;
+    }
+
+    return transport->InCountGet();
+}
+
+//**************************[HWBufferOutCountGet]******************************
+int cComPort::HWBufferOutCountGet() {
+
+    if (! IsOpened()) {
+        return -2;
+    }
+
+    return transport->OutCountGet();
+}
+
+//**************************[HWBufferFlush]************************************
+bool cComPort::HWBufferFlush(bool buffer_in, bool buffer_out) {
+
+    if (! IsTermios()) { return true; }
+    if ((buffer_in == false) && (buffer_out == false)) { return true; }
+
+    if (buffer_in) {
+        if (buffer_out) {
+            return (tcflush(port_serial.FileGet(), TCIOFLUSH) != -1);
+        } else {
+            return (tcflush(port_serial.FileGet(), TCIFLUSH) != -1);
+        }
+    } else {
+        if (buffer_out) {
+            return (tcflush(port_serial.FileGet(), TCOFLUSH) != -1);
+        } else {
+            return true;
+        }
+    }
+}
+
+//**************************[SettingBaudRateGet]*******************************
+int cComPort::SettingBaudRateGet() {
+
+    if (! IsTermios()) {
+        return port_baudrate;
+    }
+
+    if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+         return -1;
+    }
+
+    switch (port_settings.c_cflag & (CBAUD | CBAUDEX)) {
+        case (     B0) : return      0;
+        case (    B50) : return     50;
+        case (    B75) : return     75;
+        case (   B110) : return    110;
+        case (   B134) : return    134;
+        case (   B150) : return    150;
+        case (   B200) : return    200;
+        case (   B300) : return    300;
+        case (   B600) : return    600;
+        case (  B1200) : return   1200;
+        case (  B1800) : return   1800;
+        case (  B2400) : return   2400;
+        case (  B4800) : return   4800;
+        case (  B9600) : return   9600;
+        case ( B19200) : return  19200;
+        case ( B38400) :
+            serial_struct temp_serial;
+            if (ioctl(port_serial.FileGet(), TIOCGSERIAL,&temp_serial) == -1) {
+                return 38400;
+            }
+
+            if ((temp_serial.flags & ASYNC_SPD_MASK) != ASYNC_SPD_CUST) {
+                return  38400;
+            }
+
+            if (temp_serial.custom_divisor == 0) {
+                return -3;
+            }
+            return temp_serial.baud_base / temp_serial.custom_divisor;
+
+        case ( B57600)     : return  57600;
+        #if defined( B76800)
+            case ( B76800) : return  76800;
+        #endif
+        #if defined(B115200)
+            case (B115200) : return 115200;
+        #endif
+        #if defined(B153600)
+            case (B153600) : return 153600;
+        #endif
+        #if defined(B230400)
+            case (B230400) : return 230400;
+        #endif
+        #if defined(B307200)
+            case (B307200) : return 307200;
+        #endif
+        #if defined(B460800)
+            case (B460800) : return 460800;
+        #endif
+
+        default        : return     -2;
+    }
+}
+
+//**************************[SettingByteSizeGet]*******************************
+eComPortByteSize cComPort::SettingByteSizeGet() {
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return (eComPortByteSize) -2;
+        }
+    }
+
+    switch (port_settings.c_cflag & CSIZE) {
+        case (CS5) : return  kCpByteSize5; break;
+        case (CS6) : return  kCpByteSize6; break;
+        case (CS7) : return  kCpByteSize7; break;
+        case (CS8) : return  kCpByteSize8; break;
+        default    : return (eComPortByteSize) -1; break;
+    }
+}
+
+//**************************[SettingStopBitsGet]*******************************
+eComPortStopBits cComPort::SettingStopBitsGet() {
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return (eComPortStopBits) -2;
+        }
+    }
+
+    if (port_settings.c_cflag & CSTOPB) {
+        return kCpStopBits2;
+    } else {
+        return kCpStopBits1;
+    }
+}
+
+//**************************[SettingParityGet]*********************************
+eComPortParity cComPort::SettingParityGet() {
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return (eComPortParity) -2;
+        }
+    }
+
+    if ((port_settings.c_cflag & PARENB) == 0) {
+        return kCpParityNone;
+    }
+
+    #if defined(PAREXT)
+        if (port_settings.c_cflag & PAREXT) {
+            if (port_settings.c_cflag & PARODD) {
+                return kCpParityOdd;
+            } else {
+                return kCpParityEven;
+            }
+        } else {
+            if (port_settings.c_cflag & PARODD) {
+                return kCpParityMark;
+            } else {
+                return kCpParitySpace;
+            }
+        }
+    #else // if defined(PAREXT)
+        if (port_settings.c_cflag & PARODD) {
+            return kCpParityOdd;
+        } else {
+            return kCpParityEven;
+        }
+    #endif // if defined(PAREXT)
+}
+
+//**************************[SettingBaudRateSet]*******************************
+bool cComPort::SettingBaudRateSet(int baud_rate) {
+
+    port_baudrate = baud_rate;
+
+    if (! transport->BaudRateSet(baud_rate)) {
+        return false;
+    }
+
+    // keep the stored settings up to date
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//**************************[SettingByteSizeSet]*******************************
+bool cComPort::SettingByteSizeSet(eComPortByteSize byte_size) {
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    port_settings.c_cflag&= ~CSIZE;
+    switch (byte_size) {
+        case (kCpByteSize5) : port_settings.c_cflag|= CS5; break;
+        case (kCpByteSize6) : port_settings.c_cflag|= CS6; break;
+        case (kCpByteSize7) : port_settings.c_cflag|= CS7; break;
+        default             : port_settings.c_cflag|= CS8; break;
+    }
+
+    if (IsTermios()) {
+        if (tcsetattr(port_serial.FileGet(), TCSANOW, &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//**************************[SettingStopBitsSet]*******************************
+bool cComPort::SettingStopBitsSet(eComPortStopBits stop_bits) {
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    if (stop_bits == kCpStopBits1) {
+        port_settings.c_cflag&= ~CSTOPB;
+    } else {
+        port_settings.c_cflag|=  CSTOPB;
+    }
+
+    if (IsTermios()) {
+        if (tcsetattr(port_serial.FileGet(), TCSANOW, &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//**************************[SettingParitySet]*********************************
+bool cComPort::SettingParitySet(eComPortParity parity) {
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    #if defined(PAREXT)
+        port_settings.c_cflag&= ~(PARENB | PARODD | PAREXT);
+    #else // if defined(PAREXT)
+        port_settings.c_cflag&= ~(PARENB | PARODD         );
+    #endif // if defined(PAREXT)
+
+    switch (parity) {
+        case (kCpParityOdd)   :
+            port_settings.c_cflag|= PARENB | PARODD         ; break;
+        case (kCpParityEven)  :
+            port_settings.c_cflag|= PARENB                  ; break;
+        #if defined(PAREXT)
+            case (kCpParityMark)  :
+                port_settings.c_cflag|= PARENB | PARODD | PAREXT; break;
+            case (kCpParitySpace) :
+                port_settings.c_cflag|= PARENB |          PAREXT; break;
+        #endif // if defined(PAREXT)
+        default               :                               break;
+    }
+
+    if (IsTermios()) {
+        if (tcsetattr(port_serial.FileGet(), TCSANOW, &port_settings) == -1) {
+            return false;
+        }
+    }
+
+  return true;
+}
+
+//**************************[SettingControlApply]******************************
+bool cComPort::SettingControlApply(int baud_rate, uint32_t flags,
+  uint32_t mask) {
+
+    if (IsTermios()) {
+        // keeps changes done by others (e.g. stty)
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    port_baudrate = baud_rate;
+    port_settings.c_cflag = (port_settings.c_cflag & ~mask) | flags;
+
+    if (IsTermios()) {
+        if (tcsetattr(port_serial.FileGet(), TCSANOW, &port_settings) ==
+          -1) {
+            return false;
+        }
+
+        // the old divisor would still be active for 38400
+        if ((port_settings.c_cflag & (CBAUD | CBAUDEX)) == B38400) {
+            return port_serial.DivisorSet(baud_rate);
+        }
+        return true;
+    }
+
+    return transport->BaudRateSet(baud_rate);
+}
+
+//**************************[SettingFlowControlGet]****************************
+eComPortFlowControl cComPort::SettingFlowControlGet() {
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return (eComPortFlowControl) -2;
+        }
+    }
+
+    if (port_settings.c_cflag & CRTSCTS) {
+        return kCpFlowControlRtsCts;
+    }
+
+    if (port_settings.c_iflag & (IXON | IXOFF)) {
+        return kCpFlowControlXonXoff;
+    }
+
+    return kCpFlowControlNone;
+}
+
+//**************************[SettingFlowControlSet]****************************
+bool cComPort::SettingFlowControlSet(eComPortFlowControl flow_control) {
+
+    // linux has no termios flag for dtr/dsr flow control
+    if (flow_control == kCpFlowControlDtrDsr) {
+        return false;
+    }
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    port_settings.c_cflag&= ~CRTSCTS;
+    port_settings.c_iflag&= ~(IXON | IXOFF | IXANY);
+
+    switch (flow_control) {
+        case (kCpFlowControlRtsCts)  :
+            port_settings.c_cflag|= CRTSCTS; break;
+        case (kCpFlowControlXonXoff) :
+            port_settings.c_iflag|= IXON | IXOFF;
+            port_settings.c_cc[VSTART] = 0x11; // DC1
+            port_settings.c_cc[VSTOP ] = 0x13; // DC3
+            break;
+        default                      :  break;
+    }
+
+    if (IsTermios()) {
+        if (tcsetattr(port_serial.FileGet(), TCSANOW, &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//**************************[SettingErrorMarkGet]******************************
+bool cComPort::SettingErrorMarkGet() {
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    return ((port_settings.c_iflag & PARMRK) != 0);
+}
+
+//**************************[SettingErrorMarkSet]******************************
+bool cComPort::SettingErrorMarkSet(bool state) {
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    if (state) {
+        port_settings.c_iflag&= ~(IGNBRK | IGNPAR | ISTRIP);
+        port_settings.c_iflag|=   PARMRK | INPCK;
+    } else {
+        port_settings.c_iflag&= ~(PARMRK | INPCK);
+        port_settings.c_iflag|=   IGNBRK | IGNPAR;
+    }
+
+    if (IsTermios()) {
+        if (tcsetattr(port_serial.FileGet(), TCSANOW, &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//**************************[SettingReceivePolicySet]**************************
+bool cComPort::SettingReceivePolicySet(int min_bytes, int milliseconds,
+  bool blocking) {
+
+    if ((min_bytes < 0) || (min_bytes > 255)) { return false; }
+    if ((milliseconds < 0) || (milliseconds > 25500)) { return false; }
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return false;
+        }
+    }
+
+    // VTIME is given in tenths of a second
+    port_settings.c_cc[VMIN ] = min_bytes;
+    port_settings.c_cc[VTIME] = (milliseconds + 99) / 100;
+
+    if (IsTermios()) {
+        if (tcsetattr(port_serial.FileGet(), TCSANOW, &port_settings) == -1) {
+            return false;
+        }
+        if (fcntl(port_serial.FileGet(), F_SETFL,
+          blocking ? 0 : O_NONBLOCK) == -1) {
+            return false;
+        }
+    }
+
+    port_receive_blocking = blocking;
+    return true;
+}
+
+//**************************[SettingReceiveMinGet]*****************************
+int cComPort::SettingReceiveMinGet() {
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return -1;
+        }
+    }
+
+    return port_settings.c_cc[VMIN];
+}
+
+//**************************[SettingReceiveTimeoutGet]*************************
+int cComPort::SettingReceiveTimeoutGet() {
+
+    if (IsTermios()) {
+        if (tcgetattr(port_serial.FileGet(), &port_settings) == -1) {
+            return -1;
+        }
+    }
+
+    return port_settings.c_cc[VTIME] * 100;
+}
+
+//**************************[SettingReceiveBlockingGet]************************
+bool cComPort::SettingReceiveBlockingGet() {
+
+    return port_receive_blocking;
+}
+
+//**************************[CounterGet]***************************************
+bool cComPort::CounterGet(sComPortCounters &counters) {
+
+    serial_icounter_struct temp_counters;
+
+    if (! IsTermios()) {
+        return false;
+    }
+
+    if (ioctl(port_serial.FileGet(), TIOCGICOUNT, &temp_counters) == -1) {
+        return false;
+    }
+
+    counters.rx          = temp_counters.rx;
+    counters.tx          = temp_counters.tx;
+    counters.frame       = temp_counters.frame;
+    counters.overrun     = temp_counters.overrun;
+    counters.parity      = temp_counters.parity;
+    counters.brk         = temp_counters.brk;
+    counters.buf_overrun = temp_counters.buf_overrun;
+
+    counters.cts         = temp_counters.cts;
+    counters.dsr         = temp_counters.dsr;
+    counters.rng         = temp_counters.rng;
+    counters.dcd         = temp_counters.dcd;
+
+    return true;
+}
+
+//**************************[CounterDeltaGet]**********************************
+bool cComPort::CounterDeltaGet(sComPortCounters &baseline,
+  sComPortCounters &counters) {
+
+    sComPortCounters temp_counters;
+
+    if (! CounterGet(temp_counters)) {
+        return false;
+    }
+
+    counters.rx          = temp_counters.rx          - baseline.rx;
+    counters.tx          = temp_counters.tx          - baseline.tx;
+    counters.frame       = temp_counters.frame       - baseline.frame;
+    counters.overrun     = temp_counters.overrun     - baseline.overrun;
+    counters.parity      = temp_counters.parity      - baseline.parity;
+    counters.brk         = temp_counters.brk         - baseline.brk;
+    counters.buf_overrun = temp_counters.buf_overrun - baseline.buf_overrun;
+
+    counters.cts         = temp_counters.cts         - baseline.cts;
+    counters.dsr         = temp_counters.dsr         - baseline.dsr;
+    counters.rng         = temp_counters.rng         - baseline.rng;
+    counters.dcd         = temp_counters.dcd         - baseline.dcd;
+
+    baseline = temp_counters;
+
+    return true;
+}
+
+//**************************[SettingRs485Get]**********************************
+sComPortRs485 cComPort::SettingRs485Get() {
+
+    return port_rs485;
+}
+
+//**************************[SettingRs485Set]**********************************
+bool cComPort::SettingRs485Set(sComPortRs485 rs485) {
+
+    if (rs485.delay_before_send < 0) { rs485.delay_before_send = 0; }
+    if (rs485.delay_after_send  < 0) { rs485.delay_after_send  = 0; }
+
+    port_rs485 = rs485;
+
+    if (! IsTermios()) {
+        return true;
+    }
+
+    return Rs485Apply();
+}
+
+//**************************[SettingRs485KernelGet]****************************
+bool cComPort::SettingRs485KernelGet() {
+
+    return port_rs485_kernel;
+}
+
+//**************************[Rs485Apply]***************************************
+bool cComPort::Rs485Apply() {
+
+    serial_rs485 temp_rs485;
+
+    memset(&temp_rs485, 0, sizeof(temp_rs485));
+    if (port_rs485.enabled) {
+        temp_rs485.flags|= SER_RS485_ENABLED;
+        if (port_rs485.rts_on_send) {
+            temp_rs485.flags|= SER_RS485_RTS_ON_SEND;
+        }
+        if (port_rs485.rts_after_send) {
+            temp_rs485.flags|= SER_RS485_RTS_AFTER_SEND;
+        }
+        if (port_rs485.rx_during_tx) {
+            temp_rs485.flags|= SER_RS485_RX_DURING_TX;
+        }
+        temp_rs485.delay_rts_before_send = port_rs485.delay_before_send;
+        temp_rs485.delay_rts_after_send  = port_rs485.delay_after_send;
+    }
+
+    if (ioctl(port_serial.FileGet(), TIOCSRS485, &temp_rs485) != -1) {
+        port_rs485_kernel = port_rs485.enabled;
+        return true;
+    }
+
+    // driver without rs485 support - fall back to userspace switching
+    port_rs485_kernel = false;
+    if (! port_rs485.enabled) {
+        return true;
+    }
+
+    return LineRtsSet(port_rs485.rts_after_send);
+}
+
+//**************************[IsTermios]****************************************
+bool cComPort::IsTermios() {
+
+    return ((transport == &port_serial) && port_serial.IsOpened());
+}
+
+//**************************[PortWrite]****************************************
+int cComPort::PortWrite(const char *data, int size) {
+
+    int64_t time_start;
+    int result;
+
+    time_start = TimeGet();
+    result = transport->Write(data, size);
+    StatisticWrite(result, TimeGet() - time_start);
+    // removed usb devices return EIO instead of a hangup
+    if ((result < 0) && (errno == EIO)) { port_lost = true; }
+
+    return result;
+}
+
+//**************************[PortRead]*****************************************
+int cComPort::PortRead(char *data, int size) {
+
+    int result;
+
+    result = transport->Read(data, size);
+    StatisticRead(result);
+    if ((result < 0) && (errno == EIO)) { port_lost = true; }
+
+    return result;
+}
+
+//**************************[TimeGet]******************************************
+int64_t cComPort::TimeGet() {
+
+    timespec time;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &time)) {
+        return (uint64_t) -1;
+    }
+
+    return (int64_t) time.tv_sec * (int64_t) 1000000 + (time.tv_nsec / 1000);
+}
+
+//**************************[cComPortSerial]***********************************
+cComPortSerial::cComPortSerial() {
+
+    file = -1;
+}
+
+//**************************[~cComPortSerial]**********************************
+cComPortSerial::~cComPortSerial() {
+
+    Close();
+}
+
+//**************************[Open]*********************************************
+bool cComPortSerial::Open(std::string name) {
+
+    Close();
+
+    file = open(name.data(), O_RDWR | O_NONBLOCK | O_NOCTTY);
+    if (file < 0) { return false; }
+
+    if (tcgetattr(file,&settings_old) < 0) {
+        close(file);
+        file = -1;
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[IsOpened]*****************************************
+bool cComPortSerial::IsOpened() {
+
+    return (file >= 0);
+}
+
+//**************************[Close]********************************************
+void cComPortSerial::Close() {
+
+    if (file < 0) {
+        return;
+    }
+
+    tcsetattr(file,TCSANOW,&settings_old);
+
+    close(file);
+    file = -1;
+}
+
+//**************************[Write]********************************************
+int cComPortSerial::Write(const char *data, int size) {
+
+    return write(file, data, size);
+}
+
+//**************************[Read]*********************************************
+int cComPortSerial::Read(char *data, int size) {
+
+    return read(file, data, size);
+}
+
+//**************************[InCountGet]***************************************
+int cComPortSerial::InCountGet() {
+
+    int in_count;
+
+    if (ioctl(file, FIONREAD, &in_count) == -1) {
+        return -1;
+    }
+
+    return in_count;
+}
+
+//**************************[OutCountGet]**************************************
+int cComPortSerial::OutCountGet() {
+
+    int out_count;
+
+    #if defined(TIOCOUTQ)
+        if (ioctl(file, TIOCOUTQ, &out_count) == -1) {
+            return -1;
+        }
+
+        return out_count;
+    #elif defined(FIONWRITE)
+        if (ioctl(file, FIONWRITE, &out_count) == -1) {
+            return -1;
+        }
+
+        return out_count;
+    #else // #if defined(TIOCOUTQ)
+        return -3;
+    #endif // #if defined(TIOCOUTQ)
+}
+
+//**************************[BaudRateSet]**************************************
+bool cComPortSerial::BaudRateSet(int baud_rate) {
+
+    termios temp_settings;
+
+    if (file < 0) {
+        return true;
+    }
+
+    if (tcgetattr(file, &temp_settings) == -1) {
+        return false;
+    }
+
+    temp_settings.c_cflag&= ~(CBAUD | CBAUDEX);
+    switch (baud_rate) {
+        case (     0) : temp_settings.c_cflag|=      B0; break;
+        case (    50) : temp_settings.c_cflag|=     B50; break;
+        case (    75) : temp_settings.c_cflag|=     B75; break;
+        case (   110) : temp_settings.c_cflag|=    B110; break;
+        case (   134) : temp_settings.c_cflag|=    B134; break;
+        case (   150) : temp_settings.c_cflag|=    B150; break;
+        case (   200) : temp_settings.c_cflag|=    B200; break;
+        case (   300) : temp_settings.c_cflag|=    B300; break;
+        case (   600) : temp_settings.c_cflag|=    B600; break;
+        case (  1200) : temp_settings.c_cflag|=   B1200; break;
+        case (  1800) : temp_settings.c_cflag|=   B1800; break;
+        case (  2400) : temp_settings.c_cflag|=   B2400; break;
+        case (  4800) : temp_settings.c_cflag|=   B4800; break;
+        case (  9600) : temp_settings.c_cflag|=   B9600; break;
+        case ( 19200) : temp_settings.c_cflag|=  B19200; break;
+        case ( 38400) : temp_settings.c_cflag|=  B38400; break;
+        case ( 57600) : temp_settings.c_cflag|=  B57600; break;
+        #if defined( B76800)
+            case ( 76800) : temp_settings.c_cflag|=  B76800; break;
+        #endif
+        #if defined(B115200)
+            case (115200) : temp_settings.c_cflag|= B115200; break;
+        #endif
+        #if defined(B153600)
+            case (153600) : temp_settings.c_cflag|= B153600; break;
+        #endif
+        #if defined(B230400)
+            case (230400) : temp_settings.c_cflag|= B230400; break;
+        #endif
+        #if defined(B307200)
+            case (307200) : temp_settings.c_cflag|= B307200; break;
+        #endif
+        #if defined(B460800)
+            case (460800) : temp_settings.c_cflag|= B460800; break;
+        #endif
+        default           : temp_settings.c_cflag|=  B38400; break;
+    }
+
+    if (tcsetattr(file, TCSANOW, &temp_settings) == -1) {
+        return false;
+    }
+
+    if ((temp_settings.c_cflag & (CBAUD | CBAUDEX)) != B38400) {
+        return true;
+    }
+
+    return DivisorSet(baud_rate);
+}
+
+//**************************[DivisorSet]***************************************
+bool cComPortSerial::DivisorSet(int baud_rate) {
+
+    serial_struct temp_serial;
+
+    if (file < 0) {
+        return true;
+    }
+
+    if (ioctl(file, TIOCGSERIAL,&temp_serial) == -1) {
+        return true;
+    }
+
+    if (baud_rate == 38400) {
+        if (temp_serial.flags & ASYNC_SPD_MASK) {
+            temp_serial.flags&= ~ASYNC_SPD_MASK;
+
+            if (ioctl(file, TIOCSSERIAL,&temp_serial) == -1) {
+                return false;
+            }
+        }
+    } else {
+        temp_serial.flags&= ~ASYNC_SPD_MASK;
+        temp_serial.flags|=  ASYNC_SPD_CUST;
+
+        temp_serial.custom_divisor = (temp_serial.baud_base + baud_rate / 2) /
+          baud_rate;
+
+        if (ioctl(file, TIOCSSERIAL,&temp_serial) == -1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//**************************[FileGet]******************************************
+int cComPortSerial::FileGet() {
+
+    return file;
+}
+
+
+
+//**************************[TimeGet]******************************************
+int64_t cComPortClockMonotonic::TimeGet() {
+
+    timespec time;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &time)) {
+        return -1;
+    }
+
+    return (int64_t) time.tv_sec * (int64_t) 1000000000 + time.tv_nsec;
+}
+
+//**************************[Sleep]********************************************
+void cComPortClockMonotonic::Sleep(int64_t nanoseconds) {
+
+    if (nanoseconds <= 0) { return; }
+
+    timespec time;
+    time.tv_sec  = nanoseconds / 1000000000;
+    time.tv_nsec = nanoseconds % 1000000000;
+
+    while ((nanosleep(&time, &time) != 0) && (errno == EINTR)) {}
+}
+
+//**************************[ReconnectSet]*************************************
+void cComPortBuffer::ReconnectSet(bool enabled) {
+
+    reconnect_enabled = enabled;
+    reconnect_delay   = 0;
+
+    if ((! enabled) && (reconnect_notify >= 0)) {
+        close(reconnect_notify);
+        reconnect_notify = -1;
+    }
+}
+
+//**************************[ReconnectUpdate]**********************************
+void cComPortBuffer::ReconnectUpdate() {
+
+    int64_t time_curr;
+    bool event;
+
+    if (IsOpened()) {
+        if (! HangupCheck()) { return; }
+
+        // device was lost - watch /dev for its return
+        Close();
+        port_lost = true;
+
+        if (reconnect_notify < 0) {
+            reconnect_notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (reconnect_notify >= 0) {
+                inotify_add_watch(reconnect_notify, "/dev",
+                  IN_CREATE | IN_ATTRIB | IN_MOVED_TO);
+
+                std::string temp_dir = NameGet();
+                std::string::size_type pos = temp_dir.rfind('/');
+                if ((pos != std::string::npos) && (pos > 0)) {
+                    temp_dir.erase(pos);
+                    if (temp_dir != "/dev") {
+                        inotify_add_watch(reconnect_notify, temp_dir.data(),
+                          IN_CREATE | IN_ATTRIB | IN_MOVED_TO);
+                    }
+                }
+            }
+        }
+
+        reconnect_delay = 10;
+        reconnect_time  = GetCurrentTime();
+
+        if (reconnect_callback != NULL) {
+            reconnect_callback(this, false, reconnect_data);
+        }
+        return;
+    }
+
+    // only lost devices are reopened (not explicitly closed ports)
+    if ((! port_lost) || (NameGet() == "")) { return; }
+
+    // any change within the watched directories triggers a retry
+    event = false;
+    if (reconnect_notify >= 0) {
+        char temp_buffer[4096];
+        while (read(reconnect_notify, temp_buffer, sizeof(temp_buffer)) > 0) {
+            event = true;
+        }
+    }
+
+    time_curr = GetCurrentTime();
+    if ((! event) &&
+      (time_curr - reconnect_time < (int64_t) reconnect_delay * 1000000)) {
+        return;
+    }
+
+    if (! Open(NameGet())) {
+        port_lost = true;
+
+        // exponential backoff - inotify events still retry immediately
+        reconnect_time  = time_curr;
+        reconnect_delay*= 2;
+        if (reconnect_delay <   10) { reconnect_delay =   10; }
+        if (reconnect_delay > 1000) { reconnect_delay = 1000; }
+        return;
+    }
+
+    reconnect_count++;
+    reconnect_delay = 0;
+    if (reconnect_notify >= 0) {
+        close(reconnect_notify);
+        reconnect_notify = -1;
+    }
+
+    if (reconnect_callback != NULL) {
+        reconnect_callback(this, true, reconnect_data);
+    }
+}
+
+} // namespace wepet {
@@ -0,0 +1,302 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_list.cpp                                                      *
+* ======================                                                      *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_list.h"
+
+// wepet headers
+
+// standard headers
+#include <set>
+
+// additional headers
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+
+namespace wepet {
+
+//**************************[cComPortList]*************************************
+cComPortList::cComPortList() {
+
+}
+
+//**************************[~cComPortList]************************************
+cComPortList::~cComPortList() {
+
+}
+
+//**************************[Update]*******************************************
+bool cComPortList::Update() {
+
+    DIR *temp_dir;
+    dirent *temp_entry;
+    std::set<std::string> names;
+    struct stat temp_stat;
+    int i;
+
+    // only ttys with a device are real serial ports
+    temp_dir = opendir("/sys/class/tty");
+    if (temp_dir == NULL) { return false; }
+
+    while ((temp_entry = readdir(temp_dir)) != NULL) {
+        std::string name = temp_entry->d_name;
+        if (name[0] == '.') { continue; }
+
+        std::string path = "/sys/class/tty/" + name + "/device";
+        if (lstat(path.data(), &temp_stat) != 0) { continue; }
+
+        names.insert(name);
+    }
+    closedir(temp_dir);
+
+    // remove old entries - and re-enumerated ones (the same tty name might
+    // now belong to another device)
+    for (i = items.size() - 1; i >= 0; i--) {
+        if (names.count(items[i].name) == 0) {
+            items.erase(items.begin() + i);
+        } else if (IdentityRead(items[i].name) != items[i].identity) {
+            items.erase(items.begin() + i);
+        } else {
+            names.erase(items[i].name);
+            items[i].by_id = "";
+        }
+    }
+
+    // add new entries
+    std::set<std::string>::iterator it;
+    for (it = names.begin(); it != names.end(); it++) {
+        sComPortInfo temp_info;
+        if (ItemRead(*it, temp_info)) {
+            items.push_back(temp_info);
+        }
+    }
+
+    // persistent names (might not exist)
+    temp_dir = opendir("/dev/serial/by-id");
+    if (temp_dir == NULL) { return true; }
+
+    while ((temp_entry = readdir(temp_dir)) != NULL) {
+        if (temp_entry->d_name[0] == '.') { continue; }
+
+        std::string path = "/dev/serial/by-id/";
+        path+= temp_entry->d_name;
+
+        char temp_link[PATH_MAX];
+        int count = readlink(path.data(), temp_link, sizeof(temp_link) - 1);
+        if (count <= 0) { continue; }
+        temp_link[count] = 0;
+
+        std::string target = temp_link;
+        std::string::size_type pos = target.rfind('/');
+        if (pos != std::string::npos) { target.erase(0, pos + 1); }
+
+        i = FindByName(target);
+        if (i >= 0) { items[i].by_id = path; }
+    }
+    closedir(temp_dir);
+
+    return true;
+}
+
+//**************************[Clear]********************************************
+void cComPortList::Clear() {
+
+    items.clear();
+}
+
+//**************************[CountGet]*****************************************
+int cComPortList::CountGet() const {
+
+    return items.size();
+}
+
+//**************************[ItemGet]******************************************
+sComPortInfo cComPortList::ItemGet(int index) const {
+
+    if ((index < 0) || (index >= items.size())) {
+        sComPortInfo temp_info;
+        temp_info.vendor_id  = -1;
+        temp_info.product_id = -1;
+        return temp_info;
+    }
+
+    return items[index];
+}
+
+//**************************[FindByName]***************************************
+int cComPortList::FindByName(std::string name) const {
+
+    for (int i = 0; i < items.size(); i++) {
+        if ((items[i].name == name) || (items[i].device == name) ||
+          (items[i].by_id == name)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+//**************************[FindBySerial]*************************************
+int cComPortList::FindBySerial(std::string serial) const {
+
+    if (serial == "") { return -1; }
+
+    for (int i = 0; i < items.size(); i++) {
+        if (items[i].serial == serial) { return i; }
+    }
+
+    return -1;
+}
+
+//**************************[OpenBySerial]*************************************
+bool cComPortList::OpenBySerial(cComPort &port, std::string serial) {
+
+    int index;
+
+    index = FindBySerial(serial);
+    if ((index >= 0) &&
+      (IdentityRead(items[index].name) != items[index].identity)) {
+        index = -1;
+    }
+    if (index < 0) {
+        if (! Update()) { return false; }
+        index = FindBySerial(serial);
+        if (index < 0) { return false; }
+    }
+
+    return port.Open(items[index].device);
+}
+
+//**************************[ItemRead]*****************************************
+bool cComPortList::ItemRead(std::string name, sComPortInfo &info) const {
+
+    std::string path;
+    std::string temp;
+    char temp_path[PATH_MAX];
+    int count;
+
+    path = "/sys/class/tty/" + name;
+
+    // skip placeholders of not existing uarts (e.g. ttyS1 .. ttyS31)
+    temp = FileRead(path + "/type");
+    if (temp == "0") { return false; }
+
+    info.name       = name;
+    info.device     = "/dev/" + name;
+    info.by_id      = "";
+    info.driver     = "";
+    info.vendor_id  = -1;
+    info.product_id = -1;
+    info.serial       = "";
+    info.manufacturer = "";
+    info.product      = "";
+    info.identity     = IdentityRead(name);
+
+    count = readlink((path + "/device/driver").data(), temp_path,
+      sizeof(temp_path) - 1);
+    if (count > 0) {
+        temp_path[count] = 0;
+        info.driver = temp_path;
+        std::string::size_type pos = info.driver.rfind('/');
+        if (pos != std::string::npos) { info.driver.erase(0, pos + 1); }
+    }
+
+    if (realpath((path + "/device").data(), temp_path) == NULL) {
+        return true;
+    }
+
+    // search the usb device within the parent directories
+    path = temp_path;
+    for (int i = 0; i < 4; i++) {
+        std::string::size_type pos = path.rfind('/');
+        if ((pos == std::string::npos) || (pos == 0)) { break; }
+
+        temp = FileRead(path + "/idVendor");
+        if (temp != "") {
+            info.vendor_id    = strtol(temp.data(), NULL, 16);
+            info.product_id   = strtol(FileRead(path + "/idProduct").data(),
+              NULL, 16);
+            info.serial       = FileRead(path + "/serial");
+            info.manufacturer = FileRead(path + "/manufacturer");
+            info.product      = FileRead(path + "/product");
+            break;
+        }
+
+        path.erase(pos);
+    }
+
+    return true;
+}
+
+//**************************[IdentityRead]*************************************
+std::string cComPortList::IdentityRead(std::string name) const {
+
+    std::string path;
+    std::string temp;
+    char temp_path[PATH_MAX];
+
+    path = "/sys/class/tty/" + name + "/device";
+    if (realpath(path.data(), temp_path) == NULL) {
+        return "";
+    }
+
+    // usb devices get a new device number on each enumeration - even if
+    // plugged into the same port again
+    path = temp_path;
+    temp = path;
+    for (int i = 0; i < 4; i++) {
+        std::string::size_type pos = path.rfind('/');
+        if ((pos == std::string::npos) || (pos == 0)) { break; }
+
+        std::string temp_devnum = FileRead(path + "/devnum");
+        if (temp_devnum != "") {
+            temp+= " " + FileRead(path + "/busnum") + ":" + temp_devnum;
+            break;
+        }
+
+        path.erase(pos);
+    }
+
+    return temp;
+}
+
+//**************************[FileRead]*****************************************
+std::string cComPortList::FileRead(std::string file_name) {
+
+    int file;
+    int count;
+    char temp_buffer[256];
+
+    file = open(file_name.data(), O_RDONLY);
+    if (file < 0) { return ""; }
+
+    count = read(file, temp_buffer, sizeof(temp_buffer));
+    close(file);
+    if (count <= 0) { return ""; }
+
+    // remove trailing newline
+    while ((count > 0) && ((temp_buffer[count - 1] == '\n') ||
+      (temp_buffer[count - 1] == ' '))) {
+        count--;
+    }
+
+    return std::string(temp_buffer, count);
+}
+
+} // namespace wepet {
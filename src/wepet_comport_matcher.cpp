@@ -0,0 +1,181 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_matcher.cpp                                                   *
+* =========================                                                   *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_matcher.h"
+
+// wepet headers
+
+// standard headers
+#include <deque>
+
+// additional headers
+
+
+
+namespace wepet {
+
+//**************************[cComPortMatcher]**********************************
+cComPortMatcher::cComPortMatcher() {
+
+    state    = 0;
+    position = 0;
+    offset   = -1;
+}
+
+//**************************[cComPortMatcher]**********************************
+cComPortMatcher::cComPortMatcher(const std::vector<std::string> &patterns) {
+
+    state    = 0;
+    position = 0;
+    offset   = -1;
+
+    Compile(patterns);
+}
+
+//**************************[Compile]******************************************
+bool cComPortMatcher::Compile(const std::vector<std::string> &patterns) {
+
+    std::vector<int> temp_fail;
+    std::deque<int> temp_queue;
+    int count;
+    int curr;
+    int next;
+    int c;
+
+    this->patterns.clear();
+    table.clear();
+    output.clear();
+    Reset();
+
+    if (patterns.empty()) { return false; }
+    for (int i = 0; i < patterns.size(); i++) {
+        if (patterns[i].empty()) { return false; }
+    }
+
+    // build the trie (-1 marks missing transitions)
+    count = 1;
+    table.assign(256, -1);
+    output.assign(1, -1);
+    for (int i = 0; i < patterns.size(); i++) {
+        curr = 0;
+        for (int j = 0; j < patterns[i].size(); j++) {
+            c = (unsigned char) patterns[i][j];
+            if (table[curr * 256 + c] < 0) {
+                table[curr * 256 + c] = count++;
+                table.resize(count * 256, -1);
+                output.push_back(-1);
+            }
+            curr = table[curr * 256 + c];
+        }
+        // duplicates keep the first index
+        if (output[curr] < 0) { output[curr] = i; }
+    }
+
+    // breadth-first search - fills the missing transitions with the ones
+    // of the failure state and inherits its output
+    temp_fail.assign(count, 0);
+    for (c = 0; c < 256; c++) {
+        next = table[c];
+        if (next < 0) {
+            table[c] = 0;
+        } else {
+            temp_queue.push_back(next);
+        }
+    }
+
+    while (! temp_queue.empty()) {
+        curr = temp_queue.front();
+        temp_queue.pop_front();
+
+        for (c = 0; c < 256; c++) {
+            next = table[curr * 256 + c];
+            if (next < 0) {
+                table[curr * 256 + c] = table[temp_fail[curr] * 256 + c];
+                continue;
+            }
+
+            temp_fail[next] = table[temp_fail[curr] * 256 + c];
+            if (output[next] < 0) {
+                output[next] = output[temp_fail[next]];
+            }
+            temp_queue.push_back(next);
+        }
+    }
+
+    this->patterns = patterns;
+    return true;
+}
+
+//**************************[PatternCountGet]**********************************
+int cComPortMatcher::PatternCountGet() const {
+
+    return patterns.size();
+}
+
+//**************************[PatternGet]***************************************
+std::string cComPortMatcher::PatternGet(int index) const {
+
+    if ((index < 0) || (index >= patterns.size())) { return ""; }
+
+    return patterns[index];
+}
+
+//**************************[Reset]********************************************
+void cComPortMatcher::Reset() {
+
+    state    = 0;
+    position = 0;
+    offset   = -1;
+}
+
+//**************************[Feed]*********************************************
+int cComPortMatcher::Feed(const char *text, int size) {
+
+    int result;
+
+    if (table.empty()) { return -1; }
+
+    for (int i = 0; i < size; i++) {
+        state = table[state * 256 + (unsigned char) text[i]];
+        result = output[state];
+        if (result >= 0) {
+            position+= i + 1;
+            offset = position - patterns[result].size();
+            return result;
+        }
+    }
+
+    position+= size;
+    return -1;
+}
+
+//**************************[Feed]*********************************************
+int cComPortMatcher::Feed(const std::string &text) {
+
+    return Feed(text.data(), text.size());
+}
+
+//**************************[PositionGet]**************************************
+int64_t cComPortMatcher::PositionGet() const {
+
+    return position;
+}
+
+//**************************[OffsetGet]****************************************
+int64_t cComPortMatcher::OffsetGet() const {
+
+    return offset;
+}
+
+} // namespace wepet {
@@ -0,0 +1,724 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_metrics.cpp                                                   *
+* =========================                                                   *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_metrics.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+
+namespace wepet {
+
+// the histogram uses the buckets of sComPortStatistic - the last one has
+// no upper bound, so it is only part of +Inf
+static const int kMetricsBuckets = 20;
+// requests are never longer (only the header is read)
+static const int kMetricsRequestMax = 8192;
+// space for the help and type lines of all metrics and for one value
+// (int64_t in seconds with a newline)
+static const int kMetricsHeaderMax = 4096;
+static const int kMetricsValueMax  = 26;
+
+// prefixes of each port
+static const int kSlotOpened         =  0;
+static const int kSlotTransmitBytes  =  1;
+static const int kSlotReceiveBytes   =  2;
+static const int kSlotTransmitErrors =  3;
+static const int kSlotReceiveErrors  =  4;
+static const int kSlotBucket         =  5; // kMetricsBuckets slots
+static const int kSlotSum            = 25;
+static const int kSlotCount          = 26;
+static const int kSlotQuantile       = 27; // 3 slots
+static const int kSlotQueuePacing    = 30;
+static const int kSlotQueueBuffer    = 31;
+static const int kSlotQueueDriverIn  = 32;
+static const int kSlotQueueDriverOut = 33;
+static const int kSlotDropped        = 34;
+static const int kSlotReconnects     = 35;
+static const int kSlotDriverErrors   = 36; // 5 slots
+static const int kSlots              = 41;
+
+static const int kQuantiles[3] = {50, 90, 99};
+
+//**************************[cComPortMetrics]**********************************
+cComPortMetrics::cComPortMetrics() {
+
+    driver = false;
+
+    text_size = 0;
+
+    scrape_time  = 0;
+    scrape_count = 0;
+}
+
+//**************************[~cComPortMetrics]*********************************
+cComPortMetrics::~cComPortMetrics() {
+
+    Close();
+}
+
+//**************************[Add]**********************************************
+void cComPortMetrics::Add(cComPort *port, std::string name) {
+
+    EntryAdd(port, NULL, name);
+}
+
+//**************************[Add]**********************************************
+void cComPortMetrics::Add(cComPortBuffer *port, std::string name) {
+
+    EntryAdd(port, port, name);
+}
+
+//**************************[Remove]*******************************************
+bool cComPortMetrics::Remove(cComPort *port) {
+
+    for (int i = 0; i < entries.size(); i++) {
+        if (entries[i].port == port) {
+            entries.erase(entries.begin() + i);
+            samples.resize(entries.size());
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//**************************[Clear]********************************************
+void cComPortMetrics::Clear() {
+
+    entries.clear();
+    samples.clear();
+}
+
+//**************************[CountGet]*****************************************
+int cComPortMetrics::CountGet() const {
+
+    return entries.size();
+}
+
+//**************************[DriverSet]****************************************
+void cComPortMetrics::DriverSet(bool enabled) {
+
+    driver = enabled;
+}
+
+//**************************[DriverGet]****************************************
+bool cComPortMetrics::DriverGet() const {
+
+    return driver;
+}
+
+//**************************[ListenUnix]***************************************
+bool cComPortMetrics::ListenUnix(std::string path) {
+
+    sockaddr_un temp_address;
+    int temp_socket;
+
+    if (path.size() >= sizeof(temp_address.sun_path)) { return false; }
+
+    temp_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+      0);
+    if (temp_socket < 0) { return false; }
+
+    memset(&temp_address, 0, sizeof(temp_address));
+    temp_address.sun_family = AF_UNIX;
+    strcpy(temp_address.sun_path, path.data());
+
+    unlink(path.data());
+    if ((bind(temp_socket, (sockaddr *) &temp_address,
+      sizeof(temp_address)) != 0) || (listen(temp_socket, 16) != 0)) {
+        close(temp_socket);
+        return false;
+    }
+
+    listeners.push_back(temp_socket);
+    listener_path = path;
+    return true;
+}
+
+//**************************[ListenTcp]****************************************
+bool cComPortMetrics::ListenTcp(int tcp_port, std::string address) {
+
+    sockaddr_in temp_address;
+    int temp_socket;
+    int temp_option;
+
+    memset(&temp_address, 0, sizeof(temp_address));
+    temp_address.sin_family = AF_INET;
+    temp_address.sin_port   = htons(tcp_port);
+    if (address == "") { address = "127.0.0.1"; }
+    if (inet_pton(AF_INET, address.data(), &temp_address.sin_addr) != 1) {
+        return false;
+    }
+
+    temp_socket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+      0);
+    if (temp_socket < 0) { return false; }
+
+    temp_option = 1;
+    setsockopt(temp_socket, SOL_SOCKET, SO_REUSEADDR, &temp_option,
+      sizeof(temp_option));
+
+    if ((bind(temp_socket, (sockaddr *) &temp_address,
+      sizeof(temp_address)) != 0) || (listen(temp_socket, 16) != 0)) {
+        close(temp_socket);
+        return false;
+    }
+
+    listeners.push_back(temp_socket);
+    return true;
+}
+
+//**************************[Close]********************************************
+void cComPortMetrics::Close() {
+
+    while (! clients.empty()) {
+        ClientRemove(clients.size() - 1);
+    }
+
+    for (int i = 0; i < listeners.size(); i++) {
+        close(listeners[i]);
+    }
+    listeners.clear();
+
+    if (listener_path != "") {
+        unlink(listener_path.data());
+        listener_path = "";
+    }
+}
+
+//**************************[Update]*******************************************
+bool cComPortMetrics::Update(int milliseconds) {
+
+    std::vector<pollfd> temp_poll;
+    int count_clients;
+    int i;
+
+    // all clients first and the listeners afterwards
+    temp_poll.resize(clients.size() + listeners.size());
+    for (i = 0; i < clients.size(); i++) {
+        temp_poll[i].fd     = clients[i].file;
+        temp_poll[i].events = POLLIN;
+        if (! clients[i].reply.empty()) {
+            temp_poll[i].events|= POLLOUT;
+        }
+    }
+    for (i = 0; i < listeners.size(); i++) {
+        temp_poll[clients.size() + i].fd     = listeners[i];
+        temp_poll[clients.size() + i].events = POLLIN;
+    }
+
+    if (temp_poll.empty()) {
+        if (milliseconds > 0) { usleep(milliseconds * 1000); }
+        return true;
+    }
+
+    if (poll(&temp_poll[0], temp_poll.size(), milliseconds) < 0) {
+        return (errno == EINTR);
+    }
+
+    // clients are closed after the reply was sent
+    count_clients = clients.size();
+    for (i = count_clients - 1; i >= 0; i--) {
+        if (temp_poll[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+            if (! ClientRead(clients[i])) {
+                ClientRemove(i);
+                continue;
+            }
+        }
+        if ((! clients[i].reply.empty()) && (! ClientWrite(clients[i]))) {
+            ClientRemove(i);
+        }
+    }
+
+    for (i = 0; i < listeners.size(); i++) {
+        if (temp_poll[count_clients + i].revents & POLLIN) {
+            ClientAccept(listeners[i]);
+        }
+    }
+
+    return true;
+}
+
+//**************************[ClientCountGet]***********************************
+int cComPortMetrics::ClientCountGet() const {
+
+    return clients.size();
+}
+
+//**************************[TextGet]******************************************
+std::string cComPortMetrics::TextGet() {
+
+    Scrape();
+    return std::string(text.begin(), text.begin() + text_size);
+}
+
+//**************************[ScrapeTimeGet]************************************
+int64_t cComPortMetrics::ScrapeTimeGet() const {
+
+    return scrape_time;
+}
+
+//**************************[ScrapeCountGet]***********************************
+int cComPortMetrics::ScrapeCountGet() const {
+
+    return scrape_count;
+}
+
+//**************************[EntryAdd]*****************************************
+void cComPortMetrics::EntryAdd(cComPort *port, cComPortBuffer *buffer,
+  const std::string &name) {
+
+    std::string label;
+    std::string extra;
+    char temp_buffer[kMetricsValueMax];
+    const char *temp_types[5] = {"frame", "parity", "overrun",
+      "buf_overrun", "break"};
+
+    if (port == NULL) { return; }
+
+    entries.push_back(sEntry());
+    sEntry &entry = entries.back();
+    entry.port     = port;
+    entry.buffer   = buffer;
+    entry.size_max = 0;
+    entry.prefixes.reserve(kSlots);
+
+    label = "{port=\"";
+    for (int i = 0; i < name.size(); i++) {
+        if (name[i] == '\n') {
+            label+= "\\n";
+            continue;
+        }
+        if ((name[i] == '\\') || (name[i] == '"')) { label+= '\\'; }
+        label+= name[i];
+    }
+    label+= '"';
+
+    // same order as the slots
+    PrefixAdd(entry, label, "wepet_comport_opened", "");
+    PrefixAdd(entry, label, "wepet_comport_transmit_bytes_total", "");
+    PrefixAdd(entry, label, "wepet_comport_receive_bytes_total", "");
+    PrefixAdd(entry, label, "wepet_comport_transmit_errors_total", "");
+    PrefixAdd(entry, label, "wepet_comport_receive_errors_total", "");
+    for (int i = 0; i < kMetricsBuckets - 1; i++) {
+        extra = ",le=\"";
+        extra.append(temp_buffer,
+          SecondsWrite(temp_buffer, (int64_t) 1 << i) - temp_buffer);
+        extra+= '"';
+        PrefixAdd(entry, label, "wepet_comport_write_duration_seconds_bucket",
+          extra);
+    }
+    PrefixAdd(entry, label, "wepet_comport_write_duration_seconds_bucket",
+      ",le=\"+Inf\"");
+    PrefixAdd(entry, label, "wepet_comport_write_duration_seconds_sum", "");
+    PrefixAdd(entry, label, "wepet_comport_write_duration_seconds_count",
+      "");
+    PrefixAdd(entry, label, "wepet_comport_write_duration_quantile_seconds",
+      ",quantile=\"0.5\"");
+    PrefixAdd(entry, label, "wepet_comport_write_duration_quantile_seconds",
+      ",quantile=\"0.9\"");
+    PrefixAdd(entry, label, "wepet_comport_write_duration_quantile_seconds",
+      ",quantile=\"0.99\"");
+    PrefixAdd(entry, label, "wepet_comport_queue_bytes", ",queue=\"pacing\"");
+    PrefixAdd(entry, label, "wepet_comport_queue_bytes", ",queue=\"buffer\"");
+    PrefixAdd(entry, label, "wepet_comport_queue_bytes",
+      ",queue=\"driver_in\"");
+    PrefixAdd(entry, label, "wepet_comport_queue_bytes",
+      ",queue=\"driver_out\"");
+    PrefixAdd(entry, label, "wepet_comport_dropped_bytes_total", "");
+    PrefixAdd(entry, label, "wepet_comport_reconnects_total", "");
+    for (int i = 0; i < 5; i++) {
+        extra = ",type=\"";
+        extra+= temp_types[i];
+        extra+= '"';
+        PrefixAdd(entry, label, "wepet_comport_driver_errors_total", extra);
+    }
+
+    samples.resize(entries.size());
+}
+
+//**************************[PrefixAdd]****************************************
+void cComPortMetrics::PrefixAdd(sEntry &entry, const std::string &label,
+  const char *name, const std::string &extra) {
+
+    entry.prefixes.push_back(name + label + extra + "} ");
+    entry.size_max+= entry.prefixes.back().size() + kMetricsValueMax;
+}
+
+//**************************[Scrape]*******************************************
+void cComPortMetrics::Scrape() {
+
+    int64_t time_start;
+
+    time_start = time_clock.TimeGet();
+    Collect();
+    Render();
+    scrape_time = time_clock.TimeGet() - time_start;
+    scrape_count++;
+}
+
+//**************************[Collect]******************************************
+void cComPortMetrics::Collect() {
+
+    // only copies the values, so the ports are not held up by formatting
+    for (int i = 0; i < entries.size(); i++) {
+        const sEntry &entry = entries[i];
+        sSample &sample = samples[i];
+
+        sample.opened = entry.port->IsOpened();
+        entry.port->StatisticGet(sample.statistic);
+        sample.queue_pacing = entry.port->TransmitPendingGet();
+
+        if (entry.buffer != NULL) {
+            sample.queue_buffer = entry.buffer->BufferCountGet();
+            sample.dropped      = entry.buffer->BufferDroppedGet();
+            sample.reconnects   = entry.buffer->ReconnectCountGet();
+        }
+
+        sample.driver           = false;
+        sample.queue_driver_in  = -1;
+        sample.queue_driver_out = -1;
+        if (driver && sample.opened) {
+            sample.driver = entry.port->CounterGet(sample.counters);
+            sample.queue_driver_in  = entry.port->HWBufferInCountGet();
+            sample.queue_driver_out = entry.port->HWBufferOutCountGet();
+        }
+    }
+}
+
+//**************************[Render]*******************************************
+void cComPortMetrics::Render() {
+
+    char *pos;
+    int size;
+    int64_t count;
+    int64_t target;
+    int i, j, k;
+
+    // the prefixes have a known size, so the text is written without any
+    // further checks
+    size = kMetricsHeaderMax;
+    for (i = 0; i < entries.size(); i++) {
+        size+= entries[i].size_max;
+    }
+    if (text.size() < size) { text.resize(size); }
+    pos = &text[0];
+
+    pos = FamilyWrite(pos, "wepet_comport_opened", "gauge",
+      "1 if the port is opened");
+    for (i = 0; i < entries.size(); i++) {
+        pos = LineWrite(pos, entries[i].prefixes[kSlotOpened],
+          samples[i].opened ? 1 : 0);
+    }
+
+    pos = FamilyWrite(pos, "wepet_comport_transmit_bytes_total", "counter",
+      "Bytes written to the port");
+    for (i = 0; i < entries.size(); i++) {
+        pos = LineWrite(pos, entries[i].prefixes[kSlotTransmitBytes],
+          samples[i].statistic.tx_bytes);
+    }
+
+    pos = FamilyWrite(pos, "wepet_comport_receive_bytes_total", "counter",
+      "Bytes read from the port");
+    for (i = 0; i < entries.size(); i++) {
+        pos = LineWrite(pos, entries[i].prefixes[kSlotReceiveBytes],
+          samples[i].statistic.rx_bytes);
+    }
+
+    pos = FamilyWrite(pos, "wepet_comport_transmit_errors_total", "counter",
+      "Failed writes (including a full output buffer)");
+    for (i = 0; i < entries.size(); i++) {
+        pos = LineWrite(pos, entries[i].prefixes[kSlotTransmitErrors],
+          samples[i].statistic.tx_errors);
+    }
+
+    pos = FamilyWrite(pos, "wepet_comport_receive_errors_total", "counter",
+      "Failed reads");
+    for (i = 0; i < entries.size(); i++) {
+        pos = LineWrite(pos, entries[i].prefixes[kSlotReceiveErrors],
+          samples[i].statistic.rx_errors);
+    }
+
+    pos = FamilyWrite(pos, "wepet_comport_write_duration_seconds",
+      "histogram", "Duration of the writes");
+    for (i = 0; i < entries.size(); i++) {
+        const std::vector<std::string> &prefixes = entries[i].prefixes;
+        const sComPortStatistic &statistic = samples[i].statistic;
+
+        // the buckets are summed up here, so +Inf matches them even if
+        // the port wrote in between
+        count = 0;
+        for (j = 0; j < kMetricsBuckets; j++) {
+            count+= statistic.latency[j];
+            pos = LineWrite(pos, prefixes[kSlotBucket + j], count);
+        }
+
+        memcpy(pos, prefixes[kSlotSum].data(), prefixes[kSlotSum].size());
+        pos = SecondsWrite(pos + prefixes[kSlotSum].size(),
+          statistic.latency_sum);
+        *pos++ = '\n';
+        pos = LineWrite(pos, prefixes[kSlotCount], count);
+    }
+
+    pos = FamilyWrite(pos, "wepet_comport_write_duration_quantile_seconds",
+      "gauge", "Quantiles of the write duration (upper bound of the bucket)");
+    for (i = 0; i < entries.size(); i++) {
+        const std::vector<std::string> &prefixes = entries[i].prefixes;
+        const sComPortStatistic &statistic = samples[i].statistic;
+
+        count = 0;
+        for (j = 0; j < kMetricsBuckets; j++) {
+            count+= statistic.latency[j];
+        }
+
+        for (k = 0; k < 3; k++) {
+            const std::string &prefix = prefixes[kSlotQuantile + k];
+
+            memcpy(pos, prefix.data(), prefix.size());
+            pos+= prefix.size();
+            if (count == 0) {
+                memcpy(pos, "NaN\n", 4);
+                pos+= 4;
+                continue;
+            }
+
+            target = (count * kQuantiles[k] + 99) / 100;
+            for (j = 0; j < kMetricsBuckets - 1; j++) {
+                target-= statistic.latency[j];
+                if (target <= 0) { break; }
+            }
+            pos = SecondsWrite(pos, (int64_t) 1 << j);
+            *pos++ = '\n';
+        }
+    }
+
+    pos = FamilyWrite(pos, "wepet_comport_queue_bytes", "gauge",
+      "Bytes waiting within the queues of the port");
+    for (i = 0; i < entries.size(); i++) {
+        const std::vector<std::string> &prefixes = entries[i].prefixes;
+        const sSample &sample = samples[i];
+
+        pos = LineWrite(pos, prefixes[kSlotQueuePacing],
+          sample.queue_pacing);
+        if (entries[i].buffer != NULL) {
+            pos = LineWrite(pos, prefixes[kSlotQueueBuffer],
+              sample.queue_buffer);
+        }
+        if (sample.queue_driver_in >= 0) {
+            pos = LineWrite(pos, prefixes[kSlotQueueDriverIn],
+              sample.queue_driver_in);
+        }
+        if (sample.queue_driver_out >= 0) {
+            pos = LineWrite(pos, prefixes[kSlotQueueDriverOut],
+              sample.queue_driver_out);
+        }
+    }
+
+    pos = FamilyWrite(pos, "wepet_comport_dropped_bytes_total", "counter",
+      "Received bytes which did not fit into the buffer");
+    for (i = 0; i < entries.size(); i++) {
+        if (entries[i].buffer == NULL) { continue; }
+        pos = LineWrite(pos, entries[i].prefixes[kSlotDropped],
+          samples[i].dropped);
+    }
+
+    pos = FamilyWrite(pos, "wepet_comport_reconnects_total", "counter",
+      "Reconnects after the device was lost");
+    for (i = 0; i < entries.size(); i++) {
+        if (entries[i].buffer == NULL) { continue; }
+        pos = LineWrite(pos, entries[i].prefixes[kSlotReconnects],
+          samples[i].reconnects);
+    }
+
+    if (driver) {
+        pos = FamilyWrite(pos, "wepet_comport_driver_errors_total",
+          "counter", "Errors counted by the kernel driver");
+        for (i = 0; i < entries.size(); i++) {
+            const std::vector<std::string> &prefixes = entries[i].prefixes;
+            const sComPortCounters &counters = samples[i].counters;
+            if (! samples[i].driver) { continue; }
+
+            pos = LineWrite(pos, prefixes[kSlotDriverErrors + 0],
+              counters.frame);
+            pos = LineWrite(pos, prefixes[kSlotDriverErrors + 1],
+              counters.parity);
+            pos = LineWrite(pos, prefixes[kSlotDriverErrors + 2],
+              counters.overrun);
+            pos = LineWrite(pos, prefixes[kSlotDriverErrors + 3],
+              counters.buf_overrun);
+            pos = LineWrite(pos, prefixes[kSlotDriverErrors + 4],
+              counters.brk);
+        }
+    }
+
+    text_size = pos - &text[0];
+}
+
+//**************************[FamilyWrite]**************************************
+char *cComPortMetrics::FamilyWrite(char *text, const char *name,
+  const char *type, const char *help) {
+
+    int size;
+
+    size = strlen(name);
+    memcpy(text, "# HELP ", 7);
+    memcpy(text + 7, name, size);
+    text+= 7 + size;
+    *text++ = ' ';
+    text = stpcpy(text, help);
+
+    memcpy(text, "\n# TYPE ", 8);
+    memcpy(text + 8, name, size);
+    text+= 8 + size;
+    *text++ = ' ';
+    text = stpcpy(text, type);
+    *text++ = '\n';
+
+    return text;
+}
+
+//**************************[LineWrite]****************************************
+char *cComPortMetrics::LineWrite(char *text, const std::string &prefix,
+  int64_t value) {
+
+    memcpy(text, prefix.data(), prefix.size());
+    text = IntegerWrite(text + prefix.size(), value);
+    *text++ = '\n';
+
+    return text;
+}
+
+//**************************[IntegerWrite]*************************************
+char *cComPortMetrics::IntegerWrite(char *text, int64_t value) {
+
+    char temp_buffer[24];
+    char *temp_pos;
+    uint64_t temp_value;
+    int size;
+
+    // written backwards from the end of the buffer
+    temp_pos = temp_buffer + sizeof(temp_buffer);
+    temp_value = (value < 0) ? - (uint64_t) value : value;
+    do {
+        *--temp_pos = '0' + temp_value % 10;
+        temp_value/= 10;
+    } while (temp_value > 0);
+    if (value < 0) { *--temp_pos = '-'; }
+
+    size = temp_buffer + sizeof(temp_buffer) - temp_pos;
+    memcpy(text, temp_pos, size);
+
+    return text + size;
+}
+
+//**************************[SecondsWrite]*************************************
+char *cComPortMetrics::SecondsWrite(char *text, int64_t microseconds) {
+
+    // avoids formatting of floating point numbers
+    text = IntegerWrite(text, microseconds);
+    if (microseconds != 0) {
+        memcpy(text, "e-06", 4);
+        text+= 4;
+    }
+
+    return text;
+}
+
+//**************************[ClientAccept]*************************************
+void cComPortMetrics::ClientAccept(int listener) {
+
+    int temp_socket;
+
+    while ((temp_socket = accept4(listener, NULL, NULL,
+      SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+
+        clients.push_back(sClient());
+        clients.back().file         = temp_socket;
+        clients.back().reply_offset = 0;
+    }
+}
+
+//**************************[ClientRead]***************************************
+bool cComPortMetrics::ClientRead(sClient &client) {
+
+    char temp_buffer[4096];
+    int count;
+
+    count = read(client.file, temp_buffer, sizeof(temp_buffer));
+    if (count == 0) { return false; }
+    if (count < 0) {
+        return ((errno == EAGAIN) || (errno == EINTR));
+    }
+
+    // anything after the request is ignored
+    if (! client.reply.empty()) { return true; }
+
+    client.request.append(temp_buffer, count);
+    if ((client.request.find("\r\n\r\n") == std::string::npos) &&
+      (client.request.find("\n\n") == std::string::npos)) {
+        return (client.request.size() < kMetricsRequestMax);
+    }
+
+    Scrape();
+    client.reply = "HTTP/1.0 200 OK\r\n"
+      "Content-Type: text/plain; version=0.0.4\r\n"
+      "Connection: close\r\n"
+      "Content-Length: ";
+    client.reply.append(temp_buffer,
+      IntegerWrite(temp_buffer, text_size) - temp_buffer);
+    client.reply+= "\r\n\r\n";
+    client.reply.append(&text[0], text_size);
+    client.reply_offset = 0;
+    client.request.clear();
+
+    return true;
+}
+
+//**************************[ClientWrite]**************************************
+bool cComPortMetrics::ClientWrite(sClient &client) {
+
+    int count;
+
+    count = write(client.file, client.reply.data() + client.reply_offset,
+      client.reply.size() - client.reply_offset);
+    if (count < 0) {
+        return ((errno == EAGAIN) || (errno == EINTR));
+    }
+
+    // the client is closed after the whole reply was sent
+    client.reply_offset+= count;
+    return (client.reply_offset < client.reply.size());
+}
+
+//**************************[ClientRemove]*************************************
+void cComPortMetrics::ClientRemove(int index) {
+
+    close(clients[index].file);
+    clients.erase(clients.begin() + index);
+}
+
+} // namespace wepet {
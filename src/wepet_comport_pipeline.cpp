@@ -0,0 +1,442 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_pipeline.cpp                                                  *
+* ==========================                                                  *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_pipeline.h"
+
+// wepet headers
+
+// standard headers
+#include <string.h>
+
+// additional headers
+#include <sched.h>
+#include <unistd.h>
+
+
+
+namespace wepet {
+
+// chunks decoded at once before a strand goes back to the queue
+static const int kPipelineBatch = 16;
+
+//**************************[cComPortPipeline]*********************************
+cComPortPipeline::cComPortPipeline() {
+
+    decoder      = NULL;
+    decoder_data = NULL;
+
+    running      = false;
+    submit_count = 0;
+    ready_count  = 0;
+    stopping     = false;
+
+    pthread_mutex_init(&control_mutex, NULL);
+    pthread_mutex_init(&strands_mutex, NULL);
+    pthread_mutex_init(&idle_mutex, NULL);
+    pthread_cond_init(&idle_cond, NULL);
+
+    memset(&statistic, 0, sizeof(statistic));
+}
+
+//**************************[~cComPortPipeline]********************************
+cComPortPipeline::~cComPortPipeline() {
+
+    std::map<int, sStrand *>::iterator it;
+
+    Stop();
+
+    for (it = strands.begin(); it != strands.end(); it++) {
+        pthread_mutex_destroy(&it->second->mutex);
+        delete it->second;
+    }
+    strands.clear();
+
+    pthread_cond_destroy(&idle_cond);
+    pthread_mutex_destroy(&idle_mutex);
+    pthread_mutex_destroy(&strands_mutex);
+    pthread_mutex_destroy(&control_mutex);
+}
+
+//**************************[DecoderSet]***************************************
+void cComPortPipeline::DecoderSet(void (*decoder)(int port_id,
+  const std::string &text, void *data), void *data) {
+
+    this->decoder = decoder;
+    decoder_data  = data;
+}
+
+//**************************[Start]********************************************
+bool cComPortPipeline::Start(int thread_count) {
+
+    sWorker *temp_worker;
+    std::map<int, sStrand *>::iterator it;
+
+    if (thread_count < 1) { thread_count = 1; }
+
+    pthread_mutex_lock(&control_mutex);
+    if (running) {
+        pthread_mutex_unlock(&control_mutex);
+        return false;
+    }
+
+    pthread_mutex_lock(&idle_mutex);
+    stopping = false;
+    pthread_mutex_unlock(&idle_mutex);
+
+    for (int i = 0; i < thread_count; i++) {
+        temp_worker = new sWorker();
+        temp_worker->pipeline = this;
+        temp_worker->index    = i;
+        pthread_mutex_init(&temp_worker->mutex, NULL);
+        workers.push_back(temp_worker);
+    }
+
+    // the home of each port depends on the number of workers
+    pthread_mutex_lock(&strands_mutex);
+    for (it = strands.begin(); it != strands.end(); it++) {
+        it->second->home = (unsigned int) it->first % thread_count;
+    }
+    pthread_mutex_unlock(&strands_mutex);
+
+    for (int i = 0; i < thread_count; i++) {
+        if (pthread_create(&workers[i]->thread, NULL, ThreadMain,
+          workers[i]) != 0) {
+            // stop the started ones
+            for (int j = i; j < thread_count; j++) {
+                pthread_mutex_destroy(&workers[j]->mutex);
+                delete workers[j];
+            }
+            workers.resize(i);
+            WorkersStop();
+            pthread_mutex_unlock(&control_mutex);
+            return false;
+        }
+    }
+
+    // submits are accepted only now
+    __atomic_store_n(&running, true, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&control_mutex);
+
+    return true;
+}
+
+//**************************[Stop]*********************************************
+void cComPortPipeline::Stop() {
+
+    pthread_mutex_lock(&control_mutex);
+    __atomic_store_n(&running, false, __ATOMIC_SEQ_CST);
+
+    // new submits fail now - wait for the running ones
+    while (__atomic_load_n(&submit_count, __ATOMIC_SEQ_CST) > 0) {
+        sched_yield();
+    }
+
+    WorkersStop();
+    pthread_mutex_unlock(&control_mutex);
+}
+
+//**************************[IsRunning]****************************************
+bool cComPortPipeline::IsRunning() const {
+
+    return __atomic_load_n(&running, __ATOMIC_ACQUIRE);
+}
+
+//**************************[Submit]*******************************************
+bool cComPortPipeline::Submit(int port_id, const std::string &text) {
+
+    sStrand *strand;
+    bool schedule;
+    int depth;
+    int peak;
+
+    if (text.empty()) { return false; }
+
+    // Stop waits until the strand is scheduled
+    __atomic_add_fetch(&submit_count, 1, __ATOMIC_SEQ_CST);
+    if (! __atomic_load_n(&running, __ATOMIC_SEQ_CST)) {
+        __atomic_sub_fetch(&submit_count, 1, __ATOMIC_SEQ_CST);
+        return false;
+    }
+
+    strand = StrandGet(port_id);
+
+    pthread_mutex_lock(&strand->mutex);
+    strand->chunks.push_back(text);
+    schedule = ! strand->scheduled;
+    strand->scheduled = true;
+    pthread_mutex_unlock(&strand->mutex);
+
+    __atomic_add_fetch(&statistic.chunks_in, 1, __ATOMIC_RELAXED);
+    depth = __atomic_add_fetch(&statistic.queue_depth, 1, __ATOMIC_RELAXED);
+    peak  = __atomic_load_n(&statistic.queue_peak, __ATOMIC_RELAXED);
+    while ((depth > peak) && (! __atomic_compare_exchange_n(
+      &statistic.queue_peak, &peak, depth, true, __ATOMIC_RELAXED,
+      __ATOMIC_RELAXED))) {
+    }
+
+    if (schedule) {
+        StrandSchedule(strand, strand->home);
+    }
+    __atomic_sub_fetch(&submit_count, 1, __ATOMIC_SEQ_CST);
+
+    return true;
+}
+
+//**************************[Submit]*******************************************
+bool cComPortPipeline::Submit(int port_id, cComPortBuffer &port) {
+
+    std::string text;
+
+    text = port.BufferGet();
+    if (text.empty()) { return false; }
+    port.BufferClear();
+
+    return Submit(port_id, text);
+}
+
+//**************************[Flush]********************************************
+bool cComPortPipeline::Flush(int milliseconds) {
+
+    int64_t time_start;
+
+    time_start = cComPort::TimeGet();
+    while ((__atomic_load_n(&statistic.queue_depth, __ATOMIC_ACQUIRE) > 0) ||
+      (__atomic_load_n(&statistic.busy, __ATOMIC_ACQUIRE) > 0)) {
+
+        if (! IsRunning()) { return false; }
+        if (cComPort::TimeGet() - time_start > (int64_t) milliseconds * 1000) {
+            return false;
+        }
+        usleep(1000);
+    }
+
+    return true;
+}
+
+//**************************[QueueDepthGet]************************************
+int cComPortPipeline::QueueDepthGet(int port_id) {
+
+    std::map<int, sStrand *>::iterator it;
+    int result;
+
+    pthread_mutex_lock(&strands_mutex);
+    it = strands.find(port_id);
+    pthread_mutex_unlock(&strands_mutex);
+    if (it == strands.end()) { return 0; }
+
+    pthread_mutex_lock(&it->second->mutex);
+    result = it->second->chunks.size();
+    pthread_mutex_unlock(&it->second->mutex);
+
+    return result;
+}
+
+//**************************[StatisticGet]*************************************
+sComPortPipelineStatistic cComPortPipeline::StatisticGet() {
+
+    sComPortPipelineStatistic result;
+
+    result.chunks_in   = __atomic_load_n(&statistic.chunks_in  ,
+      __ATOMIC_RELAXED);
+    result.chunks_out  = __atomic_load_n(&statistic.chunks_out ,
+      __ATOMIC_RELAXED);
+    result.bytes       = __atomic_load_n(&statistic.bytes      ,
+      __ATOMIC_RELAXED);
+    result.steals      = __atomic_load_n(&statistic.steals     ,
+      __ATOMIC_RELAXED);
+    result.queue_depth = __atomic_load_n(&statistic.queue_depth,
+      __ATOMIC_RELAXED);
+    result.queue_peak  = __atomic_load_n(&statistic.queue_peak ,
+      __ATOMIC_RELAXED);
+    result.ready_depth = __atomic_load_n(&ready_count, __ATOMIC_RELAXED);
+    result.busy        = __atomic_load_n(&statistic.busy       ,
+      __ATOMIC_RELAXED);
+
+    return result;
+}
+
+//**************************[StatisticReset]***********************************
+void cComPortPipeline::StatisticReset() {
+
+    __atomic_store_n(&statistic.chunks_in , 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&statistic.chunks_out, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&statistic.bytes     , 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&statistic.steals    , 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&statistic.queue_peak,
+      __atomic_load_n(&statistic.queue_depth, __ATOMIC_RELAXED),
+      __ATOMIC_RELAXED);
+}
+
+//**************************[ThreadMain]***************************************
+void *cComPortPipeline::ThreadMain(void *data) {
+
+    sWorker *worker;
+    cComPortPipeline *pipeline;
+    sStrand *strand;
+
+    worker   = (sWorker *) data;
+    pipeline = worker->pipeline;
+
+    while (true) {
+        strand = pipeline->StrandTake(worker->index);
+        if (strand != NULL) {
+            pipeline->StrandRun(strand, worker->index);
+            continue;
+        }
+
+        // sleep until there is something to do - stop only if drained
+        pthread_mutex_lock(&pipeline->idle_mutex);
+        while ((__atomic_load_n(&pipeline->ready_count, __ATOMIC_ACQUIRE)
+          == 0) && (! pipeline->stopping)) {
+            pthread_cond_wait(&pipeline->idle_cond, &pipeline->idle_mutex);
+        }
+        if (pipeline->stopping &&
+          (__atomic_load_n(&pipeline->ready_count, __ATOMIC_ACQUIRE) == 0)) {
+            pthread_mutex_unlock(&pipeline->idle_mutex);
+            break;
+        }
+        pthread_mutex_unlock(&pipeline->idle_mutex);
+    }
+
+    return NULL;
+}
+
+//**************************[WorkersStop]**************************************
+void cComPortPipeline::WorkersStop() {
+
+    pthread_mutex_lock(&idle_mutex);
+    stopping = true;
+    pthread_cond_broadcast(&idle_cond);
+    pthread_mutex_unlock(&idle_mutex);
+
+    // the others may steal from a worker until they stopped, too
+    for (int i = 0; i < workers.size(); i++) {
+        pthread_join(workers[i]->thread, NULL);
+    }
+    for (int i = 0; i < workers.size(); i++) {
+        pthread_mutex_destroy(&workers[i]->mutex);
+        delete workers[i];
+    }
+    workers.clear();
+}
+
+//**************************[StrandGet]****************************************
+cComPortPipeline::sStrand *cComPortPipeline::StrandGet(int port_id) {
+
+    std::map<int, sStrand *>::iterator it;
+    sStrand *result;
+
+    pthread_mutex_lock(&strands_mutex);
+    it = strands.find(port_id);
+    if (it != strands.end()) {
+        result = it->second;
+    } else {
+        result = new sStrand();
+        result->port_id   = port_id;
+        result->home      = (unsigned int) port_id % workers.size();
+        result->scheduled = false;
+        pthread_mutex_init(&result->mutex, NULL);
+        strands[port_id] = result;
+    }
+    pthread_mutex_unlock(&strands_mutex);
+
+    return result;
+}
+
+//**************************[StrandSchedule]***********************************
+void cComPortPipeline::StrandSchedule(sStrand *strand, int worker) {
+
+    pthread_mutex_lock(&workers[worker]->mutex);
+    workers[worker]->ready.push_back(strand);
+    pthread_mutex_unlock(&workers[worker]->mutex);
+
+    __atomic_add_fetch(&ready_count, 1, __ATOMIC_RELEASE);
+
+    pthread_mutex_lock(&idle_mutex);
+    pthread_cond_signal(&idle_cond);
+    pthread_mutex_unlock(&idle_mutex);
+}
+
+//**************************[StrandTake]***************************************
+cComPortPipeline::sStrand *cComPortPipeline::StrandTake(int worker) {
+
+    sStrand *result;
+    int index;
+
+    result = NULL;
+
+    // own queue first (oldest strand), then steal the newest of others
+    pthread_mutex_lock(&workers[worker]->mutex);
+    if (! workers[worker]->ready.empty()) {
+        result = workers[worker]->ready.front();
+        workers[worker]->ready.pop_front();
+    }
+    pthread_mutex_unlock(&workers[worker]->mutex);
+
+    for (int i = 1; (result == NULL) && (i < workers.size()); i++) {
+        index = (worker + i) % workers.size();
+        pthread_mutex_lock(&workers[index]->mutex);
+        if (! workers[index]->ready.empty()) {
+            result = workers[index]->ready.back();
+            workers[index]->ready.pop_back();
+            __atomic_add_fetch(&statistic.steals, 1, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&workers[index]->mutex);
+    }
+
+    if (result != NULL) {
+        __atomic_sub_fetch(&ready_count, 1, __ATOMIC_RELEASE);
+    }
+
+    return result;
+}
+
+//**************************[StrandRun]****************************************
+void cComPortPipeline::StrandRun(sStrand *strand, int worker) {
+
+    std::string text;
+
+    __atomic_add_fetch(&statistic.busy, 1, __ATOMIC_RELAXED);
+
+    // the strand is owned by this worker until it is unscheduled
+    for (int count = 0; ; count++) {
+        pthread_mutex_lock(&strand->mutex);
+        if (strand->chunks.empty()) {
+            strand->scheduled = false;
+            pthread_mutex_unlock(&strand->mutex);
+            break;
+        }
+        if (count >= kPipelineBatch) {
+            pthread_mutex_unlock(&strand->mutex);
+            // give other strands a chance
+            StrandSchedule(strand, worker);
+            break;
+        }
+        text.swap(strand->chunks.front());
+        strand->chunks.pop_front();
+        pthread_mutex_unlock(&strand->mutex);
+
+        if (decoder != NULL) {
+            decoder(strand->port_id, text, decoder_data);
+        }
+
+        __atomic_add_fetch(&statistic.bytes, text.size(), __ATOMIC_RELAXED);
+        __atomic_add_fetch(&statistic.chunks_out, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&statistic.queue_depth, 1, __ATOMIC_RELEASE);
+    }
+
+    __atomic_sub_fetch(&statistic.busy, 1, __ATOMIC_RELEASE);
+}
+
+} // namespace wepet {
@@ -0,0 +1,441 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_relay.cpp                                                     *
+* =======================                                                     *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_relay.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+
+// additional headers
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+
+
+namespace wepet {
+
+//**************************[cComPortRelay]************************************
+cComPortRelay::cComPortRelay() {
+
+    buffer_size = 64 * 1024;
+
+    tap_callback = NULL;
+    tap_data     = NULL;
+}
+
+//**************************[~cComPortRelay]***********************************
+cComPortRelay::~cComPortRelay() {
+
+    Clear();
+}
+
+//**************************[RouteAdd]*****************************************
+int cComPortRelay::RouteAdd(cComPort *source, cComPort *destination) {
+
+    if (destination == NULL) { return -1; }
+
+    return RouteCreate(source, destination, -1);
+}
+
+//**************************[RouteAdd]*****************************************
+int cComPortRelay::RouteAdd(cComPort *source, int file) {
+
+    if (file < 0) { return -1; }
+
+    return RouteCreate(source, NULL, file);
+}
+
+//**************************[Clear]********************************************
+void cComPortRelay::Clear() {
+
+    for (int i = 0; i < routes.size(); i++) {
+        RouteClose(routes[i]);
+    }
+    routes.clear();
+}
+
+//**************************[RouteCountGet]************************************
+int cComPortRelay::RouteCountGet() const {
+
+    return routes.size();
+}
+
+//**************************[BufferSizeSet]************************************
+void cComPortRelay::BufferSizeSet(int bytes) {
+
+    if (bytes < 1) { bytes = 1; }
+    buffer_size = bytes;
+}
+
+//**************************[BufferSizeGet]************************************
+int cComPortRelay::BufferSizeGet() const {
+
+    return buffer_size;
+}
+
+//**************************[TapSet]*******************************************
+void cComPortRelay::TapSet(void (*callback)(cComPortRelay *relay, int route,
+  const char *text, int size, void *data), void *data) {
+
+    tap_callback = callback;
+    tap_data     = data;
+
+    if (tap_callback == NULL) { return; }
+    for (int i = 0; i < routes.size(); i++) {
+        SpliceDisable(routes[i]);
+    }
+}
+
+//**************************[Update]*******************************************
+int cComPortRelay::Update(int milliseconds) {
+
+    int result;
+    int count;
+    bool busy;
+
+    // the files of the ports may change (e.g. after a reconnect)
+    poll_files.clear();
+    poll_routes.clear();
+    busy = false;
+    for (int i = 0; i < routes.size(); i++) {
+        sRoute &route = routes[i];
+        pollfd temp_poll;
+
+        route.source_file = route.source->FileGet();
+        if (route.destination != NULL) {
+            route.destination_file = route.destination->FileGet();
+        }
+
+        temp_poll.events  = 0;
+        temp_poll.revents = 0;
+        if ((route.pipe_count > 0) || (route.buffer_count > 0)) {
+            temp_poll.fd     = route.destination_file;
+            temp_poll.events = POLLOUT;
+        } else {
+            temp_poll.fd     = route.source_file;
+            temp_poll.events = POLLIN;
+        }
+
+        if (temp_poll.fd < 0) {
+            // transports without a file are checked every time
+            busy = true;
+            continue;
+        }
+        poll_files.push_back(temp_poll);
+        poll_routes.push_back(i);
+    }
+
+    if (busy && (milliseconds > 1)) { milliseconds = 1; }
+    if (poll_files.size() > 0) {
+        if (poll(&poll_files[0], poll_files.size(), milliseconds) < 0) {
+            if (errno != EINTR) { return -1; }
+            return 0;
+        }
+    } else if (milliseconds > 0) {
+        usleep(milliseconds * 1000);
+    }
+
+    result = 0;
+    for (int i = 0, j = 0; i < routes.size(); i++) {
+        sRoute &route = routes[i];
+
+        if ((j < poll_routes.size()) && (poll_routes[j] == i)) {
+            short temp_events = poll_files[j++].revents;
+            if (temp_events == 0) { continue; }
+            if (temp_events & POLLNVAL) { return -1; }
+        }
+
+        if ((route.pipe_count == 0) && (route.buffer_count == 0)) {
+            count = RouteRead(i);
+            if (count < 0) { return -1; }
+            if (count == 0) { continue; }
+        }
+
+        // writing directly after reading keeps the latency low
+        count = RouteWrite(i);
+        if (count < 0) { return -1; }
+        result+= count;
+    }
+
+    return result;
+}
+
+//**************************[SpliceGet]****************************************
+bool cComPortRelay::SpliceGet(int route) const {
+
+    if ((route < 0) || (route >= routes.size())) { return false; }
+
+    return routes[route].pipe_files[0] >= 0;
+}
+
+//**************************[StatisticGet]*************************************
+bool cComPortRelay::StatisticGet(int route,
+  sComPortRelayStatistic &statistic) const {
+
+    int64_t time_elapsed;
+
+    if ((route < 0) || (route >= routes.size())) { return false; }
+    const sRoute &temp_route = routes[route];
+
+    statistic.bytes       = temp_route.bytes;
+    statistic.chunks      = temp_route.chunks;
+    statistic.spliced     = temp_route.spliced;
+    statistic.latency_max = temp_route.latency_max;
+
+    statistic.latency_average = 0;
+    if (temp_route.chunks > 0) {
+        statistic.latency_average = temp_route.latency_sum /
+          temp_route.chunks;
+    }
+
+    statistic.throughput = 0;
+    time_elapsed = cComPort::TimeGet() - temp_route.start_time;
+    if (time_elapsed > 0) {
+        statistic.throughput = temp_route.bytes * 1000000 / time_elapsed;
+    }
+
+    return true;
+}
+
+//**************************[StatisticReset]***********************************
+void cComPortRelay::StatisticReset() {
+
+    for (int i = 0; i < routes.size(); i++) {
+        sRoute &route = routes[i];
+
+        route.start_time  = cComPort::TimeGet();
+        route.bytes       = 0;
+        route.chunks      = 0;
+        route.spliced     = 0;
+        route.latency_sum = 0;
+        route.latency_max = 0;
+    }
+}
+
+//**************************[RouteCreate]**************************************
+int cComPortRelay::RouteCreate(cComPort *source, cComPort *destination,
+  int file) {
+
+    sRoute route;
+
+    if (source == NULL) { return -1; }
+
+    route.source           = source;
+    route.destination      = destination;
+    route.source_file      = source->FileGet();
+    route.destination_file = file;
+    if (destination != NULL) {
+        route.destination_file = destination->FileGet();
+    }
+
+    // the pipe is only useful if both sides have a file
+    route.pipe_files[0] = -1;
+    route.pipe_files[1] = -1;
+    route.pipe_count    = 0;
+    if ((tap_callback == NULL) && (route.source_file >= 0) &&
+      (route.destination_file >= 0)) {
+        if (pipe2(route.pipe_files, O_NONBLOCK | O_CLOEXEC) == 0) {
+            // the pipe may be larger (at least one page)
+            fcntl(route.pipe_files[0], F_SETPIPE_SZ, buffer_size);
+        } else {
+            route.pipe_files[0] = -1;
+            route.pipe_files[1] = -1;
+        }
+    }
+
+    route.buffer.resize(buffer_size);
+    route.buffer_start = 0;
+    route.buffer_count = 0;
+
+    route.read_time   = 0;
+    route.start_time  = cComPort::TimeGet();
+    route.bytes       = 0;
+    route.chunks      = 0;
+    route.spliced     = 0;
+    route.latency_sum = 0;
+    route.latency_max = 0;
+
+    routes.push_back(route);
+    return routes.size() - 1;
+}
+
+//**************************[RouteClose]***************************************
+void cComPortRelay::RouteClose(sRoute &route) {
+
+    if (route.pipe_files[0] >= 0) { close(route.pipe_files[0]); }
+    if (route.pipe_files[1] >= 0) { close(route.pipe_files[1]); }
+
+    route.pipe_files[0] = -1;
+    route.pipe_files[1] = -1;
+    route.pipe_count    = 0;
+}
+
+//**************************[SpliceDisable]************************************
+void cComPortRelay::SpliceDisable(sRoute &route) {
+
+    int count;
+
+    if (route.pipe_files[0] < 0) { return; }
+
+    // data within the pipe is moved to the (empty) buffer
+    if (route.pipe_count > 0) {
+        count = read(route.pipe_files[0], &route.buffer[0],
+          route.buffer.size());
+        if (count < 0) { count = 0; }
+        route.buffer_start = 0;
+        route.buffer_count = count;
+    }
+
+    RouteClose(route);
+}
+
+//**************************[RouteRead]****************************************
+int cComPortRelay::RouteRead(int index) {
+
+    sRoute &route = routes[index];
+    int count;
+
+    if (route.pipe_files[0] >= 0) {
+        count = splice(route.source_file, NULL, route.pipe_files[1], NULL,
+          route.buffer.size(), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (count > 0) {
+            route.source->StatisticRead(count);
+            route.read_time  = cComPort::TimeGet();
+            route.pipe_count = count;
+            return count;
+        }
+        if (count == 0) { return -1; }
+        if (errno == EAGAIN) { return 0; }
+        if (errno != EINVAL) {
+            route.source->StatisticRead(-1);
+            return -1;
+        }
+
+        // this file can not be spliced - using the buffer from now on
+        SpliceDisable(route);
+    }
+
+    if (route.source_file >= 0) {
+        count = read(route.source_file, &route.buffer[0],
+          route.buffer.size());
+        if (count == 0) { return -1; }
+        if (count < 0) {
+            if (errno == EAGAIN) { return 0; }
+            route.source->StatisticRead(-1);
+            return -1;
+        }
+        route.source->StatisticRead(count);
+    } else {
+        std::string temp_text;
+
+        temp_text = route.source->Receive(route.buffer.size());
+        count = temp_text.size();
+        if (count == 0) { return 0; }
+        memcpy(&route.buffer[0], temp_text.data(), count);
+    }
+
+    route.read_time    = cComPort::TimeGet();
+    route.buffer_start = 0;
+    route.buffer_count = count;
+
+    if (tap_callback != NULL) {
+        tap_callback(this, index, &route.buffer[0], count, tap_data);
+    }
+
+    return count;
+}
+
+//**************************[RouteWrite]***************************************
+int cComPortRelay::RouteWrite(int index) {
+
+    sRoute &route = routes[index];
+    int64_t time_start;
+    int count;
+
+    if (route.pipe_count > 0) {
+        time_start = cComPort::TimeGet();
+        count = splice(route.pipe_files[0], NULL, route.destination_file,
+          NULL, route.pipe_count, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        // files, which can not be spliced, are not counted
+        if ((route.destination != NULL) && ((count >= 0) ||
+          (errno != EINVAL))) {
+            route.destination->StatisticWrite(count,
+              cComPort::TimeGet() - time_start);
+        }
+        if (count > 0) {
+            route.pipe_count-= count;
+            route.bytes     += count;
+            route.spliced   += count;
+            if (route.pipe_count == 0) { RouteDone(route); }
+            return count;
+        }
+        if (count == 0) { return 0; }
+        if (errno == EAGAIN) { return 0; }
+        if (errno != EINVAL) { return -1; }
+
+        // this file can not be spliced - using the buffer from now on
+        SpliceDisable(route);
+    }
+
+    if (route.buffer_count <= 0) { return 0; }
+
+    if (route.destination_file >= 0) {
+        time_start = cComPort::TimeGet();
+        count = write(route.destination_file,
+          &route.buffer[route.buffer_start], route.buffer_count);
+        if (route.destination != NULL) {
+            route.destination->StatisticWrite(count,
+              cComPort::TimeGet() - time_start);
+        }
+        if (count < 0) {
+            if (errno == EAGAIN) { return 0; }
+            return -1;
+        }
+    } else {
+        if (! route.destination->Transmit(std::string(
+          &route.buffer[route.buffer_start], route.buffer_count))) {
+            return -1;
+        }
+        count = route.buffer_count;
+    }
+
+    route.buffer_start+= count;
+    route.buffer_count-= count;
+    route.bytes       += count;
+    if (route.buffer_count == 0) {
+        route.buffer_start = 0;
+        RouteDone(route);
+    }
+
+    return count;
+}
+
+//**************************[RouteDone]****************************************
+void cComPortRelay::RouteDone(sRoute &route) {
+
+    int64_t latency;
+
+    latency = cComPort::TimeGet() - route.read_time;
+    if (latency < 0) { latency = 0; }
+
+    route.chunks++;
+    route.latency_sum+= latency;
+    if (route.latency_max < latency) { route.latency_max = latency; }
+}
+
+} // namespace wepet {
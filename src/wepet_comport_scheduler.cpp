@@ -0,0 +1,342 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_scheduler.cpp                                                 *
+* ===========================                                                 *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_scheduler.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+
+
+
+namespace wepet {
+
+//**************************[cComPortScheduler]********************************
+cComPortScheduler::cComPortScheduler() {
+
+    port = NULL;
+    class_next = 0;
+    class_rest = -1;
+
+    chunk_size  = 256;
+    queue_depth = 256;
+
+    ClassCountSet(4);
+}
+
+//**************************[~cComPortScheduler]*******************************
+cComPortScheduler::~cComPortScheduler() {
+
+}
+
+//**************************[PortSet]******************************************
+void cComPortScheduler::PortSet(cComPort *port) {
+
+    this->port = port;
+}
+
+//**************************[PortGet]******************************************
+cComPort *cComPortScheduler::PortGet() const {
+
+    return port;
+}
+
+//**************************[ClassCountSet]************************************
+bool cComPortScheduler::ClassCountSet(int count) {
+
+    if (count < 1) { return false; }
+
+    // classes can only be removed if they are empty
+    for (int i = count; i < classes.size(); i++) {
+        if (! classes[i].frames.empty()) { return false; }
+    }
+
+    int count_old = classes.size();
+    classes.resize(count);
+    for (int i = count_old; i < count; i++) {
+        classes[i].pending = 0;
+        classes[i].share   = 0;
+        classes[i].deficit = 0;
+    }
+    StatisticReset();
+
+    class_next = 0;
+    return true;
+}
+
+//**************************[ClassCountGet]************************************
+int cComPortScheduler::ClassCountGet() const {
+
+    return classes.size();
+}
+
+//**************************[ClassShareSet]************************************
+bool cComPortScheduler::ClassShareSet(int priority, int share) {
+
+    if ((priority < 0) || (priority >= classes.size())) { return false; }
+    if (share < 0) { return false; }
+
+    classes[priority].share   = share;
+    classes[priority].deficit = 0;
+    return true;
+}
+
+//**************************[ClassShareGet]************************************
+int cComPortScheduler::ClassShareGet(int priority) const {
+
+    if ((priority < 0) || (priority >= classes.size())) { return -1; }
+
+    return classes[priority].share;
+}
+
+//**************************[ChunkSizeSet]*************************************
+void cComPortScheduler::ChunkSizeSet(int bytes) {
+
+    if (bytes < 1) { bytes = 1; }
+
+    chunk_size = bytes;
+}
+
+//**************************[ChunkSizeGet]*************************************
+int cComPortScheduler::ChunkSizeGet() const {
+
+    return chunk_size;
+}
+
+//**************************[QueueDepthSet]************************************
+void cComPortScheduler::QueueDepthSet(int bytes) {
+
+    if (bytes < 1) { bytes = 1; }
+
+    queue_depth = bytes;
+}
+
+//**************************[QueueDepthGet]************************************
+int cComPortScheduler::QueueDepthGet() const {
+
+    return queue_depth;
+}
+
+//**************************[Transmit]*****************************************
+bool cComPortScheduler::Transmit(std::string frame, int priority) {
+
+    if ((priority < 0) || (priority >= classes.size())) { return false; }
+    if (frame.empty()) { return true; }
+
+    sClass &temp_class = classes[priority];
+
+    temp_class.frames.push_back(sFrame());
+    temp_class.frames.back().data.swap(frame);
+    temp_class.frames.back().time = cComPort::TimeGet();
+    temp_class.frames.back().rest = false;
+    temp_class.pending+= temp_class.frames.back().data.size();
+
+    return true;
+}
+
+//**************************[TransmitSplit]************************************
+bool cComPortScheduler::TransmitSplit(std::string data, int priority,
+  int frame_size) {
+
+    if ((priority < 0) || (priority >= classes.size())) { return false; }
+    if (frame_size < 1) { return false; }
+
+    for (int pos = 0; pos < data.size(); pos+= frame_size) {
+        Transmit(data.substr(pos, frame_size), priority);
+    }
+
+    return true;
+}
+
+//**************************[Update]*******************************************
+bool cComPortScheduler::Update() {
+
+    int count_out;
+    int count_max;
+    int count_written;
+    int count;
+    bool result;
+    int priority;
+    int64_t time_curr;
+    std::string chunk;
+
+    if ((port == NULL) || (! port->IsOpened())) { return false; }
+
+    // at most queue_depth bytes per update - even if the output buffer
+    // of the port can not be measured or does not seem to fill up
+    count_written = 0;
+    while (true) {
+        count_out = port->HWBufferOutCountGet();
+        if (count_out < 0) { count_out = 0; }
+        if (count_out < count_written) { count_out = count_written; }
+
+        count_max = queue_depth - count_out;
+        if (count_max > chunk_size) { count_max = chunk_size; }
+        if (count_max <= 0) { return true; }
+
+        // a partly written chunk is completed first - otherwise another
+        // frame would be inserted into a frame on the line
+        if (class_rest >= 0) {
+            priority = class_rest;
+        } else {
+            priority = ClassSelect();
+        }
+        if (priority < 0) { return true; }
+
+        sClass &temp_class = classes[priority];
+
+        // large frames are only sent if the output buffer is empty
+        if ((temp_class.frames.front().data.size() > count_max) &&
+          (count_out != 0) && (count_max < chunk_size) &&
+          (class_rest < 0)) {
+            return true;
+        }
+
+        time_curr = cComPort::TimeGet();
+        chunk.clear();
+        do {
+            sFrame &temp_frame = temp_class.frames.front();
+
+            if (! temp_frame.rest) {
+                int64_t delay = time_curr - temp_frame.time;
+                temp_class.statistic.frames++;
+                temp_class.statistic.bytes+= temp_frame.data.size();
+                temp_class.statistic.delay_sum+= delay;
+                temp_class.statistic.delay_last = delay;
+                if (temp_class.statistic.delay_max < delay) {
+                    temp_class.statistic.delay_max = delay;
+                }
+            }
+
+            chunk.append(temp_frame.data);
+            temp_class.frames.pop_front();
+        } while ((! temp_class.frames.empty()) && (chunk.size() +
+          temp_class.frames.front().data.size() <= count_max));
+
+        // the output buffer is managed here - so skip the pacing of port
+        result = port->TransmitUrgent(chunk, count);
+
+        temp_class.pending-= count;
+        if (temp_class.share > 0) {
+            temp_class.deficit-= count;
+        }
+        count_written+= count;
+
+        // the rest stays at the head of its class for the next update
+        class_rest = -1;
+        if (count < chunk.size()) {
+            temp_class.frames.push_front(sFrame());
+            temp_class.frames.front().data.assign(chunk, count,
+              std::string::npos);
+            temp_class.frames.front().time = time_curr;
+            temp_class.frames.front().rest = true;
+            class_rest = priority;
+
+            return result;
+        }
+    }
+}
+
+//**************************[PendingGet]***************************************
+int cComPortScheduler::PendingGet(int priority) const {
+
+    if ((priority < 0) || (priority >= classes.size())) { return -1; }
+
+    return classes[priority].pending;
+}
+
+//**************************[PendingClear]*************************************
+void cComPortScheduler::PendingClear(int priority) {
+
+    if ((priority < 0) || (priority >= classes.size())) { return; }
+
+    if (class_rest == priority) { class_rest = -1; }
+    classes[priority].frames.clear();
+    classes[priority].pending = 0;
+    classes[priority].deficit = 0;
+}
+
+//**************************[StatisticGet]*************************************
+bool cComPortScheduler::StatisticGet(int priority,
+  sComPortSchedulerStatistic &statistic) const {
+
+    if ((priority < 0) || (priority >= classes.size())) { return false; }
+
+    statistic = classes[priority].statistic;
+    return true;
+}
+
+//**************************[StatisticReset]***********************************
+void cComPortScheduler::StatisticReset() {
+
+    for (int i = 0; i < classes.size(); i++) {
+        classes[i].statistic.frames     = 0;
+        classes[i].statistic.bytes      = 0;
+        classes[i].statistic.delay_sum  = 0;
+        classes[i].statistic.delay_max  = 0;
+        classes[i].statistic.delay_last = 0;
+    }
+}
+
+//**************************[ClassSelect]**************************************
+int cComPortScheduler::ClassSelect() {
+
+    int i;
+    bool pending;
+
+    // strict priority classes first
+    for (i = 0; i < classes.size(); i++) {
+        if ((classes[i].share == 0) && (! classes[i].frames.empty())) {
+            return i;
+        }
+    }
+
+    // deficit round robin for all other classes
+    pending = false;
+    for (i = 0; i < classes.size(); i++) {
+        if (classes[i].frames.empty()) {
+            classes[i].deficit = 0;
+        } else {
+            pending = true;
+        }
+    }
+    if (! pending) { return -1; }
+
+    while (true) {
+        for (i = 0; i < classes.size(); i++) {
+            int index = (class_next + i) % classes.size();
+            if ((classes[index].frames.empty()) ||
+              (classes[index].deficit <= 0)) {
+                continue;
+            }
+
+            class_next = index;
+            return index;
+        }
+
+        // each pending class gets its quantum for the next round
+        for (i = 0; i < classes.size(); i++) {
+            if (classes[i].frames.empty()) { continue; }
+
+            int quantum = chunk_size * classes[i].share / 100;
+            if (quantum < 1) { quantum = 1; }
+            classes[i].deficit+= quantum;
+        }
+        class_next = (class_next + 1) % classes.size();
+    }
+}
+
+} // namespace wepet {
@@ -0,0 +1,664 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_server.cpp                                                    *
+* ========================                                                    *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_server.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+
+namespace wepet {
+
+// telnet (rfc 854) and com port control option (rfc 2217)
+static const unsigned char kTelnetSe   = 240;
+static const unsigned char kTelnetSb   = 250;
+static const unsigned char kTelnetWill = 251;
+static const unsigned char kTelnetWont = 252;
+static const unsigned char kTelnetDo   = 253;
+static const unsigned char kTelnetDont = 254;
+static const unsigned char kTelnetIac  = 255;
+
+static const unsigned char kTelnetOptionBinary  =  0;
+static const unsigned char kTelnetOptionSga     =  3;
+static const unsigned char kTelnetOptionComPort = 44;
+
+// parser states besides the verbs (will, wont, do, dont)
+static const int kTelnetStateData   = 0;
+static const int kTelnetStateIac    = 1;
+static const int kTelnetStateSub    = 2;
+static const int kTelnetStateSubIac = 3;
+
+//**************************[cComPortServer]***********************************
+cComPortServer::cComPortServer() {
+
+    client_next = 0;
+
+    buffer_start = 0;
+    buffer_size  = 1024 * 1024;
+
+    write_mode    = kCpServerWriteAll;
+    write_owner   = -1;
+    write_time    = 0;
+    write_idle    = 1000;
+    write_dropped = 0;
+
+    rfc2217 = false;
+}
+
+//**************************[~cComPortServer]**********************************
+cComPortServer::~cComPortServer() {
+
+    Close();
+}
+
+//**************************[PortGet]******************************************
+cComPort &cComPortServer::PortGet() {
+
+    return port;
+}
+
+//**************************[ListenUnix]***************************************
+bool cComPortServer::ListenUnix(std::string path) {
+
+    sockaddr_un temp_address;
+    int temp_socket;
+
+    if (path.size() >= sizeof(temp_address.sun_path)) { return false; }
+
+    temp_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+      0);
+    if (temp_socket < 0) { return false; }
+
+    memset(&temp_address, 0, sizeof(temp_address));
+    temp_address.sun_family = AF_UNIX;
+    strcpy(temp_address.sun_path, path.data());
+
+    unlink(path.data());
+    if ((bind(temp_socket, (sockaddr *) &temp_address,
+      sizeof(temp_address)) != 0) || (listen(temp_socket, 16) != 0)) {
+        close(temp_socket);
+        return false;
+    }
+
+    listeners.push_back(temp_socket);
+    listener_path = path;
+    return true;
+}
+
+//**************************[ListenTcp]****************************************
+bool cComPortServer::ListenTcp(int tcp_port, std::string address) {
+
+    sockaddr_in temp_address;
+    int temp_socket;
+    int temp_option;
+
+    memset(&temp_address, 0, sizeof(temp_address));
+    temp_address.sin_family = AF_INET;
+    temp_address.sin_port   = htons(tcp_port);
+    if (address == "") { address = "127.0.0.1"; }
+    if (inet_pton(AF_INET, address.data(), &temp_address.sin_addr) != 1) {
+        return false;
+    }
+
+    temp_socket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+      0);
+    if (temp_socket < 0) { return false; }
+
+    temp_option = 1;
+    setsockopt(temp_socket, SOL_SOCKET, SO_REUSEADDR, &temp_option,
+      sizeof(temp_option));
+
+    if ((bind(temp_socket, (sockaddr *) &temp_address,
+      sizeof(temp_address)) != 0) || (listen(temp_socket, 16) != 0)) {
+        close(temp_socket);
+        return false;
+    }
+
+    listeners.push_back(temp_socket);
+    return true;
+}
+
+//**************************[Close]********************************************
+void cComPortServer::Close() {
+
+    while (! clients.empty()) {
+        ClientRemove(clients.size() - 1);
+    }
+
+    for (int i = 0; i < listeners.size(); i++) {
+        close(listeners[i]);
+    }
+    listeners.clear();
+
+    if (listener_path != "") {
+        unlink(listener_path.data());
+        listener_path = "";
+    }
+
+    buffer_start+= buffer.size();
+    buffer.clear();
+}
+
+//**************************[Update]*******************************************
+bool cComPortServer::Update(int milliseconds) {
+
+    std::vector<pollfd> temp_poll;
+    int64_t buffer_end;
+    int64_t position_min;
+    int count_clients;
+    int i;
+
+    // port first, then all clients and at last the listeners
+    temp_poll.resize(1 + clients.size() + listeners.size());
+    temp_poll[0].fd     = port.IsOpened() ? port.FileGet() : -1;
+    temp_poll[0].events = POLLIN;
+
+    buffer_end = buffer_start + buffer.size();
+    for (i = 0; i < clients.size(); i++) {
+        temp_poll[1 + i].fd     = clients[i].file;
+        temp_poll[1 + i].events = 0;
+        // clients with pending data wait for the port instead
+        if (clients[i].pending.empty()) {
+            temp_poll[1 + i].events = POLLIN;
+        } else {
+            temp_poll[0].events|= POLLOUT;
+        }
+        if ((clients[i].position < buffer_end) ||
+          (! clients[i].reply.empty())) {
+            temp_poll[1 + i].events|= POLLOUT;
+        }
+    }
+    for (i = 0; i < listeners.size(); i++) {
+        temp_poll[1 + clients.size() + i].fd     = listeners[i];
+        temp_poll[1 + clients.size() + i].events = POLLIN;
+    }
+
+    // transports without file are polled every millisecond
+    if (port.IsOpened() && (temp_poll[0].fd < 0) && (milliseconds > 1)) {
+        milliseconds = 1;
+    }
+
+    if (poll(&temp_poll[0], temp_poll.size(), milliseconds) < 0) {
+        return (errno == EINTR);
+    }
+
+    if (port.IsOpened() && ((temp_poll[0].fd < 0) ||
+      (temp_poll[0].revents & POLLIN))) {
+        BufferAppend(port.Receive());
+    }
+
+    // a hung up port signals POLLHUP forever - so it is closed (after the
+    // remaining data was read) instead of polling it again
+    if (port.IsOpened() && (temp_poll[0].fd >= 0) &&
+      (temp_poll[0].revents & (POLLHUP | POLLERR | POLLNVAL))) {
+        BufferAppend(port.Receive());
+        port.Close();
+    }
+
+    // pending data is written in the order of the clients until the port
+    // is full (a closed port discards it)
+    if ((temp_poll[0].fd < 0) || (temp_poll[0].revents & POLLOUT)) {
+        for (i = 0; i < clients.size(); i++) {
+            if (! ClientTransmit(clients[i])) { break; }
+        }
+    }
+
+    count_clients = clients.size();
+    for (i = count_clients - 1; i >= 0; i--) {
+        if (! clients[i].pending.empty()) {
+            if (temp_poll[1 + i].revents & (POLLHUP | POLLERR)) {
+                ClientRemove(i);
+            }
+            continue;
+        }
+        if (temp_poll[1 + i].revents & (POLLIN | POLLHUP | POLLERR)) {
+            if (! ClientRead(clients[i])) {
+                ClientRemove(i);
+            }
+        }
+    }
+
+    for (i = 0; i < listeners.size(); i++) {
+        if (temp_poll[1 + count_clients + i].revents & POLLIN) {
+            ClientAccept(listeners[i]);
+        }
+    }
+
+    // send new data and drop clients which fell behind
+    buffer_end = buffer_start + buffer.size();
+    position_min = buffer_end;
+    for (i = clients.size() - 1; i >= 0; i--) {
+        if ((! ClientWrite(clients[i])) ||
+          (buffer_end - clients[i].position > buffer_size)) {
+            ClientRemove(i);
+            continue;
+        }
+        if (position_min > clients[i].position) {
+            position_min = clients[i].position;
+        }
+    }
+
+    // only move the data from time to time
+    if (position_min == buffer_end) {
+        buffer_start = buffer_end;
+        buffer.clear();
+    } else if (position_min - buffer_start > 65536) {
+        buffer.erase(0, position_min - buffer_start);
+        buffer_start = position_min;
+    }
+
+    return true;
+}
+
+//**************************[ClientCountGet]***********************************
+int cComPortServer::ClientCountGet() const {
+
+    return clients.size();
+}
+
+//**************************[BufferSizeSet]************************************
+void cComPortServer::BufferSizeSet(int bytes) {
+
+    if (bytes < 1024) { bytes = 1024; }
+
+    buffer_size = bytes;
+}
+
+//**************************[BufferSizeGet]************************************
+int cComPortServer::BufferSizeGet() const {
+
+    return buffer_size;
+}
+
+//**************************[WriteModeSet]*************************************
+void cComPortServer::WriteModeSet(eComPortServerWrite mode) {
+
+    write_mode  = mode;
+    write_owner = -1;
+}
+
+//**************************[WriteModeGet]*************************************
+eComPortServerWrite cComPortServer::WriteModeGet() const {
+
+    return write_mode;
+}
+
+//**************************[WriteIdleSet]*************************************
+void cComPortServer::WriteIdleSet(int milliseconds) {
+
+    if (milliseconds < 0) { milliseconds = 0; }
+
+    write_idle = milliseconds;
+}
+
+//**************************[WriteDroppedGet]**********************************
+int cComPortServer::WriteDroppedGet() const {
+
+    return write_dropped;
+}
+
+//**************************[Rfc2217Set]***************************************
+void cComPortServer::Rfc2217Set(bool enabled) {
+
+    rfc2217 = enabled;
+}
+
+//**************************[Rfc2217Get]***************************************
+bool cComPortServer::Rfc2217Get() const {
+
+    return rfc2217;
+}
+
+//**************************[ClientAccept]*************************************
+void cComPortServer::ClientAccept(int listener) {
+
+    int temp_socket;
+
+    while ((temp_socket = accept4(listener, NULL, NULL,
+      SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+
+        // new clients only receive new data
+        clients.push_back(sClient());
+        clients.back().id           = client_next;
+        clients.back().file         = temp_socket;
+        clients.back().position     = buffer_start + buffer.size();
+        clients.back().telnet_state = kTelnetStateData;
+
+        // ids are only compared - an overflow would just restart them
+        client_next = (client_next < 0x7FFFFFFF) ? client_next + 1 : 0;
+    }
+}
+
+//**************************[ClientRead]***************************************
+bool cComPortServer::ClientRead(sClient &client) {
+
+    char temp_buffer[4096];
+    std::string data;
+    int count;
+    int64_t time_curr;
+
+    count = read(client.file, temp_buffer, sizeof(temp_buffer));
+    if (count == 0) { return false; }
+    if (count < 0) {
+        return ((errno == EAGAIN) || (errno == EINTR));
+    }
+
+    if (rfc2217) {
+        data = TelnetParse(client, temp_buffer, count);
+    } else {
+        data.assign(temp_buffer, count);
+    }
+    if (data.empty()) { return true; }
+
+    switch (write_mode) {
+        case (kCpServerWriteNone)  :
+            write_dropped+= data.size();
+            return true;
+
+        case (kCpServerWriteFirst) :
+            time_curr = cComPort::TimeGet();
+            if ((write_owner >= 0) && (write_owner != client.id) &&
+              (time_curr - write_time < (int64_t) write_idle * 1000)) {
+                write_dropped+= data.size();
+                return true;
+            }
+            write_owner = client.id;
+            write_time  = time_curr;
+            break;
+
+        default                    :
+            break;
+    }
+
+    client.pending = data;
+    ClientTransmit(client);
+
+    return true;
+}
+
+//**************************[ClientWrite]**************************************
+bool cComPortServer::ClientWrite(sClient &client) {
+
+    int count;
+
+    // replies to rfc2217 commands go first
+    if (! client.reply.empty()) {
+        count = send(client.file, client.reply.data(), client.reply.size(),
+          MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (count < 0) {
+            return ((errno == EAGAIN) || (errno == EINTR));
+        }
+        client.reply.erase(0, count);
+        if (! client.reply.empty()) { return true; }
+    }
+
+    count = buffer_start + buffer.size() - client.position;
+    if (count <= 0) { return true; }
+
+    count = send(client.file, buffer.data() + (client.position - buffer_start),
+      count, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (count < 0) {
+        return ((errno == EAGAIN) || (errno == EINTR));
+    }
+    client.position+= count;
+
+    return true;
+}
+
+//**************************[ClientTransmit]***********************************
+// returns false if the port took not all pending data
+bool cComPortServer::ClientTransmit(sClient &client) {
+
+    int count;
+
+    if (client.pending.empty()) { return true; }
+
+    if (! port.TransmitUrgent(client.pending, count)) {
+        write_dropped+= client.pending.size();
+        client.pending.clear();
+        return true;
+    }
+    client.pending.erase(0, count);
+
+    return client.pending.empty();
+}
+
+//**************************[ClientRemove]*************************************
+void cComPortServer::ClientRemove(int index) {
+
+    if ((index < 0) || (index >= clients.size())) { return; }
+
+    write_dropped+= clients[index].pending.size();
+
+    if (write_owner == clients[index].id) {
+        write_owner = -1;
+    }
+
+    close(clients[index].file);
+    clients.erase(clients.begin() + index);
+}
+
+//**************************[TelnetParse]**************************************
+std::string cComPortServer::TelnetParse(sClient &client, const char *data,
+  int size) {
+
+    std::string result;
+    unsigned char temp;
+
+    for (int i = 0; i < size; i++) {
+        temp = data[i];
+
+        switch (client.telnet_state) {
+            case (kTelnetStateData)   :
+                if (temp == kTelnetIac) {
+                    client.telnet_state = kTelnetStateIac;
+                } else {
+                    result+= (char) temp;
+                }
+                break;
+
+            case (kTelnetStateIac)    :
+                if (temp == kTelnetIac) {
+                    result+= (char) temp;
+                    client.telnet_state = kTelnetStateData;
+                } else if (temp == kTelnetSb) {
+                    client.telnet_sub.clear();
+                    client.telnet_state = kTelnetStateSub;
+                } else if ((temp >= kTelnetWill) && (temp <= kTelnetDont)) {
+                    client.telnet_state = temp;
+                } else {
+                    client.telnet_state = kTelnetStateData;
+                }
+                break;
+
+            case (kTelnetStateSub)    :
+                if (temp == kTelnetIac) {
+                    client.telnet_state = kTelnetStateSubIac;
+                } else {
+                    client.telnet_sub+= (char) temp;
+                }
+                break;
+
+            case (kTelnetStateSubIac) :
+                if (temp == kTelnetSe) {
+                    TelnetCommand(client);
+                    client.telnet_state = kTelnetStateData;
+                } else {
+                    client.telnet_sub+= (char) temp;
+                    client.telnet_state = kTelnetStateSub;
+                }
+                break;
+
+            default                   :
+                // answer option negotiation (binary, sga and com port)
+                client.reply+= (char) kTelnetIac;
+                if (client.telnet_state == kTelnetDo) {
+                    if ((temp == kTelnetOptionBinary) ||
+                      (temp == kTelnetOptionSga)) {
+                        client.reply+= (char) kTelnetWill;
+                    } else {
+                        client.reply+= (char) kTelnetWont;
+                    }
+                } else if (client.telnet_state == kTelnetWill) {
+                    if ((temp == kTelnetOptionBinary) ||
+                      (temp == kTelnetOptionSga) ||
+                      (temp == kTelnetOptionComPort)) {
+                        client.reply+= (char) kTelnetDo;
+                    } else {
+                        client.reply+= (char) kTelnetDont;
+                    }
+                } else {
+                    client.reply.erase(client.reply.size() - 1);
+                    client.telnet_state = kTelnetStateData;
+                    break;
+                }
+                client.reply+= (char) temp;
+                client.telnet_state = kTelnetStateData;
+                break;
+        }
+    }
+
+    return result;
+}
+
+//**************************[TelnetCommand]************************************
+void cComPortServer::TelnetCommand(sClient &client) {
+
+    std::string value;
+    unsigned char command;
+    int temp;
+
+    if (client.telnet_sub.size() < 3) { return; }
+    if ((unsigned char) client.telnet_sub[0] != kTelnetOptionComPort) {
+        return;
+    }
+
+    command = client.telnet_sub[1];
+    value   = client.telnet_sub.substr(2);
+    temp    = (unsigned char) value[0];
+
+    switch (command) {
+        case ( 1) : // set-baudrate
+            if (value.size() < 4) { return; }
+            temp = ((unsigned char) value[0] << 24) |
+              ((unsigned char) value[1] << 16) |
+              ((unsigned char) value[2] <<  8) | (unsigned char) value[3];
+            if (temp > 0) { port.SettingBaudRateSet(temp); }
+
+            temp = port.SettingBaudRateGet();
+            value.resize(4);
+            value[0] = temp >> 24;
+            value[1] = temp >> 16;
+            value[2] = temp >>  8;
+            value[3] = temp;
+            break;
+
+        case ( 2) : // set-datasize
+            if ((temp >= 5) && (temp <= 8)) {
+                port.SettingByteSizeSet((eComPortByteSize) temp);
+            }
+            value = (char) port.SettingByteSizeGet();
+            break;
+
+        case ( 3) : // set-parity
+            if ((temp >= 1) && (temp <= 5)) {
+                port.SettingParitySet((eComPortParity) (temp - 1));
+            }
+            value = (char) (port.SettingParityGet() + 1);
+            break;
+
+        case ( 4) : // set-stopsize (1.5 is not supported)
+            if (temp == 1) { port.SettingStopBitsSet(kCpStopBits1); }
+            if (temp == 2) { port.SettingStopBitsSet(kCpStopBits2); }
+            value = (char) (port.SettingStopBitsGet() == kCpStopBits2 ? 2 : 1);
+            break;
+
+        case ( 5) : // set-control
+            switch (temp) {
+                case ( 1) :
+                    port.SettingFlowControlSet(kCpFlowControlNone);    break;
+                case ( 2) :
+                    port.SettingFlowControlSet(kCpFlowControlXonXoff); break;
+                case ( 3) :
+                    port.SettingFlowControlSet(kCpFlowControlRtsCts);  break;
+                case ( 8) : port.LineDtrSet(true ); break;
+                case ( 9) : port.LineDtrSet(false); break;
+                case (11) : port.LineRtsSet(true ); break;
+                case (12) : port.LineRtsSet(false); break;
+                default   : break;
+            }
+            if (temp == 0) {
+                switch (port.SettingFlowControlGet()) {
+                    case (kCpFlowControlXonXoff) : value = (char) 2; break;
+                    case (kCpFlowControlRtsCts)  : value = (char) 3; break;
+                    default                      : value = (char) 1; break;
+                }
+            }
+            break;
+
+        case (12) : // purge-data
+            port.HWBufferFlush((temp & 1) != 0, (temp & 2) != 0);
+            break;
+
+        default   :
+            return;
+    }
+
+    // reply with the same command + 100 and the current value
+    client.reply+= (char) kTelnetIac;
+    client.reply+= (char) kTelnetSb;
+    client.reply+= (char) kTelnetOptionComPort;
+    client.reply+= (char) (command + 100);
+    for (int i = 0; i < value.size(); i++) {
+        client.reply+= value[i];
+        if ((unsigned char) value[i] == kTelnetIac) {
+            client.reply+= value[i];
+        }
+    }
+    client.reply+= (char) kTelnetIac;
+    client.reply+= (char) kTelnetSe;
+}
+
+//**************************[BufferAppend]*************************************
+void cComPortServer::BufferAppend(const std::string &data) {
+
+    if (data.empty()) { return; }
+
+    if (! rfc2217) {
+        buffer.append(data);
+        return;
+    }
+
+    // escaped only once for all clients
+    for (int i = 0; i < data.size(); i++) {
+        buffer+= data[i];
+        if ((unsigned char) data[i] == kTelnetIac) {
+            buffer+= data[i];
+        }
+    }
+}
+
+} // namespace wepet {
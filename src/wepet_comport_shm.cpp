@@ -0,0 +1,443 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_shm.cpp                                                       *
+* =====================                                                       *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_shm.h"
+
+// wepet headers
+
+// standard headers
+#include <algorithm>
+#include <climits>
+
+// additional headers
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+
+namespace wepet {
+
+static const uint32_t kShmMagic = 0x52434557; // "WECR"
+// length of padding records at the end of the ring
+static const uint32_t kShmPad   = 0xFFFFFFFF;
+
+// each record starts at a multiple of 8 bytes - padding records only
+// consist of size and length (they might be only 8 bytes long)
+struct sComPortShmRecord {
+    uint32_t size;
+    uint32_t length;
+    uint64_t sequence;
+};
+
+//*****************************************************************************
+//**************************{class cComPortShmPublisher}***********************
+//*****************************************************************************
+
+//**************************[cComPortShmPublisher]*****************************
+cComPortShmPublisher::cComPortShmPublisher() {
+
+    header  = NULL;
+    records = NULL;
+    mask    = 0;
+}
+
+//**************************[~cComPortShmPublisher]****************************
+cComPortShmPublisher::~cComPortShmPublisher() {
+
+    Close();
+}
+
+//**************************[Open]*********************************************
+bool cComPortShmPublisher::Open(std::string name, int capacity) {
+
+    int temp_file;
+    uint32_t temp_capacity;
+    void *temp_map;
+
+    Close();
+
+    temp_capacity = 4096;
+    while ((temp_capacity < capacity) && (temp_capacity < (1u << 30))) {
+        temp_capacity<<= 1;
+    }
+
+    temp_file = shm_open(name.data(), O_CREAT | O_RDWR | O_CLOEXEC, 0660);
+    if (temp_file < 0) { return false; }
+
+    if (ftruncate(temp_file, sizeof(sComPortShmHeader) + temp_capacity)) {
+        close(temp_file);
+        shm_unlink(name.data());
+        return false;
+    }
+    temp_map = mmap(NULL, sizeof(sComPortShmHeader) + temp_capacity,
+      PROT_READ | PROT_WRITE, MAP_SHARED, temp_file, 0);
+    close(temp_file);
+    if (temp_map == MAP_FAILED) {
+        shm_unlink(name.data());
+        return false;
+    }
+
+    header  = (sComPortShmHeader *) temp_map;
+    records = (char *) temp_map + sizeof(sComPortShmHeader);
+    mask    = temp_capacity - 1;
+
+    header->magic = 0;
+    header->capacity = temp_capacity;
+    __atomic_store_n(&header->tail    , 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->head    , 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->sequence, 0, __ATOMIC_RELAXED);
+    // the magic number marks the ring as valid for subscribers
+    __atomic_store_n(&header->magic, kShmMagic, __ATOMIC_RELEASE);
+
+    shm_name = name;
+    frame_rest.clear();
+    return true;
+}
+
+//**************************[IsOpened]*****************************************
+bool cComPortShmPublisher::IsOpened() const {
+
+    return header != NULL;
+}
+
+//**************************[Close]********************************************
+void cComPortShmPublisher::Close() {
+
+    if (header == NULL) { return; }
+
+    __atomic_store_n(&header->magic, 0, __ATOMIC_RELEASE);
+    munmap(header, sizeof(sComPortShmHeader) + mask + 1);
+    shm_unlink(shm_name.data());
+
+    header  = NULL;
+    records = NULL;
+    mask    = 0;
+    shm_name = "";
+}
+
+//**************************[Publish]******************************************
+bool cComPortShmPublisher::Publish(const std::string &data) {
+
+    return Publish(data.data(), data.size());
+}
+
+//**************************[Publish]******************************************
+bool cComPortShmPublisher::Publish(const char *data, int size) {
+
+    sComPortShmRecord record;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t offset;
+    uint64_t end;
+
+    if ((header == NULL) || (size < 0)) { return false; }
+
+    record.size = (sizeof(record) + size + 7) & ~7;
+    if (record.size > (mask + 1) / 2) { return false; }
+
+    head = __atomic_load_n(&header->head, __ATOMIC_RELAXED);
+    tail = __atomic_load_n(&header->tail, __ATOMIC_RELAXED);
+
+    // records never wrap - the end of the ring is padded instead
+    offset = head & mask;
+    end = head + record.size;
+    if (offset + record.size > mask + 1) {
+        end+= mask + 1 - offset;
+    }
+
+    // invalidate the oldest records before overwriting them
+    if (end - tail > mask + 1) {
+        while (end - tail > mask + 1) {
+            tail+= ((sComPortShmRecord *) (records + (tail & mask)))->size;
+        }
+        __atomic_store_n(&header->tail, tail, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+
+    if (offset + record.size > mask + 1) {
+        sComPortShmRecord pad;
+        pad.size     = mask + 1 - offset;
+        pad.length   = kShmPad;
+        memcpy(records + offset, &pad, 8);
+        head+= pad.size;
+        offset = 0;
+    }
+
+    record.length   = size;
+    record.sequence = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED) + 1;
+    memcpy(records + offset, &record, sizeof(record));
+    memcpy(records + offset + sizeof(record), data, size);
+
+    __atomic_store_n(&header->sequence, record.sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->head, end, __ATOMIC_RELEASE);
+
+    // only wake up if a subscriber is sleeping
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&header->waiters, __ATOMIC_RELAXED) > 0) {
+        __atomic_fetch_add(&header->wakeup, 1, __ATOMIC_SEQ_CST);
+        syscall(SYS_futex, &header->wakeup, FUTEX_WAKE, INT_MAX, NULL, NULL,
+          0);
+    }
+
+    return true;
+}
+
+//**************************[Update]*******************************************
+int cComPortShmPublisher::Update(cComPortBuffer &port, std::string delimiter) {
+
+    std::string data;
+    int size_max;
+    int result;
+    int pos;
+    int found;
+
+    if (header == NULL) { return 0; }
+
+    port.BufferUpdate();
+    data = port.BufferGet();
+    if (data.empty()) { return 0; }
+    port.BufferClear();
+
+    size_max = (mask + 1) / 2 - sizeof(sComPortShmRecord);
+    result = 0;
+
+    if (delimiter == "") {
+        for (pos = 0; pos < data.size(); pos+= size_max) {
+            if (Publish(data.data() + pos, std::min((int) data.size() - pos,
+              size_max))) {
+                result++;
+            }
+        }
+        return result;
+    }
+
+    frame_rest+= data;
+    pos = 0;
+    while ((found = frame_rest.find(delimiter, pos)) != std::string::npos) {
+        found+= delimiter.size();
+        // too long frames are split
+        while (found - pos > size_max) {
+            if (Publish(frame_rest.data() + pos, size_max)) { result++; }
+            pos+= size_max;
+        }
+        if (Publish(frame_rest.data() + pos, found - pos)) { result++; }
+        pos = found;
+    }
+    frame_rest.erase(0, pos);
+
+    if (frame_rest.size() > size_max) {
+        if (Publish(frame_rest.data(), size_max)) { result++; }
+        frame_rest.erase(0, size_max);
+    }
+
+    return result;
+}
+
+//**************************[SequenceGet]**************************************
+uint64_t cComPortShmPublisher::SequenceGet() const {
+
+    if (header == NULL) { return 0; }
+
+    return __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+}
+
+//*****************************************************************************
+//**************************{class cComPortShmSubscriber}**********************
+//*****************************************************************************
+
+//**************************[cComPortShmSubscriber]****************************
+cComPortShmSubscriber::cComPortShmSubscriber() {
+
+    header   = NULL;
+    records  = NULL;
+    mask     = 0;
+    map_size = 0;
+
+    position = 0;
+    sequence = 0;
+    lost     = 0;
+}
+
+//**************************[~cComPortShmSubscriber]***************************
+cComPortShmSubscriber::~cComPortShmSubscriber() {
+
+    Close();
+}
+
+//**************************[Open]*********************************************
+bool cComPortShmSubscriber::Open(std::string name) {
+
+    int temp_file;
+    struct stat temp_stat;
+    void *temp_map;
+
+    Close();
+
+    // read-write access is needed for the futex
+    temp_file = shm_open(name.data(), O_RDWR | O_CLOEXEC, 0);
+    if (temp_file < 0) { return false; }
+
+    if ((fstat(temp_file, &temp_stat) != 0) ||
+      (temp_stat.st_size < sizeof(sComPortShmHeader))) {
+        close(temp_file);
+        return false;
+    }
+    temp_map = mmap(NULL, temp_stat.st_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED, temp_file, 0);
+    close(temp_file);
+    if (temp_map == MAP_FAILED) { return false; }
+
+    header   = (sComPortShmHeader *) temp_map;
+    map_size = temp_stat.st_size;
+    if ((__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != kShmMagic) ||
+      (sizeof(sComPortShmHeader) + header->capacity > map_size) ||
+      (header->capacity & (header->capacity - 1))) {
+        Close();
+        return false;
+    }
+
+    records = (char *) temp_map + sizeof(sComPortShmHeader);
+    mask    = header->capacity - 1;
+
+    sequence = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+    position = __atomic_load_n(&header->head    , __ATOMIC_ACQUIRE);
+    lost     = 0;
+
+    return true;
+}
+
+//**************************[IsOpened]*****************************************
+bool cComPortShmSubscriber::IsOpened() const {
+
+    return header != NULL;
+}
+
+//**************************[Close]********************************************
+void cComPortShmSubscriber::Close() {
+
+    if (header == NULL) { return; }
+
+    munmap(header, map_size);
+
+    header   = NULL;
+    records  = NULL;
+    mask     = 0;
+    map_size = 0;
+}
+
+//**************************[Receive]******************************************
+bool cComPortShmSubscriber::Receive(std::string &data) {
+
+    sComPortShmRecord record;
+    uint64_t offset;
+    bool valid;
+
+    if (header == NULL) { return false; }
+
+    while (position != __atomic_load_n(&header->head, __ATOMIC_ACQUIRE)) {
+        if (position < __atomic_load_n(&header->tail, __ATOMIC_ACQUIRE)) {
+            Resync();
+            continue;
+        }
+
+        offset = position & mask;
+        memcpy(&record, records + offset, 8);
+        valid = (record.size >= 8) && ((record.size & 7) == 0) &&
+          (record.size <= mask + 1 - offset);
+        if (valid && (record.length != kShmPad)) {
+            valid = (record.size >= sizeof(record)) &&
+              (record.length <= record.size - sizeof(record));
+            if (valid) {
+                memcpy(&record, records + offset, sizeof(record));
+                data.assign(records + offset + sizeof(record), record.length);
+            }
+        }
+
+        // seqlock - the copy is only valid if it was not overwritten
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (position < __atomic_load_n(&header->tail, __ATOMIC_RELAXED)) {
+            Resync();
+            continue;
+        }
+        if (! valid) {
+            position = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+            lost++;
+            continue;
+        }
+
+        position+= record.size;
+        if (record.length == kShmPad) { continue; }
+
+        if (record.sequence > sequence + 1) {
+            lost+= record.sequence - sequence - 1;
+        }
+        sequence = record.sequence;
+        return true;
+    }
+
+    return false;
+}
+
+//**************************[Wait]*********************************************
+bool cComPortShmSubscriber::Wait(int milliseconds) {
+
+    timespec temp_time;
+    uint32_t temp_wakeup;
+
+    if (header == NULL) { return false; }
+
+    if (position != __atomic_load_n(&header->head, __ATOMIC_ACQUIRE)) {
+        return true;
+    }
+    if (milliseconds <= 0) { return false; }
+
+    temp_time.tv_sec  = milliseconds / 1000;
+    temp_time.tv_nsec = (milliseconds % 1000) * 1000000;
+
+    __atomic_fetch_add(&header->waiters, 1, __ATOMIC_SEQ_CST);
+    temp_wakeup = __atomic_load_n(&header->wakeup, __ATOMIC_SEQ_CST);
+    if (position == __atomic_load_n(&header->head, __ATOMIC_SEQ_CST)) {
+        syscall(SYS_futex, &header->wakeup, FUTEX_WAIT, temp_wakeup,
+          &temp_time, NULL, 0);
+    }
+    __atomic_fetch_sub(&header->waiters, 1, __ATOMIC_SEQ_CST);
+
+    return position != __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+}
+
+//**************************[SequenceGet]**************************************
+uint64_t cComPortShmSubscriber::SequenceGet() const {
+
+    return sequence;
+}
+
+//**************************[LostGet]******************************************
+uint64_t cComPortShmSubscriber::LostGet() const {
+
+    return lost;
+}
+
+//**************************[Resync]*******************************************
+void cComPortShmSubscriber::Resync() {
+
+    // continue with the oldest valid record
+    position = __atomic_load_n(&header->tail, __ATOMIC_ACQUIRE);
+}
+
+} // namespace wepet {
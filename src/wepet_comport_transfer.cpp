@@ -0,0 +1,992 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_transfer.cpp                                                  *
+* ==========================                                                  *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_transfer.h"
+
+// wepet headers
+
+// standard headers
+#include <stdio.h>
+#include <stdlib.h>
+
+// additional headers
+#include <poll.h>
+#include <unistd.h>
+
+
+
+namespace wepet {
+
+// window mode
+static const char kWindowStart  = (char) 0xA5;
+static const int  kWindowHeader = 10;
+static const int  kWindowReply  = 12;
+static const uint32_t kWindowDone = 0xFFFFFFFF;
+
+// xmodem and ymodem
+static const char kXmodemSoh = 0x01;
+static const char kXmodemStx = 0x02;
+static const char kXmodemEot = 0x04;
+static const char kXmodemAck = 0x06;
+static const char kXmodemNak = 0x15;
+static const char kXmodemCan = 0x18;
+static const char kXmodemCrc = 'C';
+static const char kXmodemPad = 0x1A;
+
+// results of XmodemParse besides the block types
+static const int kXmodemTimeout = -1;
+static const int kXmodemError   = -2;
+
+//**************************[IntAppend]****************************************
+static void IntAppend(std::string &text, uint32_t value, int bytes) {
+
+    for (int i = 0; i < bytes; i++) {
+        text+= (char) (value >> (8 * i));
+    }
+}
+
+//**************************[IntRead]******************************************
+static uint32_t IntRead(const char *data, int bytes) {
+
+    uint32_t result;
+
+    result = 0;
+    for (int i = 0; i < bytes; i++) {
+        result|= (uint32_t) (unsigned char) data[i] << (8 * i);
+    }
+
+    return result;
+}
+
+//**************************[cComPortTransfer]*********************************
+cComPortTransfer::cComPortTransfer() {
+
+    port       = NULL;
+    mode       = kCpTransferWindow;
+    window     = 16;
+    block_size = 1024;
+    timeout    = 1000;
+    retry_max  = 10;
+
+    window_order = 0;
+    char_time    = 0;
+    line_free    = 0;
+
+    StatisticStart();
+    StatisticStop();
+}
+
+//**************************[~cComPortTransfer]********************************
+cComPortTransfer::~cComPortTransfer() {
+
+}
+
+//**************************[PortSet]******************************************
+void cComPortTransfer::PortSet(cComPort *port) {
+
+    this->port = port;
+}
+
+//**************************[PortGet]******************************************
+cComPort *cComPortTransfer::PortGet() const {
+
+    return port;
+}
+
+//**************************[ModeSet]******************************************
+void cComPortTransfer::ModeSet(eComPortTransferMode mode) {
+
+    this->mode = mode;
+}
+
+//**************************[ModeGet]******************************************
+eComPortTransferMode cComPortTransfer::ModeGet() const {
+
+    return mode;
+}
+
+//**************************[WindowSet]****************************************
+void cComPortTransfer::WindowSet(int blocks) {
+
+    if (blocks < 1) { blocks = 1; }
+    window = blocks;
+}
+
+//**************************[WindowGet]****************************************
+int cComPortTransfer::WindowGet() const {
+
+    return window;
+}
+
+//**************************[BlockSizeSet]*************************************
+void cComPortTransfer::BlockSizeSet(int bytes) {
+
+    if (bytes < 1) { bytes = 1; }
+    if (bytes > 65535) { bytes = 65535; }
+    block_size = bytes;
+}
+
+//**************************[BlockSizeGet]*************************************
+int cComPortTransfer::BlockSizeGet() const {
+
+    return block_size;
+}
+
+//**************************[TimeoutSet]***************************************
+void cComPortTransfer::TimeoutSet(int milliseconds) {
+
+    if (milliseconds < 1) { milliseconds = 1; }
+    timeout = milliseconds;
+}
+
+//**************************[TimeoutGet]***************************************
+int cComPortTransfer::TimeoutGet() const {
+
+    return timeout;
+}
+
+//**************************[RetryMaxSet]**************************************
+void cComPortTransfer::RetryMaxSet(int count) {
+
+    if (count < 0) { count = 0; }
+    retry_max = count;
+}
+
+//**************************[RetryMaxGet]**************************************
+int cComPortTransfer::RetryMaxGet() const {
+
+    return retry_max;
+}
+
+//**************************[Send]*********************************************
+bool cComPortTransfer::Send(const std::string &data, std::string name) {
+
+    bool result;
+
+    if ((port == NULL) || (! port->IsOpened())) { return false; }
+
+    StatisticStart();
+    if (mode == kCpTransferWindow) {
+        result = WindowSend(data);
+    } else {
+        result = XmodemSend(data, name);
+    }
+    if (result) { statistic.bytes = data.size(); }
+    StatisticStop();
+
+    return result;
+}
+
+//**************************[Receive]******************************************
+bool cComPortTransfer::Receive(std::string &data, std::string &name) {
+
+    bool result;
+
+    data = "";
+    name = "";
+    if ((port == NULL) || (! port->IsOpened())) { return false; }
+
+    StatisticStart();
+    if (mode == kCpTransferWindow) {
+        result = WindowReceive(data);
+    } else {
+        result = XmodemReceive(data, name);
+    }
+    if (result) { statistic.bytes = data.size(); }
+    StatisticStop();
+
+    return result;
+}
+
+//**************************[StatisticGet]*************************************
+sComPortTransferStatistic cComPortTransfer::StatisticGet() const {
+
+    return statistic;
+}
+
+//**************************[WindowSend]***************************************
+bool cComPortTransfer::WindowSend(const std::string &data) {
+
+    uint32_t blocks;
+    uint32_t base;
+    uint32_t next;
+    int64_t time_curr;
+    int64_t time_end;
+    int64_t time_block;
+    int64_t order_acked;
+    sFrame frame;
+    int count_out;
+
+    blocks = (data.size() + block_size - 1) / block_size;
+    window_slots.assign(window, sSlot());
+    window_order = 0;
+    order_acked  = -1;
+    // time to transmit one block
+    time_block = (int64_t) (block_size + kWindowHeader + 2) * char_time /
+      1000;
+
+    base = 0;
+    next = 0;
+    while (base < blocks) {
+        // new blocks are only given to the driver if its buffer is nearly
+        // empty - otherwise retransmits would be delayed
+        while ((next < blocks) && (next < base + window)) {
+            count_out = port->HWBufferOutCountGet();
+            if (count_out >= block_size) { break; }
+
+            window_slots[next % window].acked   = false;
+            window_slots[next % window].retries = 0;
+            WindowBlock(data, next);
+            statistic.blocks++;
+            next++;
+        }
+
+        // waiting for replies until the next deadline
+        time_curr = cComPort::TimeGet();
+        time_end  = time_curr + (int64_t) timeout * 1000;
+        for (uint32_t i = base; i < next; i++) {
+            sSlot &slot = window_slots[i % window];
+            if ((! slot.acked) && (slot.deadline < time_end)) {
+                time_end = slot.deadline;
+            }
+        }
+        if ((next < blocks) && (next < base + window) &&
+          (time_end > time_curr + time_block)) {
+            time_end = time_curr + time_block;
+        }
+        DataWait(time_end);
+
+        while (WindowParse(frame)) {
+            if ((frame.type != 'A') && (frame.type != 'N')) { continue; }
+
+            // every reply acknowledges all blocks before value
+            while ((base < frame.value) && (base < next)) {
+                window_slots[base % window].acked = true;
+                base++;
+            }
+            if ((frame.block < base) || (frame.block >= next)) {
+                continue;
+            }
+
+            sSlot &slot = window_slots[frame.block % window];
+            if (frame.type == 'A') {
+                slot.acked = true;
+                if (order_acked < slot.order) { order_acked = slot.order; }
+            } else if ((! slot.acked) && (slot.order < order_acked)) {
+                // gap reported by the receiver - it is ignored if the
+                // block was sent again after the acknowledged one, as
+                // the receiver could not know about this copy
+                slot.retries++;
+                statistic.retransmits++;
+                if (slot.retries > retry_max) { return false; }
+                WindowBlock(data, frame.block);
+            }
+        }
+        while ((base < next) && window_slots[base % window].acked) {
+            base++;
+        }
+
+        time_curr = cComPort::TimeGet();
+        for (uint32_t i = base; i < next; i++) {
+            sSlot &slot = window_slots[i % window];
+            if (slot.acked || (slot.deadline > time_curr)) { continue; }
+
+            slot.retries++;
+            statistic.timeouts++;
+            statistic.retransmits++;
+            if (slot.retries > retry_max) { return false; }
+            WindowBlock(data, i);
+        }
+    }
+
+    // the end is repeated until it is acknowledged
+    for (int retry = 0; retry <= retry_max; retry++) {
+        WindowWrite('E', blocks, data.size(), NULL, 0);
+        time_end = line_free + (int64_t) timeout * 1000;
+
+        while (cComPort::TimeGet() < time_end) {
+            DataWait(time_end);
+            while (WindowParse(frame)) {
+                if ((frame.type == 'A') && (frame.block == kWindowDone) &&
+                  (frame.value == blocks)) {
+                    return true;
+                }
+            }
+        }
+        statistic.timeouts++;
+    }
+
+    return false;
+}
+
+//**************************[WindowReceive]************************************
+bool cComPortTransfer::WindowReceive(std::string &data) {
+
+    std::vector<std::string> slot_data;
+    std::vector<bool> slot_valid;
+    std::vector<int64_t> slot_nak;
+    uint32_t base;
+    uint32_t block;
+    int64_t time_curr;
+    int64_t time_end;
+    int64_t time_idle;
+    sFrame frame;
+    bool done;
+
+    slot_data.resize(window);
+    slot_valid.assign(window, false);
+    slot_nak.assign(window, 0);
+
+    // the sender retries retry_max times before giving up
+    time_idle = (int64_t) timeout * 1000 * (retry_max + 1);
+    time_end  = cComPort::TimeGet() + time_idle;
+
+    base = 0;
+    done = false;
+    while (cComPort::TimeGet() < time_end) {
+        DataWait(time_end);
+
+        while (WindowParse(frame)) {
+            time_curr = cComPort::TimeGet();
+            // after the end, lost acknowledges are repeated for a while
+            if (done) {
+                time_end = time_curr + (int64_t) timeout * 1000;
+            } else {
+                time_end = time_curr + time_idle;
+            }
+
+            if (frame.type == 'E') {
+                if ((base == frame.block) && (data.size() == frame.value)) {
+                    WindowWrite('A', kWindowDone, base, NULL, 0);
+                    done = true;
+                    time_end = time_curr + (int64_t) timeout * 1000;
+                } else {
+                    WindowWrite('N', base, base, NULL, 0);
+                }
+                continue;
+            }
+            if (frame.type != 'D') { continue; }
+
+            block = frame.block;
+            if (block < base) {
+                // the acknowledge was lost
+                WindowWrite('A', block, base, NULL, 0);
+                continue;
+            }
+            if (block >= base + window) { continue; }
+
+            if (! slot_valid[block % window]) {
+                slot_data[block % window].swap(frame.payload);
+                slot_valid[block % window] = true;
+                statistic.blocks++;
+            }
+            while (slot_valid[base % window]) {
+                data.append(slot_data[base % window]);
+                slot_valid[base % window] = false;
+                slot_nak[base % window]   = 0;
+                base++;
+            }
+            WindowWrite('A', block, base, NULL, 0);
+
+            // missing blocks are reported once per timeout
+            for (uint32_t i = base; i < block; i++) {
+                if (slot_valid[i % window]) { continue; }
+                if (time_curr - slot_nak[i % window] <
+                  (int64_t) timeout * 1000) {
+                    continue;
+                }
+                slot_nak[i % window] = time_curr;
+                WindowWrite('N', i, base, NULL, 0);
+            }
+        }
+    }
+
+    if (! done) { statistic.timeouts++; }
+    return done;
+}
+
+//**************************[WindowBlock]**************************************
+void cComPortTransfer::WindowBlock(const std::string &data, uint32_t block) {
+
+    int64_t offset;
+    int size;
+
+    offset = (int64_t) block * block_size;
+    size   = data.size() - offset;
+    if (size > block_size) { size = block_size; }
+
+    WindowWrite('D', block, 0, data.data() + offset, size);
+    window_slots[block % window].order    = window_order++;
+    window_slots[block % window].deadline = line_free +
+      (int64_t) timeout * 1000;
+}
+
+//**************************[WindowWrite]**************************************
+void cComPortTransfer::WindowWrite(char type, uint32_t block, uint32_t value,
+  const char *payload, int size) {
+
+    std::string temp_frame;
+
+    temp_frame.reserve(kWindowHeader + size + 2);
+    temp_frame+= kWindowStart;
+    temp_frame+= type;
+    IntAppend(temp_frame, block, 4);
+    if (type == 'D') {
+        IntAppend(temp_frame, size, 2);
+        IntAppend(temp_frame, Crc16(temp_frame.data() + 1,
+          temp_frame.size() - 1), 2);
+        temp_frame.append(payload, size);
+    } else {
+        IntAppend(temp_frame, value, 4);
+    }
+    IntAppend(temp_frame, Crc16(temp_frame.data() + 1, temp_frame.size() - 1),
+      2);
+
+    Write(temp_frame);
+}
+
+//**************************[WindowParse]**************************************
+bool cComPortTransfer::WindowParse(sFrame &frame) {
+
+    std::string::size_type pos;
+    int size;
+
+    while (true) {
+        pos = receive_buffer.find(kWindowStart);
+        if (pos == std::string::npos) {
+            receive_buffer.clear();
+            return false;
+        }
+        if (pos > 0) { receive_buffer.erase(0, pos); }
+        if (receive_buffer.size() < 2) { return false; }
+
+        frame.type = receive_buffer[1];
+        if (frame.type == 'D') {
+            // the header is checked first - a damaged size would stall
+            // the receiver until enough bytes were received
+            if (receive_buffer.size() < kWindowHeader) { return false; }
+            if (Crc16(&receive_buffer[1], kWindowHeader - 3) !=
+              IntRead(&receive_buffer[kWindowHeader - 2], 2)) {
+                statistic.errors++;
+                receive_buffer.erase(0, 1);
+                continue;
+            }
+            size = kWindowHeader + IntRead(&receive_buffer[6], 2) + 2;
+        } else if ((frame.type == 'A') || (frame.type == 'N') ||
+          (frame.type == 'E')) {
+            size = kWindowReply;
+        } else {
+            receive_buffer.erase(0, 1);
+            continue;
+        }
+        if (receive_buffer.size() < size) { return false; }
+
+        // damaged frames are skipped byte by byte to find the next start
+        if (Crc16(&receive_buffer[1], size - 3) !=
+          IntRead(&receive_buffer[size - 2], 2)) {
+            statistic.errors++;
+            receive_buffer.erase(0, 1);
+            continue;
+        }
+
+        frame.block = IntRead(&receive_buffer[2], 4);
+        if (frame.type == 'D') {
+            frame.value = 0;
+            frame.payload.assign(receive_buffer, kWindowHeader,
+              size - kWindowHeader - 2);
+        } else {
+            frame.value = IntRead(&receive_buffer[6], 4);
+            frame.payload.clear();
+        }
+        receive_buffer.erase(0, size);
+        return true;
+    }
+}
+
+//**************************[XmodemSend]***************************************
+bool cComPortTransfer::XmodemSend(const std::string &data, std::string name) {
+
+    int size;
+    int number;
+    int64_t time_end;
+    int temp_char;
+    bool crc;
+
+    size = (mode == kCpTransferXmodem) ? 128 : 1024;
+
+    // the receiver starts with 'C' (crc) or a nak (checksum)
+    receive_buffer.clear();
+    time_end = cComPort::TimeGet() + (int64_t) timeout * 1000 *
+      (retry_max + 1);
+    do {
+        temp_char = CharWait(time_end);
+        if ((temp_char < 0) || (temp_char == kXmodemCan)) { return false; }
+    } while ((temp_char != kXmodemCrc) && (temp_char != kXmodemNak));
+    crc = (temp_char == kXmodemCrc);
+
+    if (mode == kCpTransferYmodem) {
+        std::string temp_header;
+        char temp_size[32];
+
+        snprintf(temp_size, sizeof(temp_size), "%lu",
+          (unsigned long) data.size());
+        temp_header = name;
+        temp_header+= '\0';
+        temp_header+= temp_size;
+        if (temp_header.size() > 127) { return false; }
+        if (! XmodemBlock(0, temp_header.data(), temp_header.size() + 1,
+          128, crc)) {
+            return false;
+        }
+
+        // the data is requested again
+        do {
+            temp_char = CharWait(time_end);
+            if ((temp_char < 0) || (temp_char == kXmodemCan)) {
+                return false;
+            }
+        } while ((temp_char != kXmodemCrc) && (temp_char != kXmodemNak));
+    }
+
+    number = 1;
+    for (int offset = 0; offset < data.size(); offset+= size) {
+        int temp_size = data.size() - offset;
+        if (temp_size > size) { temp_size = size; }
+
+        if (! XmodemBlock(number, data.data() + offset, temp_size, size,
+          crc)) {
+            return false;
+        }
+        number++;
+    }
+
+    // ymodem receivers answer the first end of transmission with a nak
+    for (int retry = 0; ; retry++) {
+        if (retry > retry_max) { return false; }
+
+        Write(std::string(1, kXmodemEot));
+        temp_char = CharWait(line_free + (int64_t) timeout * 1000);
+        if (temp_char == kXmodemAck) { break; }
+        if (temp_char == kXmodemCan) { return false; }
+        if (temp_char < 0) { statistic.timeouts++; }
+    }
+
+    if (mode == kCpTransferYmodem) {
+        // an empty header ends the batch
+        time_end = cComPort::TimeGet() + (int64_t) timeout * 1000 *
+          (retry_max + 1);
+        do {
+            temp_char = CharWait(time_end);
+            if ((temp_char < 0) || (temp_char == kXmodemCan)) {
+                return false;
+            }
+        } while (temp_char != kXmodemCrc);
+
+        if (! XmodemBlock(0, "", 1, 128, crc)) { return false; }
+    }
+
+    return true;
+}
+
+//**************************[XmodemReceive]************************************
+bool cComPortTransfer::XmodemReceive(std::string &data, std::string &name) {
+
+    std::string temp_payload;
+    int64_t size;
+    int expected;
+    int number;
+    int retry;
+    int result;
+    int count_eot;
+    bool started;
+    bool request;
+
+    size      = -1;
+    expected  = (mode == kCpTransferYmodem) ? 0 : 1;
+    count_eot = 0;
+    started   = false;
+    request   = true;
+
+    for (retry = 0; retry <= retry_max;) {
+        // the sender is asked for crc until the first block was received
+        if (request) {
+            Write(std::string(1, started ? kXmodemNak : kXmodemCrc));
+            request = false;
+        }
+
+        result = XmodemParse(temp_payload, number, true,
+          cComPort::TimeGet() + (int64_t) timeout * 1000);
+
+        if (result == kXmodemCan) { return false; }
+        if (result == kXmodemTimeout) {
+            // once started, the sender repeats the block on its own - a
+            // nak at the same time would be taken for the next block
+            statistic.timeouts++;
+            retry++;
+            request = ! started;
+            continue;
+        }
+        if (result == kXmodemError) {
+            statistic.errors++;
+            count_eot = 0;
+            retry++;
+            Purge();
+            request = true;
+            continue;
+        }
+
+        if (result == kXmodemEot) {
+            // the first end of transmission is answered with a nak to
+            // be sure it was not garbage (required by ymodem anyway)
+            if (count_eot++ == 0) {
+                Write(std::string(1, kXmodemNak));
+                continue;
+            }
+            Write(std::string(1, kXmodemAck));
+            if (mode != kCpTransferYmodem) { return true; }
+
+            if ((size >= 0) && (size < data.size())) { data.resize(size); }
+            // the batch is ended by an empty header
+            expected = 0;
+            started  = false;
+            request  = true;
+            retry    = 0;
+            continue;
+        }
+
+        retry = 0;
+        if (number == ((expected - 1) & 0xFF)) {
+            // the acknowledge was lost
+            Write(std::string(1, kXmodemAck));
+            continue;
+        }
+        if (number != (expected & 0xFF)) {
+            Write(std::string(2, kXmodemCan));
+            return false;
+        }
+
+        if ((mode == kCpTransferYmodem) && (expected == 0)) {
+            Write(std::string(1, kXmodemAck));
+            if (temp_payload[0] == '\0') { return count_eot > 0; }
+
+            name = temp_payload.c_str();
+            size = strtoll(temp_payload.c_str() + name.size() + 1, NULL,
+              10);
+            expected = 1;
+            request  = true;
+            continue;
+        }
+
+        data.append(temp_payload);
+        count_eot = 0;
+        statistic.blocks++;
+        expected++;
+        started = true;
+        Write(std::string(1, kXmodemAck));
+    }
+
+    Write(std::string(2, kXmodemCan));
+    return false;
+}
+
+//**************************[XmodemBlock]**************************************
+bool cComPortTransfer::XmodemBlock(int number, const char *payload, int size,
+  int block_size, bool crc) {
+
+    std::string temp_frame;
+    int64_t time_end;
+    int temp_char;
+    uint16_t temp_crc;
+    unsigned char temp_sum;
+
+    temp_frame.reserve(block_size + 5);
+    temp_frame+= (block_size == 128) ? kXmodemSoh : kXmodemStx;
+    temp_frame+= (char) number;
+    temp_frame+= (char) (255 - (number & 0xFF));
+    temp_frame.append(payload, size);
+    // the header of ymodem is padded with zeros
+    temp_frame.append(block_size - size, (number == 0) ? '\0' : kXmodemPad);
+
+    if (crc) {
+        temp_crc = Crc16(temp_frame.data() + 3, block_size);
+        temp_frame+= (char) (temp_crc >> 8);
+        temp_frame+= (char) temp_crc;
+    } else {
+        temp_sum = 0;
+        for (int i = 3; i < temp_frame.size(); i++) {
+            temp_sum+= temp_frame[i];
+        }
+        temp_frame+= (char) temp_sum;
+    }
+
+    statistic.blocks++;
+    for (int retry = 0; retry <= retry_max; retry++) {
+        if (retry > 0) { statistic.retransmits++; }
+
+        receive_buffer.clear();
+        Write(temp_frame);
+        // replies before the block could have been received are left over
+        // from a previous try and would be taken for the wrong block
+        time_end = line_free + (int64_t) timeout * 1000;
+        while (true) {
+            temp_char = CharWait(time_end);
+            if ((temp_char < 0) || (temp_char == kXmodemCan)) { break; }
+            if ((temp_char != kXmodemAck) && (temp_char != kXmodemNak)) {
+                continue;
+            }
+            if (cComPort::TimeGet() >= line_free) { break; }
+        }
+
+        if (temp_char == kXmodemAck) { return true; }
+        if (temp_char == kXmodemCan) { return false; }
+        if (temp_char < 0) { statistic.timeouts++; }
+    }
+
+    return false;
+}
+
+//**************************[XmodemParse]**************************************
+int cComPortTransfer::XmodemParse(std::string &payload, int &number,
+  bool crc, int64_t time_end) {
+
+    int type;
+    int size;
+    bool garbage;
+
+    garbage = false;
+    while (true) {
+        if (receive_buffer.size() == 0) {
+            if ((! DataWait(time_end)) &&
+              (cComPort::TimeGet() >= time_end)) {
+                return kXmodemTimeout;
+            }
+            continue;
+        }
+
+        type = (unsigned char) receive_buffer[0];
+        // a cancel is sent twice and an end of transmission is sent on
+        // its own - otherwise both are garbage
+        if (type == kXmodemCan) {
+            while ((receive_buffer.size() < 2) && (DataWait(time_end) ||
+              (cComPort::TimeGet() < time_end))) {}
+            if ((receive_buffer.size() >= 2) &&
+              (receive_buffer[1] == kXmodemCan)) {
+                receive_buffer.erase(0, 2);
+                return type;
+            }
+            receive_buffer.erase(0, 1);
+            garbage = true;
+            continue;
+        }
+        if (type == kXmodemEot) {
+            receive_buffer.erase(0, 1);
+            if ((receive_buffer.size() == 0) && (! garbage)) { return type; }
+            garbage = true;
+            continue;
+        }
+        if ((type != kXmodemSoh) && (type != kXmodemStx)) {
+            receive_buffer.erase(0, 1);
+            garbage = true;
+            continue;
+        }
+        break;
+    }
+
+    size = (type == kXmodemSoh) ? 128 : 1024;
+    size+= crc ? 5 : 4;
+    while (receive_buffer.size() < size) {
+        if ((! DataWait(time_end)) && (cComPort::TimeGet() >= time_end)) {
+            return kXmodemError;
+        }
+    }
+
+    if (((unsigned char) receive_buffer[1] +
+      (unsigned char) receive_buffer[2]) != 255) {
+        return kXmodemError;
+    }
+
+    if (crc) {
+        if (Crc16(&receive_buffer[3], size - 5) !=
+          (((unsigned char) receive_buffer[size - 2] << 8) |
+          (unsigned char) receive_buffer[size - 1])) {
+            return kXmodemError;
+        }
+    } else {
+        unsigned char temp_sum = 0;
+        for (int i = 3; i < size - 1; i++) {
+            temp_sum+= receive_buffer[i];
+        }
+        if (temp_sum != (unsigned char) receive_buffer[size - 1]) {
+            return kXmodemError;
+        }
+    }
+
+    number = (unsigned char) receive_buffer[1];
+    payload.assign(receive_buffer, 3, size - (crc ? 5 : 4));
+    receive_buffer.erase(0, size);
+    return type;
+}
+
+//**************************[DataWait]*****************************************
+bool cComPortTransfer::DataWait(int64_t time_end) {
+
+    std::string temp_text;
+    int64_t time_curr;
+    int file;
+
+    temp_text = port->Receive();
+    if (temp_text.size() == 0) {
+        time_curr = cComPort::TimeGet();
+        if (time_curr >= time_end) { return false; }
+
+        file = port->FileGet();
+        if (file >= 0) {
+            pollfd temp_poll;
+            temp_poll.fd     = file;
+            temp_poll.events = POLLIN;
+            poll(&temp_poll, 1, (time_end - time_curr + 999) / 1000);
+        } else {
+            // transports without a file are checked more often
+            if (time_end - time_curr > 100) {
+                time_curr = time_end - 100;
+            }
+            usleep(time_end - time_curr);
+        }
+
+        temp_text = port->Receive();
+        if (temp_text.size() == 0) { return false; }
+    }
+
+    receive_buffer.append(temp_text);
+    return true;
+}
+
+//**************************[CharWait]*****************************************
+int cComPortTransfer::CharWait(int64_t time_end) {
+
+    int result;
+    bool cancel;
+
+    // a cancel is only valid if it is sent twice
+    cancel = false;
+    while (true) {
+        while (receive_buffer.size() == 0) {
+            if ((! DataWait(time_end)) &&
+              (cComPort::TimeGet() >= time_end)) {
+                return -1;
+            }
+        }
+
+        result = (unsigned char) receive_buffer[0];
+        receive_buffer.erase(0, 1);
+        if (result != kXmodemCan) { return result; }
+        if (cancel) { return result; }
+        cancel = true;
+    }
+}
+
+//**************************[Purge]********************************************
+void cComPortTransfer::Purge() {
+
+    // waits until the line is silent for the time of 16 characters
+    // (at least one millisecond)
+    int64_t time_silent = 16 * char_time / 1000;
+    if (time_silent < 1000) { time_silent = 1000; }
+
+    do {
+        receive_buffer.clear();
+    } while (DataWait(cComPort::TimeGet() + time_silent));
+    receive_buffer.clear();
+}
+
+//**************************[Write]********************************************
+void cComPortTransfer::Write(const std::string &text) {
+
+    int count_out;
+
+    // a failed or partial write is repaired by the protocol
+    port->Transmit(text);
+    statistic.line_bytes+= text.size();
+
+    // the baud rate of virtual ports (e.g. pty or usb) is meaningless,
+    // so the estimation is based on the output buffer of the driver
+    count_out = port->HWBufferOutCountGet();
+    if (count_out < 0) { count_out = text.size(); }
+    line_free = cComPort::TimeGet() + (int64_t) count_out * char_time / 1000;
+}
+
+//**************************[StatisticStart]***********************************
+void cComPortTransfer::StatisticStart() {
+
+    int bits;
+    int baud_rate;
+
+    statistic.bytes       = 0;
+    statistic.line_bytes  = 0;
+    statistic.blocks      = 0;
+    statistic.retransmits = 0;
+    statistic.errors      = 0;
+    statistic.timeouts    = 0;
+    statistic.duration    = 0;
+    statistic.efficiency  = 0.0;
+
+    time_start = cComPort::TimeGet();
+    line_free  = time_start;
+    receive_buffer.clear();
+
+    // start, data, parity and stop bits
+    char_time = 0;
+    if (port == NULL) { return; }
+    baud_rate = port->SettingBaudRateGet();
+    if (baud_rate <= 0) { return; }
+
+    bits = 1 + port->SettingByteSizeGet() + 1;
+    if (port->SettingParityGet()   != kCpParityNone) { bits++; }
+    if (port->SettingStopBitsGet() == kCpStopBits2 ) { bits++; }
+    char_time = (int64_t) bits * 1000000000 / baud_rate;
+}
+
+//**************************[StatisticStop]************************************
+void cComPortTransfer::StatisticStop() {
+
+    statistic.duration = cComPort::TimeGet() - time_start;
+    if (statistic.duration <= 0) { return; }
+
+    // time needed for the payload at full line speed
+    statistic.efficiency = (double) statistic.bytes * char_time / 1000.0 /
+      statistic.duration;
+}
+
+//**************************[Crc16]********************************************
+uint16_t cComPortTransfer::Crc16(const char *data, int size) {
+
+    // crc-16/xmodem (polynomial 0x1021, initial value 0)
+    uint16_t result;
+
+    result = 0;
+    for (int i = 0; i < size; i++) {
+        result^= (uint16_t) (unsigned char) data[i] << 8;
+        for (int j = 0; j < 8; j++) {
+            if (result & 0x8000) {
+                result = (result << 1) ^ 0x1021;
+            } else {
+                result<<= 1;
+            }
+        }
+    }
+
+    return result;
+}
+
+} // namespace wepet {
@@ -0,0 +1,465 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_transport.cpp                                                 *
+* ===========================                                                 *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_transport.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+
+
+namespace wepet {
+
+//**************************[cComPortLoopback]*********************************
+cComPortLoopback::cComPortLoopback() {
+
+    peer = NULL;
+    pthread_mutex_init(&mutex, NULL);
+
+    baud_rate = 0;
+    time_free = 0;
+
+    loss_probability = 0.0;
+    loss_state = 1;
+    loss_count = 0;
+}
+
+//**************************[~cComPortLoopback]********************************
+cComPortLoopback::~cComPortLoopback() {
+
+    Close();
+    pthread_mutex_destroy(&mutex);
+}
+
+//**************************[Connect]******************************************
+bool cComPortLoopback::Connect(cComPortLoopback &peer) {
+
+    if (&peer == this) { return false; }
+
+    Close();
+    peer.Close();
+
+    pthread_mutex_lock(&mutex);
+    this->peer = &peer;
+    pthread_mutex_unlock(&mutex);
+
+    pthread_mutex_lock(&peer.mutex);
+    peer.peer = this;
+    pthread_mutex_unlock(&peer.mutex);
+
+    return true;
+}
+
+//**************************[IsOpened]*****************************************
+bool cComPortLoopback::IsOpened() {
+
+    bool result;
+
+    pthread_mutex_lock(&mutex);
+    result = (peer != NULL);
+    pthread_mutex_unlock(&mutex);
+
+    return result;
+}
+
+//**************************[Close]********************************************
+void cComPortLoopback::Close() {
+
+    cComPortLoopback *temp_peer;
+
+    // never holds both locks - so two endpoints can be closed at once
+    pthread_mutex_lock(&mutex);
+    temp_peer = peer;
+    peer = NULL;
+    receive_queue.clear();
+    pthread_mutex_unlock(&mutex);
+
+    if (temp_peer != NULL) {
+        pthread_mutex_lock(&temp_peer->mutex);
+        if (temp_peer->peer == this) {
+            temp_peer->peer = NULL;
+        }
+        pthread_mutex_unlock(&temp_peer->mutex);
+    }
+}
+
+//**************************[Write]********************************************
+int cComPortLoopback::Write(const char *data, int size) {
+
+    cComPortLoopback *temp_peer;
+    int64_t time_curr;
+
+    if (size < 0) { size = 0; }
+
+    sChunk temp_chunk;
+    temp_chunk.offset = 0;
+    temp_chunk.time_char = 0;
+
+    // the chunk is prepared with the own lock and passed to the peer
+    // afterwards - never holding both locks
+    pthread_mutex_lock(&mutex);
+    temp_peer = peer;
+    if (temp_peer == NULL) {
+        pthread_mutex_unlock(&mutex);
+        errno = EIO;
+        return -1;
+    }
+    if (size == 0) {
+        pthread_mutex_unlock(&mutex);
+        return 0;
+    }
+
+    if (baud_rate > 0) {
+        temp_chunk.time_char = (int64_t) 10000000000LL / baud_rate;
+    }
+
+    if (loss_probability <= 0.0) {
+        temp_chunk.data.assign(data, size);
+    } else {
+        temp_chunk.data.reserve(size);
+        for (int i = 0; i < size; i++) {
+            // xorshift32 - reproducible for a given seed
+            loss_state^= loss_state << 13;
+            loss_state^= loss_state >> 17;
+            loss_state^= loss_state <<  5;
+            if (loss_state < loss_probability * 4294967296.0) {
+                loss_count++;
+                continue;
+            }
+            temp_chunk.data+= data[i];
+        }
+    }
+
+    // the line is busy until the previous bytes were sent
+    time_curr = TimeGet();
+    temp_chunk.time_start = time_curr;
+    if (temp_chunk.time_start < time_free) {
+        temp_chunk.time_start = time_free;
+    }
+    time_free = temp_chunk.time_start + (int64_t) size * temp_chunk.time_char;
+    pthread_mutex_unlock(&mutex);
+
+    if (! temp_chunk.data.empty()) {
+        pthread_mutex_lock(&temp_peer->mutex);
+        // the peer might have been closed in the meantime
+        if (temp_peer->peer == this) {
+            temp_peer->receive_queue.push_back(sChunk());
+            sChunk &temp_back = temp_peer->receive_queue.back();
+            temp_back.data.swap(temp_chunk.data);
+            temp_back.offset     = 0;
+            temp_back.time_start = temp_chunk.time_start;
+            temp_back.time_char  = temp_chunk.time_char;
+        }
+        pthread_mutex_unlock(&temp_peer->mutex);
+    }
+
+    return size;
+}
+
+//**************************[Read]*********************************************
+int cComPortLoopback::Read(char *data, int size) {
+
+    int64_t time_curr;
+    int count;
+    int result;
+
+    time_curr = TimeGet();
+    result = 0;
+
+    pthread_mutex_lock(&mutex);
+    if (peer == NULL) {
+        pthread_mutex_unlock(&mutex);
+        errno = EIO;
+        return -1;
+    }
+    while ((result < size) && (! receive_queue.empty())) {
+        sChunk &temp_chunk = receive_queue.front();
+
+        count = CountAvailable(temp_chunk, time_curr);
+        if (count <= 0) { break; }
+        if (count > size - result) { count = size - result; }
+
+        temp_chunk.data.copy(data + result, count, temp_chunk.offset);
+        temp_chunk.offset+= count;
+        result+= count;
+
+        if (temp_chunk.offset < temp_chunk.data.size()) { break; }
+        receive_queue.pop_front();
+    }
+    pthread_mutex_unlock(&mutex);
+
+    if (result == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    return result;
+}
+
+//**************************[InCountGet]***************************************
+int cComPortLoopback::InCountGet() {
+
+    int64_t time_curr;
+    int count;
+    int result;
+
+    time_curr = TimeGet();
+    result = 0;
+
+    pthread_mutex_lock(&mutex);
+    if (peer == NULL) {
+        pthread_mutex_unlock(&mutex);
+        return -1;
+    }
+    for (int i = 0; i < receive_queue.size(); i++) {
+        count = CountAvailable(receive_queue[i], time_curr);
+        result+= count;
+        if (receive_queue[i].offset + count < receive_queue[i].data.size()) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&mutex);
+
+    return result;
+}
+
+//**************************[OutCountGet]**************************************
+int cComPortLoopback::OutCountGet() {
+
+    int64_t time_curr;
+    int64_t time_char;
+    int result;
+
+    time_curr = TimeGet();
+
+    pthread_mutex_lock(&mutex);
+    if (peer == NULL) {
+        result = -1;
+    } else if ((baud_rate <= 0) || (time_free <= time_curr)) {
+        result = 0;
+    } else {
+        time_char = (int64_t) 10000000000LL / baud_rate;
+        result = (time_free - time_curr + time_char - 1) / time_char;
+    }
+    pthread_mutex_unlock(&mutex);
+
+    return result;
+}
+
+//**************************[BaudRateSet]**************************************
+bool cComPortLoopback::BaudRateSet(int baud_rate) {
+
+    if (baud_rate < 0) { return false; }
+
+    pthread_mutex_lock(&mutex);
+    this->baud_rate = baud_rate;
+    pthread_mutex_unlock(&mutex);
+
+    return true;
+}
+
+//**************************[BaudRateGet]**************************************
+int cComPortLoopback::BaudRateGet() {
+
+    int result;
+
+    pthread_mutex_lock(&mutex);
+    result = baud_rate;
+    pthread_mutex_unlock(&mutex);
+
+    return result;
+}
+
+//**************************[LossSet]******************************************
+void cComPortLoopback::LossSet(double probability, uint32_t seed) {
+
+    if (probability < 0.0) { probability = 0.0; }
+    if (probability > 1.0) { probability = 1.0; }
+
+    pthread_mutex_lock(&mutex);
+    loss_probability = probability;
+    loss_state = (seed != 0) ? seed : 1;
+    pthread_mutex_unlock(&mutex);
+}
+
+//**************************[LossCountGet]*************************************
+int cComPortLoopback::LossCountGet() {
+
+    int result;
+
+    pthread_mutex_lock(&mutex);
+    result = loss_count;
+    pthread_mutex_unlock(&mutex);
+
+    return result;
+}
+
+//**************************[CountAvailable]***********************************
+int cComPortLoopback::CountAvailable(const sChunk &chunk, int64_t time_curr)
+  const {
+
+    int64_t count;
+
+    if (chunk.time_char <= 0) {
+        count = chunk.data.size();
+    } else if (time_curr < chunk.time_start) {
+        count = 0;
+    } else {
+        count = (time_curr - chunk.time_start) / chunk.time_char;
+        if (count > chunk.data.size()) { count = chunk.data.size(); }
+    }
+
+    count-= chunk.offset;
+    return (count > 0) ? count : 0;
+}
+
+//**************************[TimeGet]******************************************
+int64_t cComPortLoopback::TimeGet() {
+
+    return cComPort::TimeGet() * 1000;
+}
+
+
+
+//**************************[cComPortPty]**************************************
+cComPortPty::cComPortPty() {
+
+    port_master = -1;
+    port_slave  = -1;
+}
+
+//**************************[~cComPortPty]*************************************
+cComPortPty::~cComPortPty() {
+
+    Close();
+}
+
+//**************************[Open]*********************************************
+bool cComPortPty::Open() {
+
+    termios temp_settings;
+    char *temp_name;
+
+    Close();
+
+    port_master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (port_master < 0) { return false; }
+
+    if ((grantpt(port_master) != 0) || (unlockpt(port_master) != 0)) {
+        Close();
+        return false;
+    }
+
+    temp_name = ptsname(port_master);
+    if (temp_name == NULL) {
+        Close();
+        return false;
+    }
+    slave_name = temp_name;
+
+    // raw mode right away - so nothing is echoed before the slave is used
+    port_slave = open(temp_name, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (port_slave < 0) {
+        Close();
+        return false;
+    }
+
+    if (tcgetattr(port_slave, &temp_settings) == 0) {
+        cfmakeraw(&temp_settings);
+        tcsetattr(port_slave, TCSANOW, &temp_settings);
+    }
+
+    return true;
+}
+
+//**************************[SlaveNameGet]*************************************
+std::string cComPortPty::SlaveNameGet() {
+
+    return slave_name;
+}
+
+//**************************[IsOpened]*****************************************
+bool cComPortPty::IsOpened() {
+
+    return (port_master >= 0);
+}
+
+//**************************[Close]********************************************
+void cComPortPty::Close() {
+
+    if (port_slave >= 0) {
+        close(port_slave);
+        port_slave = -1;
+    }
+
+    if (port_master >= 0) {
+        close(port_master);
+        port_master = -1;
+    }
+
+    slave_name = "";
+}
+
+//**************************[Write]********************************************
+int cComPortPty::Write(const char *data, int size) {
+
+    return write(port_master, data, size);
+}
+
+//**************************[Read]*********************************************
+int cComPortPty::Read(char *data, int size) {
+
+    return read(port_master, data, size);
+}
+
+//**************************[InCountGet]***************************************
+int cComPortPty::InCountGet() {
+
+    int in_count;
+
+    if (ioctl(port_master, FIONREAD, &in_count) == -1) {
+        return -1;
+    }
+
+    return in_count;
+}
+
+//**************************[OutCountGet]**************************************
+int cComPortPty::OutCountGet() {
+
+    int out_count;
+
+    if (ioctl(port_master, TIOCOUTQ, &out_count) == -1) {
+        return -1;
+    }
+
+    return out_count;
+}
+
+//**************************[FileGet]******************************************
+int cComPortPty::FileGet() {
+
+    return port_master;
+}
+
+} // namespace wepet {
@@ -1,413 +1,940 @@
-/******************************************************************************
-*                                                                             *
-* wepet_comport_windows.cpp                                                   *
-* =========================                                                   *
-*                                                                             *
-* Version: 1.1.4                                                              *
-* Date   : 18.10.15                                                           *
-* Author : Peter Weissig                                                      *
-*                                                                             *
-* For help or bug report please visit:                                        *
-*   https://github.com/peterweissig/cpp_comport/                              *
-*                                                                             *
-* Untested since several versions                                             *
-******************************************************************************/
-
-// local headers
-#include "wepet_comport.h"
-
-// wepet headers
-
-// standard headers
-#include <iostream>
-//#include <fstream>
-//#include <sstream>
-
-// additional headers
-#include <windows.h>
-
-namespace wepet {
-
-//**************************[cComPort]*****************************************
-cComPort::cComPort() {
-
-    port_file = INVALID_HANDLE_VALUE;
-
-    port_settings.BaudRate =         57600;
-    port_settings.ByteSize =  kCpByteSize8;
-    port_settings.StopBits =  kCpStopBits2;
-    port_settings.Parity   = kCpParityNone;
-
-    port_settings.fBinary       = true;
-    port_settings.fParity       = false;
-    port_settings.fAbortOnError = false;
-
-    port_settings.fOutxCtsFlow     = false;
-    port_settings.fOutxDsrFlow     = false;
-    port_settings.fDsrSensitivity  = false;
-    port_settings.fDtrControl      = DTR_CONTROL_DISABLE;
-    port_settings.fRtsControl      = RTS_CONTROL_DISABLE;
-
-    port_settings.fTXContinueOnXoff = true;
-    port_settings.fOutX             = false;
-    port_settings.fInX              = false;
-
-    port_settings.fErrorChar = false;
-    port_settings.fNull      = false;
-    port_settings.ErrorChar  = 0;
-    port_settings.EofChar    = 0;
-    port_settings.EvtChar    = 0;
-
-    port_settings.XonLim     = 0;
-    port_settings.XoffLim    = 0;
-    port_settings.XoffChar   = 0;
-    port_settings.XonChar    = 0;
-
-    port_settings.fDummy2    = 0;
-    port_settings.wReserved  = 0;
-    port_settings.wReserved1 = 0;
-
-
-    port_buffer_in_size  = 256;
-    port_buffer_out_size = 256;
-}
-
-//**************************[~cComPort]****************************************
-cComPort::~cComPort() {
-
-    Close();
-}
-
-//**************************[Open]*********************************************
-bool cComPort::Open(std::string port_name) {
-
-    if (IsOpened()) {
-        Close();
-    }
-
-    receive_buffer = "";
-
-    port_file = CreateFile(port_name.data(), GENERIC_READ | GENERIC_WRITE, 0,
-      NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
-    if (! IsOpened()) { return false; }
-
-
-    if (! SetupComm(port_file, port_buffer_in_size, port_buffer_out_size)) {
-        Close();
-        return false;
-    }
-
-    COMMTIMEOUTS temp_timeouts;
-    temp_timeouts.ReadIntervalTimeout        = 0;
-    temp_timeouts.ReadTotalTimeoutMultiplier = 0;
-    temp_timeouts.ReadTotalTimeoutConstant   = 0;
-    temp_timeouts.WriteTotalTimeoutMultiplier = 0;
-    temp_timeouts.WriteTotalTimeoutConstant   = 0;
-    if (! SetCommTimeouts(port_file, &temp_timeouts)) {
-        Close();
-        return false;
-    }
-
-    if (! SetCommState(port_file, &port_settings)) {
-        Close();
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[IsOpened]*****************************************
-bool cComPort::IsOpened() {
-
-    return (port_file != INVALID_HANDLE_VALUE);
-}
-
-//**************************[Close]********************************************
-void cComPort::Close() {
-
-    if (! IsOpened()) {
-        return;
-    }
-
-    CloseHandle(port_file);
-    port_file = INVALID_HANDLE_VALUE;
-}
-
-//**************************[Transmit]*****************************************
-bool cComPort::Transmit(std::string text) {
-
-    DWORD count;
-
-    if (! IsOpened()) {
-        return false;
-    }
-
-    if (! WriteFile(port_file, &(text[0]),text.size(),&count,NULL)) {
-        return false;
-    }
-
-    if (count != text.size()) {
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[Receive]******************************************
-std::string cComPort::Receive() {
-
-    int count_in;
-    DWORD count_out;
-    std::string result;
-
-    if (! IsOpened()) {
-        return "";
-    }
-
-    count_in = HWBufferInCountGet();
-
-    if (count_in < 1) {return "";}
-
-    result.resize(count_in);
-
-    if (! ReadFile(port_file, &(result[0]),count_in,&count_out,NULL)) {
-        return "";
-    }
-
-    result.resize(count_out);
-
-    return result;
-}
-
-//**************************[LineRtsSet]***************************************
-bool cComPort::LineRtsSet(bool state) {
-
-    DWORD flag;
-    if (! IsOpened()) {
-        return false;
-    }
-
-    if (state) { flag = SETRTS;} else { flag = CLRRTS;}
-
-    if (! EscapeCommFunction(port_file, flag)) {
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[LineDtrSet]***************************************
-bool cComPort::LineDtrSet(bool state) {
-
-    DWORD flag;
-    if (! IsOpened()) {
-        return false;
-    }
-
-    if (state) { flag = SETDTR;} else { flag = CLRDTR;}
-
-    if (! EscapeCommFunction(port_file, flag)) {
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[HWBufferInSizeGet]********************************
-int cComPort::HWBufferInSizeGet() {
-
-    return port_buffer_in_size;
-}
-
-//**************************[HWBufferOutSizeGet]*******************************
-int cComPort::HWBufferOutSizeGet() {
-
-    return port_buffer_out_size;
-}
-
-//**************************[HWBufferSizeSet]**********************************
-bool cComPort::HWBufferSizeSet(int buffer_in_size, int buffer_out_size) {
-
-    if (IsOpened()) {
-        if (! SetupComm(port_file, buffer_in_size, buffer_out_size)) {
-            return false;
-        }
-    }
-
-    port_buffer_in_size = buffer_in_size;
-    port_buffer_out_size = buffer_out_size;
-    return true;
-}
-
-//**************************[HWBufferInCountGet]*******************************
-int cComPort::HWBufferInCountGet() {
-
-    COMSTAT temp_stat;
-    DWORD temp;
-
-    if (! IsOpened()) {
-        return -1;
-    }
-
-    if (! ClearCommError(port_file, &temp, &temp_stat)) {
-        return -1;
-    }
-
-
-    return temp_stat.cbInQue;
-}
-
-//**************************[HWBufferOutCountGet]******************************
-int cComPort::HWBufferOutCountGet() {
-
-    COMSTAT temp_stat;
-    DWORD temp;
-
-    if (! IsOpened()) {
-        return -1;
-    }
-
-    if (! ClearCommError(port_file, &temp, &temp_stat)) {
-        return -1;
-    }
-
-
-    return temp_stat.cbOutQue;
-}
-
-//**************************[HWBufferFlush]************************************
-bool cComPort::HWBufferFlush(bool buffer_in, bool buffer_out) {
-
-    DWORD temp_flags;
-
-    if (! IsOpened()) { return true;}
-    if ((buffer_in == false) && (buffer_out == false)) {return true;}
-
-    if (buffer_in)  {temp_flags|= PURGE_RXCLEAR | PURGE_RXABORT;}
-    if (buffer_out) {temp_flags|= PURGE_TXCLEAR | PURGE_TXABORT;}
-
-    if (! PurgeComm(port_file, temp_flags)) {
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[SettingBaudRateGet]*******************************
-int cComPort::SettingBaudRateGet() {
-
-    return port_settings.BaudRate;
-}
-
-//**************************[SettingByteSizeGet]*******************************
-eComPortByteSize cComPort::SettingByteSizeGet() {
-
-    return (eComPortByteSize) port_settings.ByteSize;
-}
-
-//**************************[SettingStopBitsGet]*******************************
-eComPortStopBits cComPort::SettingStopBitsGet() {
-
-    return (eComPortStopBits) port_settings.StopBits;
-}
-
-//**************************[SettingParityGet]*********************************
-eComPortParity cComPort::SettingParityGet() {
-
-    return (eComPortParity) port_settings.Parity;
-}
-
-//**************************[SettingBaudRateSet]*******************************
-bool cComPort::SettingBaudRateSet(int baud_rate) {
-
-    DWORD temp_baud_rate;
-
-    temp_baud_rate = port_settings.BaudRate;
-    port_settings.BaudRate = baud_rate;
-
-    if (! IsOpened()) {
-        return true;
-    }
-
-    if (! SetCommState(port_file, &port_settings)) {
-        port_settings.BaudRate = temp_baud_rate;
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[SettingByteSizeSet]*******************************
-bool cComPort::SettingByteSizeSet(eComPortByteSize byte_size) {
-
-    int temp_byte_size;
-
-    temp_byte_size = port_settings.ByteSize;
-    port_settings.ByteSize = byte_size;
-
-    if (! IsOpened()) {
-        return true;
-    }
-
-    if (! SetCommState(port_file, &port_settings)) {
-        port_settings.ByteSize = temp_byte_size;
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[SettingStopBitsSet]*******************************
-bool cComPort::SettingStopBitsSet(eComPortStopBits stop_bits) {
-
-    int temp_stop_bits;
-
-    temp_stop_bits = port_settings.StopBits;
-    port_settings.StopBits = stop_bits;
-
-    if (! IsOpened()) {
-        return true;
-    }
-
-    if (! SetCommState(port_file, &port_settings)) {
-        port_settings.StopBits = temp_stop_bits;
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[SettingParitySet]*********************************
-bool cComPort::SettingParitySet(eComPortParity parity) {
-
-    int temp_parity;
-
-    temp_parity = port_settings.Parity;
-    port_settings.Parity= parity;
-
-    if (! IsOpened()) {
-        return true;
-    }
-
-    if (! SetCommState(port_file, &port_settings)) {
-        port_settings.Parity = temp_parity;
-        return false;
-    }
-
-    return true;
-}
-
-//**************************[GetCurrentTime]***********************************
-int64_t cComPortBuffer::GetCurrentTime() const {
-
-    return (int64_t) GetTickCount();
-}
-
-//**************************[SleepOneMilliSecond]******************************
-void cComPortBuffer::SleepOneMilliSecond() const {
-
-    // this function is mainly for linux to allow non-blocking sleep
-}
-
-
-} // namespace wepet {
+/******************************************************************************
+*                                                                             *
+* wepet_comport_windows.cpp                                                   *
+* =========================                                                   *
+*                                                                             *
+* Version: 1.1.4                                                              *
+* Date   : 18.10.15                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+*                                                                             *
+* Untested since several versions                                             *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport.h"
+
+// wepet headers
+
+// standard headers
+#include <iostream>
+//#include <fstream>
+//#include <sstream>
+
+// additional headers
+#include <windows.h>
+
+namespace wepet {
+
+//**************************[cComPort]*****************************************
+cComPort::cComPort() {
+
+    transport = NULL;
+    port_opened = false;
+    port_file = INVALID_HANDLE_VALUE;
+    port_lost = false;
+
+    StatisticReset();
+
+    port_settings.BaudRate =         57600;
+    port_settings.ByteSize =  kCpByteSize8;
+    port_settings.StopBits =  kCpStopBits2;
+    port_settings.Parity   = kCpParityNone;
+
+    port_settings.fBinary       = true;
+    port_settings.fParity       = false;
+    port_settings.fAbortOnError = false;
+
+    port_settings.fOutxCtsFlow     = false;
+    port_settings.fOutxDsrFlow     = false;
+    port_settings.fDsrSensitivity  = false;
+    port_settings.fDtrControl      = DTR_CONTROL_DISABLE;
+    port_settings.fRtsControl      = RTS_CONTROL_DISABLE;
+
+    port_settings.fTXContinueOnXoff = true;
+    port_settings.fOutX             = false;
+    port_settings.fInX              = false;
+
+    port_settings.fErrorChar = false;
+    port_settings.fNull      = false;
+    port_settings.ErrorChar  = 0;
+    port_settings.EofChar    = 0;
+    port_settings.EvtChar    = 0;
+
+    port_settings.XonLim     = 0;
+    port_settings.XoffLim    = 0;
+    port_settings.XoffChar   = 0;
+    port_settings.XonChar    = 0;
+
+    port_settings.fDummy2    = 0;
+    port_settings.wReserved  = 0;
+    port_settings.wReserved1 = 0;
+
+
+    port_buffer_in_size  = 256;
+    port_buffer_out_size = 256;
+
+    port_rs485.enabled           = false;
+    port_rs485.rts_on_send       = true;
+    port_rs485.rts_after_send    = false;
+    port_rs485.delay_before_send = 0;
+    port_rs485.delay_after_send  = 0;
+    port_rs485.rx_during_tx      = false;
+    port_rs485_kernel = false;
+
+    port_transmit_time = 0;
+}
+
+//**************************[~cComPort]****************************************
+cComPort::~cComPort() {
+
+    Close();
+}
+
+//**************************[Open]*********************************************
+bool cComPort::Open(std::string port_name) {
+
+    // other transports are opened by their owner - they are only attached
+    if (transport != NULL) {
+        this->port_name = port_name;
+        port_opened = transport->IsOpened();
+        return port_opened;
+    }
+
+    if (IsOpened()) {
+        Close();
+    }
+
+    receive_buffer = "";
+
+    this->port_name = port_name;
+
+    port_file = CreateFile(port_name.data(), GENERIC_READ | GENERIC_WRITE, 0,
+      NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (! IsOpened()) { return false; }
+
+
+    if (! SetupComm(port_file, port_buffer_in_size, port_buffer_out_size)) {
+        Close();
+        return false;
+    }
+
+    COMMTIMEOUTS temp_timeouts;
+    temp_timeouts.ReadIntervalTimeout        = 0;
+    temp_timeouts.ReadTotalTimeoutMultiplier = 0;
+    temp_timeouts.ReadTotalTimeoutConstant   = 0;
+    temp_timeouts.WriteTotalTimeoutMultiplier = 0;
+    temp_timeouts.WriteTotalTimeoutConstant   = 0;
+    if (! SetCommTimeouts(port_file, &temp_timeouts)) {
+        Close();
+        return false;
+    }
+
+    if (! SetCommState(port_file, &port_settings)) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[IsOpened]*****************************************
+bool cComPort::IsOpened() {
+
+    if (transport != NULL) {
+        return (port_opened && transport->IsOpened());
+    }
+
+    return (port_file != INVALID_HANDLE_VALUE);
+}
+
+//**************************[TransportSet]*************************************
+void cComPort::TransportSet(cComPortTransport *transport) {
+
+    Close();
+
+    this->transport = transport;
+}
+
+//**************************[TransportGet]*************************************
+cComPortTransport *cComPort::TransportGet() {
+
+    return transport;
+}
+
+//**************************[Close]********************************************
+void cComPort::Close() {
+
+    // other transports are owned by the caller - they are only detached
+    if (transport != NULL) {
+        port_opened = false;
+        return;
+    }
+
+    if (! IsOpened()) {
+        return;
+    }
+
+    CloseHandle(port_file);
+    port_file = INVALID_HANDLE_VALUE;
+}
+
+//**************************[NameGet]******************************************
+std::string cComPort::NameGet() {
+
+    return port_name;
+}
+
+//**************************[FileGet]******************************************
+int cComPort::FileGet() {
+
+    // Dummy function - only working in linux
+    return -1;
+}
+
+//**************************[HangupCheck]**************************************
+bool cComPort::HangupCheck() {
+
+    // Dummy function - only working in linux
+    return false;
+}
+
+//**************************[Transmit]*****************************************
+bool cComPort::Transmit(std::string text) {
+
+    int count;
+
+    if (! IsOpened()) {
+        return false;
+    }
+
+    count = PortWrite(&(text[0]),text.size());
+    if (count != text.size()) {
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[TransmitAndDrain]*********************************
+bool cComPort::TransmitAndDrain(std::string text, int milliseconds) {
+
+    // the timeout is only used by linux
+    if (! Transmit(text)) {
+        return false;
+    }
+
+    if (IsTermios() && (! FlushFileBuffers(port_file))) {
+        return false;
+    }
+
+    port_transmit_time = TimeGet();
+    return true;
+}
+
+//**************************[TransmitTimeGet]**********************************
+int64_t cComPort::TransmitTimeGet() {
+
+    return port_transmit_time;
+}
+
+//**************************[SettingPacingGet]*********************************
+int cComPort::SettingPacingGet() {
+
+    // Dummy function - only working in linux
+    return 0;
+}
+
+//**************************[SettingPacingSet]*********************************
+bool cComPort::SettingPacingSet(int queue_depth) {
+
+    // Dummy function - only working in linux
+    return (queue_depth <= 0);
+}
+
+//**************************[TransmitUpdate]***********************************
+bool cComPort::TransmitUpdate() {
+
+    // Dummy function - only working in linux
+    return true;
+}
+
+//**************************[TransmitUrgent]***********************************
+bool cComPort::TransmitUrgent(std::string text) {
+
+    return Transmit(text);
+}
+
+//**************************[TransmitUrgent]***********************************
+bool cComPort::TransmitUrgent(std::string text, int &count) {
+
+    count = 0;
+    if (! IsOpened()) {
+        return false;
+    }
+    if (text.empty()) {
+        return true;
+    }
+
+    count = PortWrite(&(text[0]),text.size());
+    if (count < 0) {
+        count = 0;
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[TransmitPendingGet]*******************************
+int cComPort::TransmitPendingGet() {
+
+    // Dummy function - only working in linux
+    return 0;
+}
+
+//**************************[Receive]******************************************
+std::string cComPort::Receive() {
+
+    return Receive(-1);
+}
+
+//**************************[Receive]******************************************
+std::string cComPort::Receive(int max_count) {
+
+    int count_in;
+    int count_out;
+    std::string result;
+
+    if (! IsOpened()) {
+        return "";
+    }
+
+    count_in = HWBufferInCountGet();
+    if ((max_count >= 0) && (count_in > max_count)) { count_in = max_count; }
+
+    if (count_in < 1) {return "";}
+
+    result.resize(count_in);
+
+    count_out = PortRead(&(result[0]),count_in);
+    if (count_out < 0) {
+        return "";
+    }
+
+    result.resize(count_out);
+
+    return result;
+}
+
+//**************************[LineRtsSet]***************************************
+bool cComPort::LineRtsSet(bool state) {
+
+    DWORD flag;
+    if (! IsOpened()) {
+        return false;
+    }
+
+    if (state) { flag = SETRTS;} else { flag = CLRRTS;}
+
+    if (! EscapeCommFunction(port_file, flag)) {
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[LineDtrSet]***************************************
+bool cComPort::LineDtrSet(bool state) {
+
+    DWORD flag;
+    if (! IsOpened()) {
+        return false;
+    }
+
+    if (state) { flag = SETDTR;} else { flag = CLRDTR;}
+
+    if (! EscapeCommFunction(port_file, flag)) {
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[LineStatusGet]************************************
+int cComPort::LineStatusGet() {
+
+    DWORD temp_status;
+    int result;
+
+    if (! IsOpened()) {
+        return -2;
+    }
+
+    if (! GetCommModemStatus(port_file, &temp_status)) {
+        return -1;
+    }
+
+    // output lines can not be read back in windows
+    result = 0;
+    if (temp_status & MS_CTS_ON ) { result|= kCpLineCts; }
+    if (temp_status & MS_DSR_ON ) { result|= kCpLineDsr; }
+    if (temp_status & MS_RLSD_ON) { result|= kCpLineDcd; }
+    if (temp_status & MS_RING_ON) { result|= kCpLineRi ; }
+
+    return result;
+}
+
+//**************************[LineCtsGet]***************************************
+int cComPort::LineCtsGet() {
+
+    int temp_status;
+
+    temp_status = LineStatusGet();
+    if (temp_status < 0) { return temp_status; }
+
+    return (temp_status & kCpLineCts) ? 1 : 0;
+}
+
+//**************************[LineDsrGet]***************************************
+int cComPort::LineDsrGet() {
+
+    int temp_status;
+
+    temp_status = LineStatusGet();
+    if (temp_status < 0) { return temp_status; }
+
+    return (temp_status & kCpLineDsr) ? 1 : 0;
+}
+
+//**************************[LineDcdGet]***************************************
+int cComPort::LineDcdGet() {
+
+    int temp_status;
+
+    temp_status = LineStatusGet();
+    if (temp_status < 0) { return temp_status; }
+
+    return (temp_status & kCpLineDcd) ? 1 : 0;
+}
+
+//**************************[LineRiGet]****************************************
+int cComPort::LineRiGet() {
+
+    int temp_status;
+
+    temp_status = LineStatusGet();
+    if (temp_status < 0) { return temp_status; }
+
+    return (temp_status & kCpLineRi) ? 1 : 0;
+}
+
+//**************************[LineWait]*****************************************
+bool cComPort::LineWait(int lines, int milliseconds) {
+
+    DWORD temp_mask;
+    DWORD temp_event;
+    DWORD temp_status, temp_status_start;
+    int64_t time_end;
+
+    if (! IsOpened()) {
+        return false;
+    }
+
+    temp_mask = 0;
+    if (lines & kCpLineCts) { temp_mask|= EV_CTS ; }
+    if (lines & kCpLineDsr) { temp_mask|= EV_DSR ; }
+    if (lines & kCpLineDcd) { temp_mask|= EV_RLSD; }
+    if (lines & kCpLineRi ) { temp_mask|= EV_RING; }
+    if (temp_mask == 0) { return false; }
+
+    if (milliseconds < 0) {
+        if (! SetCommMask(port_file, temp_mask)) {
+            return false;
+        }
+
+        if (! WaitCommEvent(port_file, &temp_event, NULL)) {
+            return false;
+        }
+
+        return true;
+    }
+
+    // WaitCommEvent has no timeout on a non overlapped handle - so the
+    // modem status is polled instead
+    temp_mask = 0;
+    if (lines & kCpLineCts) { temp_mask|= MS_CTS_ON ; }
+    if (lines & kCpLineDsr) { temp_mask|= MS_DSR_ON ; }
+    if (lines & kCpLineDcd) { temp_mask|= MS_RLSD_ON; }
+    if (lines & kCpLineRi ) { temp_mask|= MS_RING_ON; }
+
+    if (! GetCommModemStatus(port_file, &temp_status_start)) {
+        return false;
+    }
+
+    time_end = TimeGet() + (int64_t) milliseconds * 1000;
+    while (true) {
+        if (! GetCommModemStatus(port_file, &temp_status)) {
+            return false;
+        }
+        if ((temp_status ^ temp_status_start) & temp_mask) {
+            return true;
+        }
+
+        if (TimeGet() >= time_end) { return false; }
+        Sleep(1);
+    }
+}
+
+//**************************[HWBufferInSizeGet]********************************
+int cComPort::HWBufferInSizeGet() {
+
+    return port_buffer_in_size;
+}
+
+//**************************[HWBufferOutSizeGet]*******************************
+int cComPort::HWBufferOutSizeGet() {
+
+    return port_buffer_out_size;
+}
+
+//**************************[HWBufferSizeSet]**********************************
+bool cComPort::HWBufferSizeSet(int buffer_in_size, int buffer_out_size) {
+
+    if (IsOpened()) {
+        if (! SetupComm(port_file, buffer_in_size, buffer_out_size)) {
+            return false;
+        }
+    }
+
+    port_buffer_in_size = buffer_in_size;
+    port_buffer_out_size = buffer_out_size;
+    return true;
+}
+
+//**************************[HWBufferInCountGet]*******************************
+int cComPort::HWBufferInCountGet() {
+
+    COMSTAT temp_stat;
+    DWORD temp;
+
+    if (! IsOpened()) {
+        return -1;
+    }
+
+    if (transport != NULL) {
+        return transport->InCountGet();
+    }
+
+    if (! ClearCommError(port_file, &temp, &temp_stat)) {
+        return -1;
+    }
+
+
+    return temp_stat.cbInQue;
+}
+
+//**************************[HWBufferOutCountGet]******************************
+int cComPort::HWBufferOutCountGet() {
+
+    COMSTAT temp_stat;
+    DWORD temp;
+
+    if (! IsOpened()) {
+        return -1;
+    }
+
+    if (transport != NULL) {
+        return transport->OutCountGet();
+    }
+
+    if (! ClearCommError(port_file, &temp, &temp_stat)) {
+        return -1;
+    }
+
+
+    return temp_stat.cbOutQue;
+}
+
+//**************************[HWBufferFlush]************************************
+bool cComPort::HWBufferFlush(bool buffer_in, bool buffer_out) {
+
+    DWORD temp_flags;
+
+    if (! IsTermios()) { return true;}
+    if ((buffer_in == false) && (buffer_out == false)) {return true;}
+
+    if (buffer_in)  {temp_flags|= PURGE_RXCLEAR | PURGE_RXABORT;}
+    if (buffer_out) {temp_flags|= PURGE_TXCLEAR | PURGE_TXABORT;}
+
+    if (! PurgeComm(port_file, temp_flags)) {
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[SettingBaudRateGet]*******************************
+int cComPort::SettingBaudRateGet() {
+
+    return port_settings.BaudRate;
+}
+
+//**************************[SettingByteSizeGet]*******************************
+eComPortByteSize cComPort::SettingByteSizeGet() {
+
+    return (eComPortByteSize) port_settings.ByteSize;
+}
+
+//**************************[SettingStopBitsGet]*******************************
+eComPortStopBits cComPort::SettingStopBitsGet() {
+
+    return (eComPortStopBits) port_settings.StopBits;
+}
+
+//**************************[SettingParityGet]*********************************
+eComPortParity cComPort::SettingParityGet() {
+
+    return (eComPortParity) port_settings.Parity;
+}
+
+//**************************[SettingBaudRateSet]*******************************
+bool cComPort::SettingBaudRateSet(int baud_rate) {
+
+    DWORD temp_baud_rate;
+
+    temp_baud_rate = port_settings.BaudRate;
+    port_settings.BaudRate = baud_rate;
+
+    if (transport != NULL) {
+        return transport->BaudRateSet(baud_rate);
+    }
+
+    if (! IsOpened()) {
+        return true;
+    }
+
+    if (! SetCommState(port_file, &port_settings)) {
+        port_settings.BaudRate = temp_baud_rate;
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[SettingByteSizeSet]*******************************
+bool cComPort::SettingByteSizeSet(eComPortByteSize byte_size) {
+
+    int temp_byte_size;
+
+    temp_byte_size = port_settings.ByteSize;
+    port_settings.ByteSize = byte_size;
+
+    if (! IsOpened()) {
+        return true;
+    }
+
+    if (! SetCommState(port_file, &port_settings)) {
+        port_settings.ByteSize = temp_byte_size;
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[SettingStopBitsSet]*******************************
+bool cComPort::SettingStopBitsSet(eComPortStopBits stop_bits) {
+
+    int temp_stop_bits;
+
+    temp_stop_bits = port_settings.StopBits;
+    port_settings.StopBits = stop_bits;
+
+    if (! IsOpened()) {
+        return true;
+    }
+
+    if (! SetCommState(port_file, &port_settings)) {
+        port_settings.StopBits = temp_stop_bits;
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[SettingParitySet]*********************************
+bool cComPort::SettingParitySet(eComPortParity parity) {
+
+    int temp_parity;
+
+    temp_parity = port_settings.Parity;
+    port_settings.Parity= parity;
+
+    if (! IsOpened()) {
+        return true;
+    }
+
+    if (! SetCommState(port_file, &port_settings)) {
+        port_settings.Parity = temp_parity;
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[SettingControlApply]******************************
+bool cComPort::SettingControlApply(int baud_rate, uint32_t flags,
+  uint32_t mask) {
+
+    // Dummy function - only working in linux
+    return false;
+}
+
+//**************************[SettingFlowControlGet]****************************
+eComPortFlowControl cComPort::SettingFlowControlGet() {
+
+    if (port_settings.fOutxCtsFlow) {
+        return kCpFlowControlRtsCts;
+    }
+
+    if (port_settings.fOutxDsrFlow) {
+        return kCpFlowControlDtrDsr;
+    }
+
+    if (port_settings.fOutX || port_settings.fInX) {
+        return kCpFlowControlXonXoff;
+    }
+
+    return kCpFlowControlNone;
+}
+
+//**************************[SettingFlowControlSet]****************************
+bool cComPort::SettingFlowControlSet(eComPortFlowControl flow_control) {
+
+    DCB temp_settings;
+
+    temp_settings = port_settings;
+
+    port_settings.fOutxCtsFlow = false;
+    port_settings.fOutxDsrFlow = false;
+    port_settings.fDtrControl  = DTR_CONTROL_DISABLE;
+    port_settings.fRtsControl  = RTS_CONTROL_DISABLE;
+    port_settings.fOutX        = false;
+    port_settings.fInX         = false;
+
+    switch (flow_control) {
+        case (kCpFlowControlRtsCts)  :
+            port_settings.fOutxCtsFlow = true;
+            port_settings.fRtsControl  = RTS_CONTROL_HANDSHAKE;
+            break;
+        case (kCpFlowControlDtrDsr)  :
+            port_settings.fOutxDsrFlow = true;
+            port_settings.fDtrControl  = DTR_CONTROL_HANDSHAKE;
+            break;
+        case (kCpFlowControlXonXoff) :
+            port_settings.fOutX    = true;
+            port_settings.fInX     = true;
+            port_settings.XonChar  = 0x11; // DC1
+            port_settings.XoffChar = 0x13; // DC3
+            port_settings.XonLim   = port_buffer_in_size / 4;
+            port_settings.XoffLim  = port_buffer_in_size / 4;
+            break;
+        default                      :
+            break;
+    }
+
+    if (! IsOpened()) {
+        return true;
+    }
+
+    if (! SetCommState(port_file, &port_settings)) {
+        port_settings = temp_settings;
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[SettingErrorMarkGet]******************************
+bool cComPort::SettingErrorMarkGet() {
+
+    // Dummy function - only working in linux
+    return false;
+}
+
+//**************************[SettingErrorMarkSet]******************************
+bool cComPort::SettingErrorMarkSet(bool state) {
+
+    // Dummy function - only working in linux
+    return (! state);
+}
+
+//**************************[SettingReceivePolicySet]**************************
+bool cComPort::SettingReceivePolicySet(int min_bytes, int milliseconds,
+  bool blocking) {
+
+    // Dummy function - only working in linux
+    return ((min_bytes == 0) && (milliseconds == 0) && (! blocking));
+}
+
+//**************************[SettingReceiveMinGet]*****************************
+int cComPort::SettingReceiveMinGet() {
+
+    // Dummy function - only working in linux
+    return 0;
+}
+
+//**************************[SettingReceiveTimeoutGet]*************************
+int cComPort::SettingReceiveTimeoutGet() {
+
+    // Dummy function - only working in linux
+    return 0;
+}
+
+//**************************[SettingReceiveBlockingGet]************************
+bool cComPort::SettingReceiveBlockingGet() {
+
+    // Dummy function - only working in linux
+    return false;
+}
+
+//**************************[CounterGet]***************************************
+bool cComPort::CounterGet(sComPortCounters &counters) {
+
+    // Dummy function - only working in linux
+    return false;
+}
+
+//**************************[CounterDeltaGet]**********************************
+bool cComPort::CounterDeltaGet(sComPortCounters &baseline,
+  sComPortCounters &counters) {
+
+    // Dummy function - only working in linux
+    return false;
+}
+
+//**************************[SettingRs485Get]**********************************
+sComPortRs485 cComPort::SettingRs485Get() {
+
+    return port_rs485;
+}
+
+//**************************[SettingRs485Set]**********************************
+bool cComPort::SettingRs485Set(sComPortRs485 rs485) {
+
+    port_rs485 = rs485;
+
+    return Rs485Apply();
+}
+
+//**************************[SettingRs485KernelGet]****************************
+bool cComPort::SettingRs485KernelGet() {
+
+    return port_rs485_kernel;
+}
+
+//**************************[Rs485Apply]***************************************
+bool cComPort::Rs485Apply() {
+
+    DWORD temp_rts_control;
+
+    // windows only supports toggling of rts without any delays
+    temp_rts_control = port_settings.fRtsControl;
+    if (port_rs485.enabled) {
+        port_settings.fRtsControl = RTS_CONTROL_TOGGLE;
+    } else {
+        port_settings.fRtsControl = RTS_CONTROL_DISABLE;
+    }
+    port_rs485_kernel = port_rs485.enabled;
+
+    if (! IsOpened()) {
+        return true;
+    }
+
+    if (! SetCommState(port_file, &port_settings)) {
+        port_settings.fRtsControl = temp_rts_control;
+        port_rs485_kernel = false;
+        return false;
+    }
+
+    return true;
+}
+
+//**************************[IsTermios]****************************************
+bool cComPort::IsTermios() {
+
+    // name kept for symmetry with linux - true for a real serial port
+    return ((transport == NULL) && (port_file != INVALID_HANDLE_VALUE));
+}
+
+//**************************[PortWrite]****************************************
+int cComPort::PortWrite(const char *data, int size) {
+
+    DWORD count;
+    int64_t time_start;
+    int result;
+
+    time_start = TimeGet();
+    if (transport != NULL) {
+        result = transport->Write(data, size);
+    } else if (! WriteFile(port_file, data, size, &count, NULL)) {
+        result = -1;
+    } else {
+        result = count;
+    }
+    StatisticWrite(result, TimeGet() - time_start);
+
+    return result;
+}
+
+//**************************[PortRead]*****************************************
+int cComPort::PortRead(char *data, int size) {
+
+    DWORD count;
+    int result;
+
+    if (transport != NULL) {
+        result = transport->Read(data, size);
+    } else if (! ReadFile(port_file, data, size, &count, NULL)) {
+        result = -1;
+    } else {
+        result = count;
+    }
+    StatisticRead(result);
+
+    return result;
+}
+
+//**************************[TimeGet]******************************************
+int64_t cComPort::TimeGet() {
+
+    return (int64_t) GetTickCount() * 1000;
+}
+
+//**************************[TimeGet]******************************************
+int64_t cComPortClockMonotonic::TimeGet() {
+
+    return (int64_t) GetTickCount() * 1000000;
+}
+
+//**************************[Sleep]********************************************
+void cComPortClockMonotonic::Sleep(int64_t nanoseconds) {
+
+    // this function is mainly for linux to allow non-blocking sleep
+}
+
+//**************************[ReconnectSet]*************************************
+void cComPortBuffer::ReconnectSet(bool enabled) {
+
+    // Dummy function - only working in linux
+    reconnect_enabled = false;
+}
+
+//**************************[ReconnectUpdate]**********************************
+void cComPortBuffer::ReconnectUpdate() {
+
+    // Dummy function - only working in linux
+}
+
+} // namespace wepet {
@@ -0,0 +1,210 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_bench_io.cpp                                                  *
+* ==========================                                                  *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_test.h"
+#include "wepet_comport_io.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+
+
+
+using namespace wepet;
+
+// Benchmark of the receive paths for many ports: the readiness model of
+// cComPort (poll, then FIONREAD and read within Receive) against
+// cComPortIo with io_uring and epoll. In each round the masters of all pty
+// pairs write one chunk, which is then received by the tested path.
+// usage: wepet_comport_bench_io [ports [rounds [chunk]]]
+
+struct sBenchPorts {
+    std::vector<cComPortPty *> ptys;
+    std::vector<cComPort *> ports;
+};
+
+struct sBenchResult {
+    int64_t time;
+    int64_t bytes;
+    int64_t syscalls;
+};
+
+//**************************[BenchOpen]****************************************
+static void BenchOpen(sBenchPorts &bench, int count) {
+
+    for (int i = 0; i < count; i++) {
+        bench.ptys.push_back(new cComPortPty());
+        bench.ports.push_back(new cComPort());
+        TEST_CHECK(TestPtyOpen(*bench.ptys[i], *bench.ports[i]));
+    }
+}
+
+//**************************[BenchClose]***************************************
+static void BenchClose(sBenchPorts &bench) {
+
+    for (int i = 0; i < bench.ports.size(); i++) {
+        delete bench.ports[i];
+        delete bench.ptys[i];
+    }
+    bench.ports.clear();
+    bench.ptys.clear();
+}
+
+//**************************[BenchWrite]***************************************
+static void BenchWrite(sBenchPorts &bench, const std::string &chunk) {
+
+    for (int i = 0; i < bench.ptys.size(); i++) {
+        TEST_CHECK(bench.ptys[i]->Write(chunk.data(), chunk.size()) ==
+          chunk.size());
+    }
+}
+
+//**************************[BenchReceive]*************************************
+// the current path - poll all ports and call Receive for the ready ones
+static sBenchResult BenchReceive(int count, int rounds,
+  const std::string &chunk) {
+
+    sBenchPorts bench;
+    sBenchResult result;
+    std::vector<pollfd> temp_poll;
+    int64_t expected;
+
+    BenchOpen(bench, count);
+    temp_poll.resize(count);
+
+    result.bytes    = 0;
+    result.syscalls = 0;
+    result.time     = TestTimeGet();
+    for (int round = 0; round < rounds; round++) {
+        BenchWrite(bench, chunk);
+
+        expected = (int64_t) (round + 1) * count * chunk.size();
+        while (result.bytes < expected) {
+            for (int i = 0; i < count; i++) {
+                temp_poll[i].fd      = bench.ports[i]->FileGet();
+                temp_poll[i].events  = POLLIN;
+                temp_poll[i].revents = 0;
+            }
+            TEST_CHECK(poll(&temp_poll[0], count, 1000) > 0);
+            result.syscalls++;
+
+            for (int i = 0; i < count; i++) {
+                if (! (temp_poll[i].revents & POLLIN)) { continue; }
+
+                // FIONREAD and read (only FIONREAD if nothing was read)
+                int temp = bench.ports[i]->Receive().size();
+                result.bytes+= temp;
+                result.syscalls+= (temp > 0) ? 2 : 1;
+            }
+        }
+    }
+    result.time = TestTimeGet() - result.time;
+
+    BenchClose(bench);
+    return result;
+}
+
+//**************************[BenchCallback]************************************
+static void BenchCallback(cComPort *port, const char *text, int size,
+  void *data) {
+
+    *(int64_t *) data+= size;
+}
+
+//**************************[BenchIo]******************************************
+static sBenchResult BenchIo(eComPortIoBackend backend, int count,
+  int rounds, const std::string &chunk) {
+
+    sBenchPorts bench;
+    sBenchResult result;
+    cComPortIo io;
+    int64_t expected;
+
+    result.time     = 0;
+    result.bytes    = 0;
+    result.syscalls = -1;
+    if (! io.Open(backend)) { return result; }
+
+    BenchOpen(bench, count);
+    for (int i = 0; i < count; i++) {
+        TEST_CHECK(io.Add(bench.ports[i]));
+    }
+    io.CallbackSet(BenchCallback, &result.bytes);
+
+    // posts the first reads
+    io.Update(0);
+    io.StatisticReset();
+
+    result.time = TestTimeGet();
+    for (int round = 0; round < rounds; round++) {
+        BenchWrite(bench, chunk);
+
+        expected = (int64_t) (round + 1) * count * chunk.size();
+        while (result.bytes < expected) {
+            TEST_CHECK(io.Update(1000) >= 0);
+        }
+    }
+    result.time = TestTimeGet() - result.time;
+    result.syscalls = io.StatisticGet().syscalls;
+
+    io.Close();
+    BenchClose(bench);
+    return result;
+}
+
+//**************************[BenchPrint]***************************************
+static void BenchPrint(const char *name, const sBenchResult &result,
+  int count, int rounds) {
+
+    if (result.syscalls < 0) {
+        printf("%-8s not available\n", name);
+        return;
+    }
+
+    printf("%-8s %8.1f MB/s %8.1f us/round %8.2f syscalls/chunk\n", name,
+      result.bytes / (result.time / 1e9) / 1e6,
+      result.time / 1e3 / rounds,
+      (double) result.syscalls / ((double) count * rounds));
+}
+
+//**************************[main]*********************************************
+int main(int argc, char **argv) {
+
+    int count;
+    int rounds;
+    int size;
+
+    count  = (argc > 1) ? atoi(argv[1]) :  64;
+    rounds = (argc > 2) ? atoi(argv[2]) : 500;
+    size   = (argc > 3) ? atoi(argv[3]) : 256;
+    if ((count < 1) || (rounds < 1) || (size < 1)) {
+        fprintf(stderr, "usage: %s [ports [rounds [chunk]]]\n", argv[0]);
+        return 1;
+    }
+
+    std::string chunk = TestPattern(size, 38);
+
+    printf("%d ports, %d rounds, %d bytes per chunk\n", count, rounds,
+      size);
+    BenchPrint("receive", BenchReceive(count, rounds, chunk), count,
+      rounds);
+    BenchPrint("io_uring", BenchIo(kCpIoUring, count, rounds, chunk), count,
+      rounds);
+    BenchPrint("epoll", BenchIo(kCpIoEpoll, count, rounds, chunk), count,
+      rounds);
+
+    return 0;
+}
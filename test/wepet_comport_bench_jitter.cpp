@@ -0,0 +1,118 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_bench_jitter.cpp                                              *
+* ==============================                                              *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_test.h"
+#include "wepet_comport_io.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+
+
+
+using namespace wepet;
+
+// Benchmark of the real-time mode of the io thread: a closed control loop
+// over a pty pair. The master sends a small frame, the callback of the io
+// thread echoes it and the master measures the round trip. The latencies
+// are printed for the normal thread and for the real-time mode (SCHED_FIFO
+// and mlockall usually need root - the applied parts are printed).
+// usage: wepet_comport_bench_jitter [rounds [cpu [priority]]]
+
+static const int kJitterFrame = 16;
+
+//**************************[JitterEcho]***************************************
+static void JitterEcho(cComPort *port, const char *text, int size,
+  void *data) {
+
+    cComPortIo *io;
+
+    io = (cComPortIo *) data;
+    io->Transmit(port, std::string(text, size));
+}
+
+//**************************[JitterRun]****************************************
+static void JitterRun(const char *name, int rounds,
+  sComPortIoRealtime realtime) {
+
+    cComPortPty pty;
+    cComPort port;
+    cComPortIo io;
+    std::vector<int64_t> latencies;
+    std::string frame;
+    std::string received;
+    int64_t time;
+
+    TEST_CHECK(TestPtyOpen(pty, port));
+    TEST_CHECK(io.Open());
+    TEST_CHECK(io.Add(&port));
+    io.CallbackSet(JitterEcho, &io);
+    io.TransmitReserve(4096);
+    io.RealtimeSet(realtime);
+    TEST_CHECK(io.ThreadStart());
+
+    frame = TestPattern(kJitterFrame, 45);
+    latencies.reserve(rounds);
+
+    for (int i = 0; i < rounds; i++) {
+        received.clear();
+
+        time = TestTimeGet();
+        TEST_CHECK(pty.Write(frame.data(), frame.size()) == frame.size());
+        TEST_CHECK(TestRead(pty, received, frame.size(), 1000));
+        latencies.push_back(TestTimeGet() - time);
+
+        TEST_CHECK(received == frame);
+    }
+
+    printf("%-9s (applied 0x%02x) p50 %6.1f us, p99 %6.1f us, "
+      "max %7.1f us\n", name, io.ThreadRealtimeGet(),
+      TestPercentile(latencies, 50) / 1e3,
+      TestPercentile(latencies, 99) / 1e3,
+      TestPercentile(latencies, 100) / 1e3);
+
+    io.ThreadStop();
+    io.Close();
+}
+
+//**************************[main]*********************************************
+int main(int argc, char **argv) {
+
+    sComPortIoRealtime realtime;
+    int rounds;
+
+    rounds = (argc > 1) ? atoi(argv[1]) : 10000;
+    if (rounds < 1) {
+        fprintf(stderr, "usage: %s [rounds [cpu [priority]]]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%d round trips of %d bytes\n", rounds, kJitterFrame);
+
+    realtime.enabled     = false;
+    realtime.cpu         = -1;
+    realtime.priority    = 0;
+    realtime.lock_memory = false;
+    JitterRun("normal", rounds, realtime);
+
+    realtime.enabled     = true;
+    realtime.cpu         = (argc > 2) ? atoi(argv[2]) :  0;
+    realtime.priority    = (argc > 3) ? atoi(argv[3]) : 50;
+    realtime.lock_memory = true;
+    JitterRun("real-time", rounds, realtime);
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_bench_receive.cpp                                             *
+* ===============================                                             *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_test.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+#include <pthread.h>
+
+
+
+using namespace wepet;
+
+// Benchmark of the receive policy (VMIN/VTIME): a thread streams small
+// bursts into the pty master while the port receives them. Counted are
+// the wakeups of the reader (returns of poll or of a blocking Receive)
+// per megabyte - first with the default policy, then with batching.
+// usage: wepet_comport_bench_receive [kilobytes [burst [gap_us]]]
+
+struct sReceiveWriter {
+    cComPortPty *pty;
+    const std::string *data;
+    int burst;
+    int gap;
+};
+
+struct sReceivePolicy {
+    const char *name;
+    int min_bytes;
+    int milliseconds;
+    bool blocking;
+};
+
+//**************************[ReceiveWrite]*************************************
+static void *ReceiveWrite(void *data) {
+
+    sReceiveWriter &writer = *(sReceiveWriter *) data;
+    int64_t time_next;
+    int offset;
+    int count;
+
+    time_next = TestTimeGet();
+    for (offset = 0; offset < writer.data->size(); ) {
+        // paces the bursts like a serial line would
+        while (TestTimeGet() < time_next) { }
+        time_next+= (int64_t) writer.gap * 1000;
+
+        count = std::min(writer.burst, (int) writer.data->size() - offset);
+        count = writer.pty->Write(writer.data->data() + offset, count);
+        if (count > 0) { offset+= count; }
+    }
+
+    return NULL;
+}
+
+//**************************[ReceiveRun]***************************************
+// returns the number of wakeups or -1 on error
+static int64_t ReceiveRun(const sReceivePolicy &policy,
+  const std::string &data, int burst, int gap) {
+
+    cComPortPty pty;
+    cComPort port;
+    sReceiveWriter writer;
+    pthread_t thread;
+    std::string received;
+    pollfd temp_poll;
+    int64_t wakeups;
+
+    TEST_CHECK(TestPtyOpen(pty, port));
+    TEST_CHECK(port.SettingReceivePolicySet(policy.min_bytes,
+      policy.milliseconds, policy.blocking));
+
+    writer.pty   = &pty;
+    writer.data  = &data;
+    writer.burst = burst;
+    writer.gap   = gap;
+    TEST_CHECK(pthread_create(&thread, NULL, ReceiveWrite, &writer) == 0);
+
+    wakeups = 0;
+    while (received.size() < data.size()) {
+        if (! policy.blocking) {
+            // the timeout collects the rest below min_bytes
+            temp_poll.fd      = port.FileGet();
+            temp_poll.events  = POLLIN;
+            temp_poll.revents = 0;
+            poll(&temp_poll, 1, 100);
+        }
+        wakeups++;
+
+        received+= port.Receive();
+    }
+    pthread_join(thread, NULL);
+
+    TEST_CHECK(received == data);
+    return wakeups;
+}
+
+//**************************[main]*********************************************
+int main(int argc, char **argv) {
+
+    static const sReceivePolicy policies[] = {
+        {"default"          ,  0,   0, false},
+        {"poll min 64"      , 64,   0, false},
+        {"block min 64"     , 64, 100, true },
+        {"block min 16"     , 16, 100, true },
+        {"block timeout 100",  0, 100, true }
+    };
+
+    int size;
+    int burst;
+    int gap;
+    int64_t wakeups;
+    int64_t time;
+
+    size  = (argc > 1) ? atoi(argv[1]) * 1024 : 1024 * 1024;
+    burst = (argc > 2) ? atoi(argv[2]) :  8;
+    gap   = (argc > 3) ? atoi(argv[3]) : 10;
+    if ((size < 1) || (burst < 1) || (gap < 0)) {
+        fprintf(stderr, "usage: %s [kilobytes [burst [gap_us]]]\n",
+          argv[0]);
+        return 1;
+    }
+
+    std::string data = TestPattern(size, 39);
+
+    printf("%d bytes in bursts of %d bytes every %d us\n", size, burst,
+      gap);
+    for (int i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        time    = TestTimeGet();
+        wakeups = ReceiveRun(policies[i], data, burst, gap);
+        time    = TestTimeGet() - time;
+
+        printf("%-18s %9.0f wakeups/MB %7.1f bytes/wakeup %7.1f ms\n",
+          policies[i].name, wakeups * (1024.0 * 1024.0) / size,
+          (double) size / wakeups, time / 1e6);
+    }
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_test.h                                                        *
+* ====================                                                        *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+#ifndef __WEPET_COMPORT_TEST_H
+#define __WEPET_COMPORT_TEST_H
+
+// local headers
+#include "wepet_comport.h"
+#include "wepet_comport_transport.h"
+
+// wepet headers
+
+// standard headers
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// additional headers
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+
+
+// Small harness for the tests and benchmarks - this file is only for
+// linux. A test is a program returning 0 on success, so it can be run by
+// ctest. The pty pair (cComPortPty) replaces the serial line: the slave
+// is opened by a cComPort and the master is the other end of the line.
+
+// prints the failed condition and stops the test
+#define TEST_CHECK(condition) \
+    do { \
+        if (! (condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, \
+              __LINE__, #condition); \
+            exit(1); \
+        } \
+    } while (0)
+
+namespace wepet {
+
+//**************************[TestTimeGet]**************************************
+// monotonic time in nanoseconds
+inline int64_t TestTimeGet(void) {
+
+    timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (int64_t) time.tv_sec * (int64_t) 1000000000 + time.tv_nsec;
+}
+
+//**************************[TestPattern]**************************************
+// reproducible data - each byte depends on its position and the seed
+inline std::string TestPattern(int size, int seed) {
+
+    std::string result;
+    uint32_t state;
+
+    state = (seed != 0) ? seed : 1;
+    result.resize(size);
+    for (int i = 0; i < size; i++) {
+        state^= state << 13;
+        state^= state >> 17;
+        state^= state <<  5;
+        result[i] = state >> 24;
+    }
+
+    return result;
+}
+
+//**************************[TestPtyOpen]**************************************
+// opens a pty pair and the port on its slave side
+inline bool TestPtyOpen(cComPortPty &pty, cComPort &port) {
+
+    if (! pty.Open()) { return false; }
+
+    return port.Open(pty.SlaveNameGet());
+}
+
+//**************************[TestRead]*****************************************
+// appends all data of the transport until size bytes were read or the time
+// is up (milliseconds) - returns false after timeout or error
+inline bool TestRead(cComPortTransport &transport, std::string &data,
+  int size, int milliseconds) {
+
+    char temp_buffer[4096];
+    int64_t time_end;
+    pollfd temp_poll;
+    int count;
+
+    time_end = TestTimeGet() + (int64_t) milliseconds * 1000000;
+    while (data.size() < size) {
+        count = transport.Read(temp_buffer, std::min((int) sizeof(temp_buffer),
+          (int) (size - data.size())));
+        if (count > 0) {
+            data.append(temp_buffer, count);
+            continue;
+        }
+        if (TestTimeGet() >= time_end) { return false; }
+
+        temp_poll.fd      = transport.FileGet();
+        temp_poll.events  = POLLIN;
+        temp_poll.revents = 0;
+        if (temp_poll.fd < 0) {
+            usleep(1000);
+        } else {
+            poll(&temp_poll, 1, 10);
+        }
+    }
+
+    return true;
+}
+
+//**************************[TestPercentile]***********************************
+// returns the given percentile (0 .. 100) of the values
+inline int64_t TestPercentile(std::vector<int64_t> values, int percentile) {
+
+    int index;
+
+    if (values.empty()) { return 0; }
+
+    std::sort(values.begin(), values.end());
+    index = (int64_t) (values.size() - 1) * percentile / 100;
+    return values[index];
+}
+
+} // namespace wepet {
+#endif // #ifndef __WEPET_COMPORT_TEST_H
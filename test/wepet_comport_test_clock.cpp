@@ -0,0 +1,102 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_test_clock.cpp                                                *
+* ============================                                                *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_test.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+
+
+
+using namespace wepet;
+
+// Test of the virtual clock: a buffered port on a pty uses a virtual clock
+// with a timeout of 5 seconds. BufferWait, BufferWaitAny and Wait have to
+// run out after 5 virtual seconds, but within a fraction of the real time.
+
+static const int kClockTimeout = 5000;
+// limit of the real time per call in milliseconds
+static const int kClockReal = 1000;
+
+//**************************[ClockCheck]***************************************
+// checks the elapsed times since the given start times (nanoseconds)
+static void ClockCheck(cComPortClockVirtual &clock, int64_t time_virtual,
+  int64_t time_real) {
+
+    time_virtual = clock.TimeGet() - time_virtual;
+    time_real    = TestTimeGet() - time_real;
+
+    TEST_CHECK(time_virtual >= (int64_t) kClockTimeout * 1000000);
+    TEST_CHECK(time_virtual <= (int64_t) (kClockTimeout + 2) * 1000000);
+    TEST_CHECK(time_real < (int64_t) kClockReal * 1000000);
+}
+
+//**************************[main]*********************************************
+int main(void) {
+
+    cComPortClockVirtual clock(1000000000);
+    cComPortPty pty;
+    cComPortBuffer port;
+    std::vector<std::string> patterns;
+    int64_t time_virtual;
+    int64_t time_real;
+    int offset;
+
+    TEST_CHECK(TestPtyOpen(pty, port));
+    port.ClockSet(&clock);
+    port.BufferTimeSet(kClockTimeout);
+    TEST_CHECK(port.ClockGet() == &clock);
+
+    // nothing received
+    time_virtual = clock.TimeGet();
+    time_real    = TestTimeGet();
+    TEST_CHECK(! port.BufferWait(3));
+    ClockCheck(clock, time_virtual, time_real);
+
+    // the text is only received in parts
+    TEST_CHECK(pty.Write("hel", 3) == 3);
+    time_virtual = clock.TimeGet();
+    time_real    = TestTimeGet();
+    TEST_CHECK(! port.BufferWait(std::string("hello")));
+    ClockCheck(clock, time_virtual, time_real);
+    TEST_CHECK(port.BufferGet() == "hel");
+
+    // none of the patterns is received
+    patterns.push_back("world");
+    patterns.push_back("help");
+    time_virtual = clock.TimeGet();
+    time_real    = TestTimeGet();
+    TEST_CHECK(port.BufferWaitAny(patterns, offset) == -1);
+    ClockCheck(clock, time_virtual, time_real);
+
+    time_virtual = clock.TimeGet();
+    time_real    = TestTimeGet();
+    port.Wait(kClockTimeout);
+    ClockCheck(clock, time_virtual, time_real);
+
+    // received data ends the wait at once
+    TEST_CHECK(pty.Write("p", 1) == 1);
+    time_virtual = clock.TimeGet();
+    TEST_CHECK(port.BufferWaitAny(patterns, offset) == 1);
+    TEST_CHECK(offset == 0);
+    TEST_CHECK(clock.TimeGet() - time_virtual <
+      (int64_t) kClockTimeout * 1000000);
+
+    printf("clock: %.1f virtual seconds passed\n",
+      (clock.TimeGet() - 1000000000) / 1e9);
+    return 0;
+}
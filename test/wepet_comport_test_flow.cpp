@@ -0,0 +1,112 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_test_flow.cpp                                                 *
+* ===========================                                                 *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_test.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+#include <pthread.h>
+
+
+
+using namespace wepet;
+
+// Stress test of the flow control: the port writes a long stream while
+// the receiver (pty master) stalls several times - once by sending XOFF
+// and once by simply not reading. No byte may be lost or reordered and
+// the output has to stop while XOFF is active.
+
+static const int kFlowSize  = 4 * 1024 * 1024;
+static const int kFlowChunk = 4096;
+
+struct sFlowWriter {
+    cComPort *port;
+    const std::string *data;
+    bool result;
+};
+
+//**************************[FlowWrite]****************************************
+static void *FlowWrite(void *data) {
+
+    sFlowWriter &writer = *(sFlowWriter *) data;
+
+    writer.result = true;
+    for (int i = 0; i < writer.data->size(); i+= kFlowChunk) {
+        if (! writer.port->TransmitAndDrain(writer.data->substr(i,
+          kFlowChunk), 10000)) {
+            writer.result = false;
+            return NULL;
+        }
+    }
+
+    return NULL;
+}
+
+//**************************[main]*********************************************
+int main(void) {
+
+    cComPortPty pty;
+    cComPort port;
+    sFlowWriter writer;
+    pthread_t thread;
+    std::string data;
+    std::string received;
+    int count;
+
+    TEST_CHECK(TestPtyOpen(pty, port));
+
+    // all modes can be set and read back - except dtr/dsr, which is not
+    // available on linux and must not change the mode
+    TEST_CHECK(port.SettingFlowControlSet(kCpFlowControlRtsCts));
+    TEST_CHECK(port.SettingFlowControlSet(kCpFlowControlDtrDsr) == false);
+    TEST_CHECK(port.SettingFlowControlGet() == kCpFlowControlRtsCts);
+    TEST_CHECK(port.SettingFlowControlSet(kCpFlowControlNone));
+    TEST_CHECK(port.SettingFlowControlGet() == kCpFlowControlNone);
+    TEST_CHECK(port.SettingFlowControlSet(kCpFlowControlXonXoff));
+    TEST_CHECK(port.SettingFlowControlGet() == kCpFlowControlXonXoff);
+
+    data = TestPattern(kFlowSize, 26);
+    writer.port   = &port;
+    writer.data   = &data;
+    writer.result = false;
+    TEST_CHECK(pthread_create(&thread, NULL, FlowWrite, &writer) == 0);
+
+    // first stall - XOFF stops the output of the port
+    TEST_CHECK(TestRead(pty, received, kFlowSize / 4, 5000));
+    TEST_CHECK(pty.Write("\x13", 1) == 1);
+    usleep(50000);
+    TEST_CHECK(TestRead(pty, received, kFlowSize, 100) == false);
+    count = received.size();
+    usleep(300000);
+    TEST_CHECK(pty.InCountGet() == 0);
+    TestRead(pty, received, kFlowSize, 10);
+    TEST_CHECK(received.size() == count);
+    TEST_CHECK(pty.Write("\x11", 1) == 1);
+
+    // second stall - the receiver does not read at all
+    TEST_CHECK(TestRead(pty, received, kFlowSize / 2, 5000));
+    usleep(300000);
+
+    TEST_CHECK(TestRead(pty, received, kFlowSize, 10000));
+    pthread_join(thread, NULL);
+
+    TEST_CHECK(writer.result);
+    TEST_CHECK(received == data);
+
+    printf("flow: %d bytes received without loss\n", (int) received.size());
+    return 0;
+}
@@ -0,0 +1,115 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_test_loopback.cpp                                             *
+* ===============================                                             *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_test.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+
+
+
+using namespace wepet;
+
+// Test of the in-memory loopback: a port sends a pattern through a
+// throttled endpoint with byte loss. The delivered bytes plus the lost
+// ones have to match the sent ones, the delivery has to take the time of
+// the baud rate and the same seed has to drop the same bytes every time.
+
+static const int kLoopbackSize = 2000;
+static const int kLoopbackBaud = 115200;
+static const double kLoopbackLoss = 0.05;
+
+//**************************[LoopbackRun]**************************************
+// returns the delivered bytes - time is the duration in nanoseconds
+static std::string LoopbackRun(uint32_t seed, int &lost, int64_t &time) {
+
+    cComPortLoopback endpoint_port;
+    cComPortLoopback endpoint_peer;
+    cComPort port;
+    std::string data;
+    std::string received;
+    int64_t time_char;
+    int64_t time_start;
+    int64_t time_last;
+    int64_t time_min;
+    int count;
+
+    TEST_CHECK(endpoint_port.Connect(endpoint_peer));
+    TEST_CHECK(endpoint_port.BaudRateSet(kLoopbackBaud));
+    endpoint_port.LossSet(kLoopbackLoss, seed);
+
+    port.TransportSet(&endpoint_port);
+    TEST_CHECK(port.Open("loopback"));
+
+    data = TestPattern(kLoopbackSize, 35);
+    time_start = TestTimeGet();
+    TEST_CHECK(port.Transmit(data));
+
+    // the throttled line delivers nothing at once
+    TestRead(endpoint_peer, received, kLoopbackSize, 0);
+    TEST_CHECK(received.size() < 10);
+
+    // waits until nothing more arrives for 50ms - the time of the last
+    // byte is kept
+    time_last = TestTimeGet();
+    while (TestTimeGet() - time_last < 50000000) {
+        count = received.size();
+        TestRead(endpoint_peer, received, kLoopbackSize, 1);
+        if (received.size() > count) { time_last = TestTimeGet(); }
+    }
+    time = time_last - time_start;
+
+    lost = endpoint_port.LossCountGet();
+    TEST_CHECK(received.size() + lost == kLoopbackSize);
+    TEST_CHECK(lost > kLoopbackSize * kLoopbackLoss / 2);
+    TEST_CHECK(lost < kLoopbackSize * kLoopbackLoss * 2);
+
+    // 10 bits per byte
+    time_char = (int64_t) 10000000000LL / kLoopbackBaud;
+    time_min  = (int64_t) received.size() * time_char;
+    TEST_CHECK(time >= time_min);
+    TEST_CHECK(time <  time_min +  50000000);
+
+    // the delivered bytes keep their order
+    for (int i = 0, j = 0; i < received.size(); i++, j++) {
+        while ((j < data.size()) && (data[j] != received[i])) { j++; }
+        TEST_CHECK(j < data.size());
+    }
+
+    return received;
+}
+
+//**************************[main]*********************************************
+int main(void) {
+
+    std::string received[3];
+    int lost[3];
+    int64_t time[3];
+
+    received[0] = LoopbackRun(35, lost[0], time[0]);
+    received[1] = LoopbackRun(35, lost[1], time[1]);
+    received[2] = LoopbackRun(36, lost[2], time[2]);
+
+    // reproducible for the same seed only
+    TEST_CHECK(lost[0] == lost[1]);
+    TEST_CHECK(received[0] == received[1]);
+    TEST_CHECK(received[0] != received[2]);
+
+    printf("loopback: %d of %d bytes lost, %.1f ms\n", lost[0],
+      kLoopbackSize, time[0] / 1e6);
+    return 0;
+}
@@ -0,0 +1,264 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_test_server.cpp                                               *
+* =============================                                               *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_test.h"
+#include "wepet_comport_server.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+
+
+using namespace wepet;
+
+// Test of the port server: the port is opened on the slave of a pty pair
+// and two clients connect by a unix socket. The data of the master has to
+// reach both clients, the write mode "first" has to keep other clients
+// out and a client write larger than the output buffer of the tty has to
+// arrive completely at the master.
+
+static const int kServerClients = 2;
+
+struct sServerTest {
+    cComPortServer server;
+    cComPortPty pty;
+    std::string path;
+
+    // sockets of the clients (-1 if closed)
+    int files[kServerClients];
+    // data still to be sent by the clients
+    std::string sending[kServerClients];
+    std::string received[kServerClients];
+    // data received by the master - not read while paused
+    std::string master;
+    bool master_paused;
+};
+
+//**************************[ServerConnect]************************************
+static int ServerConnect(const std::string &path) {
+
+    sockaddr_un temp_address;
+    int temp_socket;
+
+    temp_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+      0);
+    TEST_CHECK(temp_socket >= 0);
+
+    memset(&temp_address, 0, sizeof(temp_address));
+    temp_address.sun_family = AF_UNIX;
+    strcpy(temp_address.sun_path, path.data());
+    TEST_CHECK(connect(temp_socket, (sockaddr *) &temp_address,
+      sizeof(temp_address)) == 0);
+
+    return temp_socket;
+}
+
+//**************************[ServerUpdate]*************************************
+// handles the server once and moves all available data of the test ends
+static void ServerUpdate(sServerTest &test) {
+
+    char temp_buffer[4096];
+    int count;
+
+    TEST_CHECK(test.server.Update(1));
+
+    if (! test.master_paused) {
+        TestRead(test.pty, test.master, test.master.size() + 65536, 0);
+    }
+
+    for (int i = 0; i < kServerClients; i++) {
+        if (test.files[i] < 0) { continue; }
+
+        if (! test.sending[i].empty()) {
+            count = send(test.files[i], test.sending[i].data(),
+              test.sending[i].size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            TEST_CHECK((count > 0) || (errno == EAGAIN));
+            if (count > 0) { test.sending[i].erase(0, count); }
+        }
+
+        while ((count = recv(test.files[i], temp_buffer,
+          sizeof(temp_buffer), MSG_DONTWAIT)) > 0) {
+            test.received[i].append(temp_buffer, count);
+        }
+    }
+}
+
+//**************************[ServerWait]***************************************
+// updates until the master and each client got at least the given number
+// of bytes - returns false after timeout (milliseconds)
+static bool ServerWait(sServerTest &test, int master, int client,
+  int milliseconds) {
+
+    int64_t time_end;
+    bool done;
+
+    time_end = TestTimeGet() + (int64_t) milliseconds * 1000000;
+    while (TestTimeGet() < time_end) {
+        ServerUpdate(test);
+
+        done = test.master.size() >= master;
+        for (int i = 0; i < kServerClients; i++) {
+            if (test.files[i] < 0) { continue; }
+            done = done && (test.received[i].size() >= client);
+        }
+        if (done) { return true; }
+    }
+
+    return false;
+}
+
+//**************************[ServerOpen]***************************************
+static void ServerOpen(sServerTest &test, eComPortServerWrite mode) {
+
+    char temp_path[64];
+
+    snprintf(temp_path, sizeof(temp_path),
+      "/tmp/wepet_comport_test_server_%d.sock", (int) getpid());
+    test.path = temp_path;
+    test.master_paused = false;
+
+    TEST_CHECK(TestPtyOpen(test.pty, test.server.PortGet()));
+    TEST_CHECK(test.server.ListenUnix(test.path));
+    test.server.WriteModeSet(mode);
+
+    for (int i = 0; i < kServerClients; i++) {
+        test.files[i] = ServerConnect(test.path);
+    }
+    while (test.server.ClientCountGet() < kServerClients) {
+        ServerUpdate(test);
+    }
+}
+
+//**************************[ServerClose]**************************************
+static void ServerClose(sServerTest &test) {
+
+    for (int i = 0; i < kServerClients; i++) {
+        if (test.files[i] >= 0) { close(test.files[i]); }
+    }
+    test.server.Close();
+}
+
+//**************************[ServerFanOut]*************************************
+static void ServerFanOut(void) {
+
+    sServerTest test;
+    std::string data;
+
+    ServerOpen(test, kCpServerWriteAll);
+
+    data = TestPattern(64 * 1024, 36);
+    for (int i = 0; i < data.size(); ) {
+        int count = test.pty.Write(data.data() + i, data.size() - i);
+        if (count > 0) { i+= count; }
+        ServerUpdate(test);
+    }
+
+    TEST_CHECK(ServerWait(test, 0, data.size(), 5000));
+    for (int i = 0; i < kServerClients; i++) {
+        TEST_CHECK(test.received[i] == data);
+    }
+
+    ServerClose(test);
+}
+
+//**************************[ServerWriteFirst]*********************************
+static void ServerWriteFirst(void) {
+
+    sServerTest test;
+
+    ServerOpen(test, kCpServerWriteFirst);
+    test.server.WriteIdleSet(100);
+
+    // the first writing client owns the port
+    test.sending[0] = "first";
+    TEST_CHECK(ServerWait(test, 5, 0, 1000));
+    TEST_CHECK(test.master == "first");
+
+    // others are dropped while the owner is active
+    test.sending[1] = "second";
+    ServerWait(test, 6, 0, 50);
+    TEST_CHECK(test.master == "first");
+    TEST_CHECK(test.server.WriteDroppedGet() == 6);
+
+    // the owner writes again - the idle time restarts
+    test.sending[0] = "third";
+    TEST_CHECK(ServerWait(test, 10, 0, 1000));
+    TEST_CHECK(test.master == "firstthird");
+
+    // after the idle time the other client takes over
+    usleep(150000);
+    test.sending[1] = "fourth";
+    TEST_CHECK(ServerWait(test, 16, 0, 1000));
+    TEST_CHECK(test.master == "firstthirdfourth");
+
+    test.sending[0] = "fifth";
+    ServerWait(test, 21, 0, 50);
+    TEST_CHECK(test.master == "firstthirdfourth");
+    TEST_CHECK(test.server.WriteDroppedGet() == 11);
+
+    // a disconnect of the owner frees the port at once
+    close(test.files[1]);
+    test.files[1] = -1;
+    while (test.server.ClientCountGet() > 1) {
+        ServerUpdate(test);
+    }
+    test.sending[0] = "sixth";
+    TEST_CHECK(ServerWait(test, 21, 0, 1000));
+    TEST_CHECK(test.master == "firstthirdfourthsixth");
+    TEST_CHECK(test.server.WriteDroppedGet() == 11);
+
+    ServerClose(test);
+}
+
+//**************************[ServerWriteLarge]*********************************
+static void ServerWriteLarge(void) {
+
+    sServerTest test;
+    std::string data;
+
+    ServerOpen(test, kCpServerWriteAll);
+
+    // far more than the output buffer of the tty - the master does not
+    // read at first, so the port is filled up
+    data = TestPattern(256 * 1024, 37);
+    test.sending[0] = data;
+    test.master_paused = true;
+    ServerWait(test, 1, 0, 200);
+    TEST_CHECK(! test.sending[0].empty());
+
+    test.master_paused = false;
+    TEST_CHECK(ServerWait(test, data.size(), 0, 10000));
+
+    TEST_CHECK(test.master == data);
+    TEST_CHECK(test.server.WriteDroppedGet() == 0);
+
+    ServerClose(test);
+}
+
+//**************************[main]*********************************************
+int main(void) {
+
+    ServerFanOut();
+    ServerWriteFirst();
+    ServerWriteLarge();
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+/******************************************************************************
+*                                                                             *
+* wepet_comport_test_transfer.cpp                                             *
+* ===============================                                             *
+*                                                                             *
+* Version: 1.2.0                                                              *
+* Date   : 19.10.26                                                           *
+* Author : Peter Weissig                                                      *
+*                                                                             *
+* For help or bug report please visit:                                        *
+*   https://github.com/peterweissig/cpp_comport/                              *
+******************************************************************************/
+
+// local headers
+#include "wepet_comport_test.h"
+#include "wepet_comport_transfer.h"
+
+// wepet headers
+
+// standard headers
+
+// additional headers
+#include <pthread.h>
+
+
+
+using namespace wepet;
+
+// End to end test of the bulk transfer: sender and receiver use the slaves
+// of two pty pairs and a thread relays the bytes between both masters.
+// The relay drops single bytes in both directions (data and replies), so
+// the transfer has to repair the losses. Each mode has to deliver the
+// data unchanged (xmodem may only append padding).
+
+// one of kRelayLoss bytes is dropped
+static const int kRelayLoss = 2000;
+
+struct sRelay {
+    cComPortPty *pty[2];
+    uint32_t state;
+    int dropped;
+    bool running;
+};
+
+struct sTransferSender {
+    cComPortTransfer *transfer;
+    const std::string *data;
+    bool result;
+};
+
+//**************************[RelayMain]****************************************
+static void *RelayMain(void *data) {
+
+    sRelay &relay = *(sRelay *) data;
+    pollfd temp_poll[2];
+    char temp_buffer[4096];
+    int count;
+    int size;
+
+    while (__atomic_load_n(&relay.running, __ATOMIC_ACQUIRE)) {
+        for (int i = 0; i < 2; i++) {
+            temp_poll[i].fd      = relay.pty[i]->FileGet();
+            temp_poll[i].events  = POLLIN;
+            temp_poll[i].revents = 0;
+        }
+        poll(temp_poll, 2, 10);
+
+        for (int i = 0; i < 2; i++) {
+            count = relay.pty[i]->Read(temp_buffer, sizeof(temp_buffer));
+            if (count < 1) { continue; }
+
+            // drops bytes by a reproducible random sequence
+            size = 0;
+            for (int j = 0; j < count; j++) {
+                relay.state^= relay.state << 13;
+                relay.state^= relay.state >> 17;
+                relay.state^= relay.state <<  5;
+                if (relay.state % kRelayLoss == 0) {
+                    relay.dropped++;
+                    continue;
+                }
+                temp_buffer[size++] = temp_buffer[j];
+            }
+
+            // the other side is written completely
+            for (int j = 0; j < size; ) {
+                count = relay.pty[1 - i]->Write(temp_buffer + j, size - j);
+                if (count > 0) {
+                    j+= count;
+                } else {
+                    usleep(100);
+                }
+            }
+        }
+    }
+
+    return NULL;
+}
+
+//**************************[TransferSend]*************************************
+static void *TransferSend(void *data) {
+
+    sTransferSender &sender = *(sTransferSender *) data;
+
+    sender.result = sender.transfer->Send(*sender.data, "firmware.bin");
+
+    return NULL;
+}
+
+//**************************[TransferRun]**************************************
+static void TransferRun(const char *name, eComPortTransferMode mode,
+  int size, int seed) {
+
+    cComPortPty pty_send;
+    cComPortPty pty_receive;
+    cComPort port_send;
+    cComPort port_receive;
+    cComPortTransfer transfer_send;
+    cComPortTransfer transfer_receive;
+    sTransferSender sender;
+    sRelay relay;
+    pthread_t thread_relay;
+    pthread_t thread_send;
+    std::string data;
+    std::string received;
+    std::string received_name;
+    bool result;
+
+    TEST_CHECK(TestPtyOpen(pty_send, port_send));
+    TEST_CHECK(TestPtyOpen(pty_receive, port_receive));
+
+    relay.pty[0]  = &pty_send;
+    relay.pty[1]  = &pty_receive;
+    relay.state   = seed;
+    relay.dropped = 0;
+    relay.running = true;
+    TEST_CHECK(pthread_create(&thread_relay, NULL, RelayMain, &relay) == 0);
+
+    transfer_send.PortSet(&port_send);
+    transfer_send.ModeSet(mode);
+    transfer_send.TimeoutSet(50);
+    transfer_send.RetryMaxSet(20);
+    transfer_receive.PortSet(&port_receive);
+    transfer_receive.ModeSet(mode);
+    transfer_receive.TimeoutSet(50);
+    transfer_receive.RetryMaxSet(20);
+
+    data = TestPattern(size, seed);
+    sender.transfer = &transfer_send;
+    sender.data     = &data;
+    sender.result   = false;
+    TEST_CHECK(pthread_create(&thread_send, NULL, TransferSend, &sender) ==
+      0);
+
+    result = transfer_receive.Receive(received, received_name);
+    pthread_join(thread_send, NULL);
+
+    __atomic_store_n(&relay.running, false, __ATOMIC_RELEASE);
+    pthread_join(thread_relay, NULL);
+
+    TEST_CHECK(result);
+    TEST_CHECK(sender.result);
+    TEST_CHECK(relay.dropped > 0);
+    if ((mode == kCpTransferXmodem) || (mode == kCpTransferXmodem1k)) {
+        TEST_CHECK(received.size() >= data.size());
+        TEST_CHECK(received.compare(0, data.size(), data) == 0);
+        TEST_CHECK(received.find_first_not_of('\x1A', data.size()) ==
+          std::string::npos);
+    } else {
+        TEST_CHECK(received == data);
+    }
+    if (mode == kCpTransferYmodem) {
+        TEST_CHECK(received_name == "firmware.bin");
+    }
+
+    printf("transfer %-9s: %d bytes, %d dropped, %d retransmits\n", name,
+      (int) data.size(), relay.dropped,
+      transfer_send.StatisticGet().retransmits);
+}
+
+//**************************[main]*********************************************
+int main(void) {
+
+    TransferRun("window"   , kCpTransferWindow  , 128 * 1024, 48);
+    TransferRun("xmodem"   , kCpTransferXmodem  ,  16 * 1024, 49);
+    TransferRun("xmodem-1k", kCpTransferXmodem1k,  32 * 1024, 50);
+    TransferRun("ymodem"   , kCpTransferYmodem  ,  32 * 1024, 51);
+
+    return 0;
+}